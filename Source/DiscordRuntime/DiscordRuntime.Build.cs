@@ -11,6 +11,12 @@ public class DiscordRuntime : ModuleRules
 		
 		PublicDependencyModuleNames.AddRange( new string[] { "Core", "CoreUObject", "DeveloperSettings", "Engine", "Projects" } );
 
+		// For the net driver
+		PrivateDependencyModuleNames.AddRange( new string[] { "NetCore", "PacketHandler", "Sockets" } );
+
+		// The mock SDK stands in for Discord in tests and benchmarks, and is left out of shipping builds
+		PublicDefinitions.Add(string.Format("WITH_DISCORD_MOCK_SDK={0}", Target.Configuration != UnrealTargetConfiguration.Shipping ? 1 : 0));
+
 		SetupDiscordSdk();
 	}
 
@@ -0,0 +1,21 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Achievements/DiscordAchievement.h"
+
+#include "DiscordStats.h"
+#include "Discord/types.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordAchievement)
+
+
+FDiscordUserAchievement::FDiscordUserAchievement(discord::UserAchievement const& UserAchievement)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordUserAchievement_FromDiscordType);
+
+	UserID = UserAchievement.GetUserId();
+	AchievementID = UserAchievement.GetAchievementId();
+	PercentComplete = UserAchievement.GetPercentComplete();
+
+	// An ISO 8601 date, empty until unlocked
+	FDateTime::ParseIso8601(UTF8_TO_TCHAR(UserAchievement.GetUnlockedAt()), UnlockedAt);
+}
@@ -0,0 +1,262 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Achievements/DiscordAchievementManager.h"
+
+#include "DiscordLatentAction.h"
+#include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Discord/achievement_manager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordAchievementManager)
+
+
+/**
+ * Fires the callbacks of all the reports merged into an update with its result.
+ */
+static void FinishProgressReports(const TArray<TFunction<void(discord::Result)>>& Callbacks, const discord::Result Result)
+{
+	for (const TFunction<void(discord::Result)>& Callback : Callbacks)
+	{
+		Callback(Result);
+	}
+}
+
+
+UDiscordAchievementManager::UDiscordAchievementManager()
+{
+	const auto Outer = GetOuter();
+	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
+	{
+		DiscordSubsystem = Cast<UDiscordSubsystem>(GetOuter());
+	}
+}
+
+void UDiscordAchievementManager::Initialize(discord::AchievementManager* AchievementManager)
+{
+	Internal_AchievementManager = AchievementManager;
+
+	Internal_OnUserAchievementUpdateCallback = Internal_AchievementManager->OnUserAchievementUpdate.Connect([this](discord::UserAchievement const& UserAchievement)
+	{
+		DiscordSubsystem->RunOnGameThread([this, Updated = FDiscordUserAchievement(UserAchievement)]
+		{
+			UserAchievements.Add(Updated.AchievementID, Updated);
+			OnUserAchievementUpdatedNative.Broadcast(Updated);
+			OnUserAchievementUpdated.Broadcast(Updated);
+		});
+	});
+}
+
+void UDiscordAchievementManager::BeginDestroy()
+{
+	if (Internal_AchievementManager)
+	{
+		Internal_AchievementManager->OnUserAchievementUpdate.Disconnect(Internal_OnUserAchievementUpdateCallback);
+	}
+	
+	UObject::BeginDestroy();
+}
+
+uint8 UDiscordAchievementManager::GetKnownProgress(const int64 AchievementID, const FAchievementProgress& Progress) const
+{
+	const FDiscordUserAchievement* UserAchievement = UserAchievements.Find(AchievementID);
+	const uint8 FetchedPercent = UserAchievement ? UserAchievement->PercentComplete : 0;
+
+	return FMath::Max3(FetchedPercent, Progress.SentPercent, Progress.PendingPercent);
+}
+
+void UDiscordAchievementManager::FlushPendingProgress(const double Now)
+{
+	if (NumPendingAchievements == 0) return;
+
+	const double Interval = GetDefault<UDiscordSettings>()->AchievementWriteIntervalSeconds;
+
+	for (TPair<int64, FAchievementProgress>& Pair : Progresses)
+	{
+		FAchievementProgress& Progress = Pair.Value;
+		if (Progress.NumPendingReports > 0 && Now - Progress.LastFlushTime >= Interval)
+		{
+			SendProgress(Pair.Key, Progress, Now);
+		}
+	}
+}
+
+void UDiscordAchievementManager::SendProgress(const int64 AchievementID, FAchievementProgress& Progress, const double Now)
+{
+	const uint8 Percent = Progress.PendingPercent;
+	const int32 NumMerged = Progress.NumPendingReports - 1;
+	WriteStats.Merged += NumMerged;
+	WriteStats.Updates++;
+
+	DiscordSubsystem->RunOnSdkThread([this, AchievementID, Percent, Callbacks = MoveTemp(Progress.Callbacks)]
+	{
+		Internal_AchievementManager->SetUserAchievement(AchievementID, Percent, [this, AchievementID, Percent, Callbacks](discord::Result Result)
+		{
+			DiscordSubsystem->RunOnGameThread([this, AchievementID, Percent, Result]
+			{
+				OnProgressSent(AchievementID, Percent, Result);
+			});
+
+			FinishProgressReports(Callbacks, Result);
+		});
+	});
+
+	Progress.SentPercent = Percent;
+	Progress.PendingPercent = 0;
+	Progress.NumPendingReports = 0;
+	Progress.Callbacks.Reset();
+	Progress.LastFlushTime = Now;
+	NumPendingAchievements--;
+
+	LOG_DISCORD(Verbose, "Sent progress {Percent} of achievement {AchievementID}, {NumMerged} reports merged", Percent, AchievementID, NumMerged);
+}
+
+void UDiscordAchievementManager::OnProgressSent(const int64 AchievementID, const uint8 Percent, const discord::Result Result)
+{
+	if (Result == discord::Result::Ok) return;
+
+	LOG_DISCORD_ERROR(Result);
+
+	// Forgotten, so that the next report of the same progress is sent again
+	FAchievementProgress* Progress = Progresses.Find(AchievementID);
+	if (Progress && Progress->SentPercent == Percent)
+	{
+		Progress->SentPercent = 0;
+	}
+}
+
+void UDiscordAchievementManager::FetchUserAchievements(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = FetchUserAchievements([Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordAchievementManager::FetchUserAchievements(TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(AchievementManager_FetchUserAchievements);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Internal_AchievementManager->FetchUserAchievements([this, WrappedCallback](discord::Result Result)
+		{
+			if (Result == discord::Result::Ok)
+			{
+				// Read right away on the pumping thread, and handed over before the callback fires
+				int32 Count = 0;
+				Internal_AchievementManager->CountUserAchievements(&Count);
+
+				TArray<FDiscordUserAchievement> Fetched;
+				Fetched.Reserve(Count);
+
+				for (int32 Index = 0; Index < Count; Index++)
+				{
+					discord::UserAchievement UserAchievement;
+					if (Internal_AchievementManager->GetUserAchievementAt(Index, &UserAchievement) == discord::Result::Ok)
+					{
+						Fetched.Emplace(UserAchievement);
+					}
+				}
+
+				DiscordSubsystem->RunOnGameThread([this, Fetched = MoveTemp(Fetched)]
+				{
+					UserAchievements.Reset();
+					for (const FDiscordUserAchievement& UserAchievement : Fetched)
+					{
+						UserAchievements.Add(UserAchievement.AchievementID, UserAchievement);
+					}
+				});
+			}
+			else
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+
+			WrappedCallback(Result);
+		});
+	});
+
+	return Handle;
+}
+
+bool UDiscordAchievementManager::GetUserAchievement(const int64 AchievementID, FDiscordUserAchievement& UserAchievement) const
+{
+	const FDiscordUserAchievement* Found = UserAchievements.Find(AchievementID);
+	if (!Found) return false;
+
+	UserAchievement = *Found;
+	return true;
+}
+
+TArray<FDiscordUserAchievement> UDiscordAchievementManager::GetUserAchievements() const
+{
+	TArray<FDiscordUserAchievement> Result;
+	UserAchievements.GenerateValueArray(Result);
+	return Result;
+}
+
+void UDiscordAchievementManager::SetAchievementProgress(const int64 AchievementID, const uint8 PercentComplete)
+{
+	SetAchievementProgress(AchievementID, PercentComplete, nullptr);
+}
+
+FDiscordOperationHandle UDiscordAchievementManager::SetAchievementProgress(const int64 AchievementID, const uint8 PercentComplete,
+	TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(AchievementManager_SetAchievementProgress);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		if (Callback) Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	const uint8 Percent = FMath::Min<uint8>(PercentComplete, 100);
+	FAchievementProgress& Progress = Progresses.FindOrAdd(AchievementID);
+	WriteStats.Reports++;
+
+	// Progress never goes down, so this report would change nothing
+	if (Percent <= GetKnownProgress(AchievementID, Progress))
+	{
+		WriteStats.Dropped++;
+		if (Callback) Callback(discord::Result::Ok);
+		return {};
+	}
+
+	if (Progress.NumPendingReports++ == 0)
+	{
+		NumPendingAchievements++;
+	}
+	Progress.PendingPercent = Percent;
+
+	// Fire-and-forget reports don't need to be tracked
+	if (!Callback) return {};
+
+	const UDiscordSettings* Settings = GetDefault<UDiscordSettings>();
+	const double Now = FPlatformTime::Seconds();
+
+	// The timeout only starts once the progress is actually sent
+	float Timeout = TimeoutSeconds < 0.f ? Settings->TimeoutSeconds : TimeoutSeconds;
+	if (Timeout > 0.f)
+	{
+		Timeout += FMath::Max(Settings->AchievementWriteIntervalSeconds - (Now - Progress.LastFlushTime), 0.0);
+	}
+
+	FDiscordOperationHandle Handle;
+	Progress.Callbacks.Add(DiscordSubsystem->WrapCallback(MoveTemp(Callback), Timeout, Handle));
+	return Handle;
+}
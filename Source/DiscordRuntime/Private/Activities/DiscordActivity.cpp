@@ -2,6 +2,7 @@
 
 #include "Activities/DiscordActivity.h"
 
+#include "DiscordStats.h"
 #include "Discord/types.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordActivity)
@@ -9,12 +10,16 @@
 
 FDiscordActivityTimestamps::FDiscordActivityTimestamps(discord::ActivityTimestamps const& Timestamps)
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivityTimestamps_FromDiscordType);
+	
 	Start = Timestamps.GetStart();
 	End = Timestamps.GetEnd();
 }
 
 discord::ActivityTimestamps FDiscordActivityTimestamps::ToDiscordType() const
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivityTimestamps_ToDiscordType);
+	
 	discord::ActivityTimestamps Timestamps;
 		
 	Timestamps.SetStart(Start);
@@ -25,6 +30,8 @@ discord::ActivityTimestamps FDiscordActivityTimestamps::ToDiscordType() const
 
 FDiscordActivityAssets::FDiscordActivityAssets(discord::ActivityAssets const& Assets)
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivityAssets_FromDiscordType);
+	
 	LargeImageKey = Assets.GetLargeImage();
 	LargeImageText = Assets.GetLargeText();
 	SmallImageKey = Assets.GetSmallImage();
@@ -33,6 +40,8 @@ FDiscordActivityAssets::FDiscordActivityAssets(discord::ActivityAssets const& As
 
 discord::ActivityAssets FDiscordActivityAssets::ToDiscordType() const
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivityAssets_ToDiscordType);
+	
 	discord::ActivityAssets Assets;
 		
 	Assets.SetLargeImage(TCHAR_TO_UTF8(*LargeImageKey));
@@ -45,6 +54,8 @@ discord::ActivityAssets FDiscordActivityAssets::ToDiscordType() const
 
 FDiscordActivityParty::FDiscordActivityParty(discord::ActivityParty const& Party)
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivityParty_FromDiscordType);
+	
 	ID = Party.GetId();
 	CurrentSize = Party.GetSize().GetCurrentSize();
 	MaxSize = Party.GetSize().GetMaxSize();
@@ -52,6 +63,8 @@ FDiscordActivityParty::FDiscordActivityParty(discord::ActivityParty const& Party
 
 discord::ActivityParty FDiscordActivityParty::ToDiscordType() const
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivityParty_ToDiscordType);
+	
 	discord::ActivityParty Party;
 		
 	Party.SetId(TCHAR_TO_UTF8(*ID));
@@ -63,12 +76,16 @@ discord::ActivityParty FDiscordActivityParty::ToDiscordType() const
 
 FDiscordActivitySecrets::FDiscordActivitySecrets(discord::ActivitySecrets const& Secrets)
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivitySecrets_FromDiscordType);
+	
 	Match = Secrets.GetMatch();
 	Join = Secrets.GetJoin();
 }
 
 discord::ActivitySecrets FDiscordActivitySecrets::ToDiscordType() const
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivitySecrets_ToDiscordType);
+	
 	discord::ActivitySecrets Secrets;
 		
 	Secrets.SetMatch(TCHAR_TO_UTF8(*Match));
@@ -79,6 +96,8 @@ discord::ActivitySecrets FDiscordActivitySecrets::ToDiscordType() const
 
 FDiscordActivity::FDiscordActivity(discord::Activity const& Activity)
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivity_FromDiscordType);
+	
 	ApplicationID = Activity.GetApplicationId();
 	Name = Activity.GetName();
 	State = Activity.GetState();
@@ -90,37 +109,171 @@ FDiscordActivity::FDiscordActivity(discord::Activity const& Activity)
 	Secrets = FDiscordActivitySecrets(Activity.GetSecrets());
 }
 
+FDiscordActivity::FDiscordActivity(const FDiscordUtf8Activity& Activity)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivity_FromUtf8);
+
+	ApplicationID = Activity.ApplicationID;
+	Name = Activity.Name.ToString();
+	State = Activity.State.ToString();
+	Details = Activity.Details.ToString();
+	bInstance = Activity.bInstance;
+	Timestamps.Start = Activity.StartTimestamp;
+	Timestamps.End = Activity.EndTimestamp;
+	Assets.LargeImageKey = Activity.LargeImageKey.ToString();
+	Assets.LargeImageText = Activity.LargeImageText.ToString();
+	Assets.SmallImageKey = Activity.SmallImageKey.ToString();
+	Assets.SmallImageText = Activity.SmallImageText.ToString();
+	Party.ID = Activity.PartyID.ToString();
+	Party.CurrentSize = Activity.PartyCurrentSize;
+	Party.MaxSize = Activity.PartyMaxSize;
+	Secrets.Match = Activity.MatchSecret.ToString();
+	Secrets.Join = Activity.JoinSecret.ToString();
+}
+
 discord::Activity FDiscordActivity::ToDiscordType() const
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivity_ToDiscordType);
+	
 	discord::Activity Activity{};
+	ToDiscordType(Activity, EDiscordActivityFields::All);
+	return Activity;
+}
 
-	if (ApplicationID != -1)
+void FDiscordActivity::ToDiscordType(discord::Activity& Activity, const EDiscordActivityFields Fields) const
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivity_ToDiscordTypeFields);
+
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::Application))
 	{
-		Activity.SetApplicationId(ApplicationID);
-		Activity.SetName(TCHAR_TO_UTF8(*Name));
+		// Left empty unless the activity came from Discord, since it fills them in itself
+		const bool bHasApplication = ApplicationID != -1;
+		Activity.SetApplicationId(bHasApplication ? ApplicationID : 0);
+		Activity.SetName(bHasApplication ? TCHAR_TO_UTF8(*Name) : "");
 	}
-	Activity.SetState(TCHAR_TO_UTF8(*State));
-	Activity.SetDetails(TCHAR_TO_UTF8(*Details));
-	Activity.SetInstance(bInstance);
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::State)) Activity.SetState(TCHAR_TO_UTF8(*State));
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::Details)) Activity.SetDetails(TCHAR_TO_UTF8(*Details));
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::Instance)) Activity.SetInstance(bInstance);
 
 	// Activity Timestamps
-	Activity.GetTimestamps().SetStart(Timestamps.Start);
-	Activity.GetTimestamps().SetEnd(Timestamps.End);
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::Timestamps))
+	{
+		Activity.GetTimestamps().SetStart(Timestamps.Start);
+		Activity.GetTimestamps().SetEnd(Timestamps.End);
+	}
 	
 	// Activity Assets
-	Activity.GetAssets().SetLargeImage(TCHAR_TO_UTF8(*Assets.LargeImageKey));
-	Activity.GetAssets().SetLargeText(TCHAR_TO_UTF8(*Assets.LargeImageText));
-	Activity.GetAssets().SetSmallImage(TCHAR_TO_UTF8(*Assets.SmallImageKey));
-	Activity.GetAssets().SetSmallText(TCHAR_TO_UTF8(*Assets.SmallImageText));
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::LargeImageKey)) Activity.GetAssets().SetLargeImage(TCHAR_TO_UTF8(*Assets.LargeImageKey));
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::LargeImageText)) Activity.GetAssets().SetLargeText(TCHAR_TO_UTF8(*Assets.LargeImageText));
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::SmallImageKey)) Activity.GetAssets().SetSmallImage(TCHAR_TO_UTF8(*Assets.SmallImageKey));
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::SmallImageText)) Activity.GetAssets().SetSmallText(TCHAR_TO_UTF8(*Assets.SmallImageText));
 	
 	// Activity Party
-	Activity.GetParty().SetId(TCHAR_TO_UTF8(*Party.ID));
-	Activity.GetParty().GetSize().SetCurrentSize(Party.CurrentSize);
-	Activity.GetParty().GetSize().SetMaxSize(Party.MaxSize);
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::PartyID)) Activity.GetParty().SetId(TCHAR_TO_UTF8(*Party.ID));
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::PartySize))
+	{
+		Activity.GetParty().GetSize().SetCurrentSize(Party.CurrentSize);
+		Activity.GetParty().GetSize().SetMaxSize(Party.MaxSize);
+	}
 	
 	// Activity Secrets
-	Activity.GetSecrets().SetMatch(TCHAR_TO_UTF8(*Secrets.Match));
-	Activity.GetSecrets().SetJoin(TCHAR_TO_UTF8(*Secrets.Join));
-		
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::SecretsMatch)) Activity.GetSecrets().SetMatch(TCHAR_TO_UTF8(*Secrets.Match));
+	if (EnumHasAnyFlags(Fields, EDiscordActivityFields::SecretsJoin)) Activity.GetSecrets().SetJoin(TCHAR_TO_UTF8(*Secrets.Join));
+}
+
+EDiscordActivityFields FDiscordActivity::GetChangedFields(const FDiscordActivity& Other) const
+{
+	EDiscordActivityFields Fields = EDiscordActivityFields::None;
+
+	// Case-sensitive, since Discord shows the strings as they are
+	if (ApplicationID != Other.ApplicationID || !Name.Equals(Other.Name, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::Application;
+	if (!State.Equals(Other.State, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::State;
+	if (!Details.Equals(Other.Details, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::Details;
+	if (bInstance != Other.bInstance) Fields |= EDiscordActivityFields::Instance;
+	if (Timestamps.Start != Other.Timestamps.Start || Timestamps.End != Other.Timestamps.End) Fields |= EDiscordActivityFields::Timestamps;
+	if (!Assets.LargeImageKey.Equals(Other.Assets.LargeImageKey, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::LargeImageKey;
+	if (!Assets.LargeImageText.Equals(Other.Assets.LargeImageText, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::LargeImageText;
+	if (!Assets.SmallImageKey.Equals(Other.Assets.SmallImageKey, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::SmallImageKey;
+	if (!Assets.SmallImageText.Equals(Other.Assets.SmallImageText, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::SmallImageText;
+	if (!Party.ID.Equals(Other.Party.ID, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::PartyID;
+	if (Party.CurrentSize != Other.Party.CurrentSize || Party.MaxSize != Other.Party.MaxSize) Fields |= EDiscordActivityFields::PartySize;
+	if (!Secrets.Match.Equals(Other.Secrets.Match, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::SecretsMatch;
+	if (!Secrets.Join.Equals(Other.Secrets.Join, ESearchCase::CaseSensitive)) Fields |= EDiscordActivityFields::SecretsJoin;
+
+	return Fields;
+}
+
+uint32 GetTypeHash(const FDiscordActivity& Activity)
+{
+	uint32 Hash = GetTypeHash(Activity.ApplicationID);
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.State));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.Details));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.bInstance));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.Timestamps.Start));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.Timestamps.End));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.Assets.LargeImageKey));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.Assets.SmallImageKey));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.Party.ID));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.Party.CurrentSize));
+	Hash = HashCombineFast(Hash, GetTypeHash(Activity.Party.MaxSize));
+	return Hash;
+}
+
+// CopyFromBuffer copies the whole native buffer, so each string must be exactly as large as the field it mirrors
+static_assert(sizeof(FDiscordUtf8Activity::Name) == sizeof(DiscordActivity::name), "FDiscordUtf8Activity::Name doesn't match DiscordActivity::name");
+static_assert(sizeof(FDiscordUtf8Activity::State) == sizeof(DiscordActivity::state), "FDiscordUtf8Activity::State doesn't match DiscordActivity::state");
+static_assert(sizeof(FDiscordUtf8Activity::Details) == sizeof(DiscordActivity::details), "FDiscordUtf8Activity::Details doesn't match DiscordActivity::details");
+static_assert(sizeof(FDiscordUtf8Activity::LargeImageKey) == sizeof(DiscordActivityAssets::large_image), "FDiscordUtf8Activity::LargeImageKey doesn't match DiscordActivityAssets::large_image");
+static_assert(sizeof(FDiscordUtf8Activity::LargeImageText) == sizeof(DiscordActivityAssets::large_text), "FDiscordUtf8Activity::LargeImageText doesn't match DiscordActivityAssets::large_text");
+static_assert(sizeof(FDiscordUtf8Activity::SmallImageKey) == sizeof(DiscordActivityAssets::small_image), "FDiscordUtf8Activity::SmallImageKey doesn't match DiscordActivityAssets::small_image");
+static_assert(sizeof(FDiscordUtf8Activity::SmallImageText) == sizeof(DiscordActivityAssets::small_text), "FDiscordUtf8Activity::SmallImageText doesn't match DiscordActivityAssets::small_text");
+static_assert(sizeof(FDiscordUtf8Activity::PartyID) == sizeof(DiscordActivityParty::id), "FDiscordUtf8Activity::PartyID doesn't match DiscordActivityParty::id");
+static_assert(sizeof(FDiscordUtf8Activity::MatchSecret) == sizeof(DiscordActivitySecrets::match), "FDiscordUtf8Activity::MatchSecret doesn't match DiscordActivitySecrets::match");
+static_assert(sizeof(FDiscordUtf8Activity::JoinSecret) == sizeof(DiscordActivitySecrets::join), "FDiscordUtf8Activity::JoinSecret doesn't match DiscordActivitySecrets::join");
+
+FDiscordUtf8Activity::FDiscordUtf8Activity(discord::Activity const& Activity)
+{
+	ApplicationID = Activity.GetApplicationId();
+	Name.CopyFromBuffer(Activity.GetName());
+	State.CopyFromBuffer(Activity.GetState());
+	Details.CopyFromBuffer(Activity.GetDetails());
+	StartTimestamp = Activity.GetTimestamps().GetStart();
+	EndTimestamp = Activity.GetTimestamps().GetEnd();
+	LargeImageKey.CopyFromBuffer(Activity.GetAssets().GetLargeImage());
+	LargeImageText.CopyFromBuffer(Activity.GetAssets().GetLargeText());
+	SmallImageKey.CopyFromBuffer(Activity.GetAssets().GetSmallImage());
+	SmallImageText.CopyFromBuffer(Activity.GetAssets().GetSmallText());
+	PartyID.CopyFromBuffer(Activity.GetParty().GetId());
+	PartyCurrentSize = Activity.GetParty().GetSize().GetCurrentSize();
+	PartyMaxSize = Activity.GetParty().GetSize().GetMaxSize();
+	MatchSecret.CopyFromBuffer(Activity.GetSecrets().GetMatch());
+	JoinSecret.CopyFromBuffer(Activity.GetSecrets().GetJoin());
+	bInstance = Activity.GetInstance();
+}
+
+discord::Activity FDiscordUtf8Activity::ToDiscordType() const
+{
+	discord::Activity Activity{};
+
+	if (ApplicationID != -1)
+	{
+		Activity.SetApplicationId(ApplicationID);
+		Activity.SetName(Name.Get());
+	}
+	Activity.SetState(State.Get());
+	Activity.SetDetails(Details.Get());
+	Activity.SetInstance(bInstance);
+	Activity.GetTimestamps().SetStart(StartTimestamp);
+	Activity.GetTimestamps().SetEnd(EndTimestamp);
+	Activity.GetAssets().SetLargeImage(LargeImageKey.Get());
+	Activity.GetAssets().SetLargeText(LargeImageText.Get());
+	Activity.GetAssets().SetSmallImage(SmallImageKey.Get());
+	Activity.GetAssets().SetSmallText(SmallImageText.Get());
+	Activity.GetParty().SetId(PartyID.Get());
+	Activity.GetParty().GetSize().SetCurrentSize(PartyCurrentSize);
+	Activity.GetParty().GetSize().SetMaxSize(PartyMaxSize);
+	Activity.GetSecrets().SetMatch(MatchSecret.Get());
+	Activity.GetSecrets().SetJoin(JoinSecret.Get());
+
 	return Activity;
 }
@@ -0,0 +1,24 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordActivityBuilder.h"
+
+#include "DiscordLogChannel.h"
+#include "DiscordStats.h"
+
+
+const discord::Activity& FDiscordActivityBuilder::Build(const FDiscordActivity& Activity)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordActivityBuilder_Build);
+
+	const EDiscordActivityFields ChangedFields = bHasLastActivity ? Activity.GetChangedFields(LastActivity) : EDiscordActivityFields::All;
+	if (ChangedFields != EDiscordActivityFields::None)
+	{
+		LOG_DISCORD(VeryVerbose, "Encoding activity fields {Fields}", static_cast<uint16>(ChangedFields));
+
+		Activity.ToDiscordType(NativeActivity, ChangedFields);
+		LastActivity = Activity;
+		bHasLastActivity = true;
+	}
+
+	return NativeActivity;
+}
@@ -0,0 +1,27 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "Activities/DiscordActivity.h"
+#include "Discord/types.h"
+
+
+/**
+ * Keeps the last encoded native activity around, so that only the fields that changed since then are converted and
+ * copied into it again. Not thread-safe.
+ */
+class FDiscordActivityBuilder final
+{
+public:
+	/**
+	 * Brings the native activity up to date with the given one and returns it.
+	 */
+	const discord::Activity& Build(const FDiscordActivity& Activity);
+
+private:
+	discord::Activity NativeActivity{};
+
+	FDiscordActivity LastActivity;
+
+	bool bHasLastActivity = false;
+};
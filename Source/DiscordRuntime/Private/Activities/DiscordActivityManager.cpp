@@ -2,15 +2,25 @@
 
 #include "Activities/DiscordActivityManager.h"
 
+#include "DiscordActivityBuilder.h"
+#include "DiscordCallbackPump.h"
 #include "DiscordLatentAction.h"
 #include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+#include "DiscordStats.h"
 #include "DiscordSubsystem.h"
+#include "Users/DiscordUserManager.h"
 #include "Discord/activity_manager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordActivityManager)
 
 
+/** Discord allows 5 activity updates per 20 seconds. */
+static constexpr int32 ActivityUpdateLimit = 5;
+static constexpr double ActivityUpdateWindowSeconds = 20.0;
+
 UDiscordActivityManager::UDiscordActivityManager()
+	: ActivityRateLimiter(ActivityUpdateLimit, ActivityUpdateWindowSeconds)
 {
 	const auto Outer = GetOuter();
 	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
@@ -22,22 +32,40 @@ UDiscordActivityManager::UDiscordActivityManager()
 void UDiscordActivityManager::Initialize(discord::ActivityManager* ActivityManager)
 {
 	Internal_ActivityManager = ActivityManager;
+	ActivityBuilder = new FDiscordActivityBuilder();
 	
-	Internal_OnJoinCallback = Internal_ActivityManager->OnActivityJoin.Connect([&](const char* Secret)
+	Internal_OnJoinCallback = Internal_ActivityManager->OnActivityJoin.Connect([this](const char* Secret)
 	{
-		OnActivityJoin.Broadcast(Secret);
+		TDiscordUtf8String<128> JoinSecret;
+		JoinSecret.CopyFromString(Secret);
+
+		DiscordSubsystem->RunOnGameThread([this, JoinSecret]
+		{
+			OnActivityJoinNative.Broadcast(JoinSecret.Get());
+			if (OnActivityJoin.IsBound()) OnActivityJoin.Broadcast(JoinSecret.ToString());
+		});
 	});
 	
-	Internal_OnJoinRequestCallback = Internal_ActivityManager->OnActivityJoinRequest.Connect([&](discord::User const& InviteUser)
+	Internal_OnJoinRequestCallback = Internal_ActivityManager->OnActivityJoinRequest.Connect([this](discord::User const& InviteUser)
 	{
-		OnActivityJoinRequest.Broadcast(FDiscordUser(InviteUser));
+		DiscordSubsystem->RunOnGameThread([this, User = FDiscordUtf8User(InviteUser)]
+		{
+			OnActivityJoinRequestNative.Broadcast(User);
+			if (OnActivityJoinRequest.IsBound()) OnActivityJoinRequest.Broadcast(FDiscordUser(User));
+		});
 	});
 	
-	Internal_OnInviteCallback = Internal_ActivityManager->OnActivityInvite.Connect([&](discord::ActivityActionType InviteType,
+	Internal_OnInviteCallback = Internal_ActivityManager->OnActivityInvite.Connect([this](discord::ActivityActionType InviteType,
 		discord::User const& InviteUser, discord::Activity const& InviteActivity)
 	{
-		OnActivityInvite.Broadcast(FDiscordUser(InviteUser), FDiscordActivity(InviteActivity));
+		DiscordSubsystem->RunOnGameThread([this, User = FDiscordUtf8User(InviteUser), Activity = FDiscordUtf8Activity(InviteActivity)]
+		{
+			OnActivityInviteNative.Broadcast(User, Activity);
+			if (OnActivityInvite.IsBound()) OnActivityInvite.Broadcast(FDiscordUser(User), FDiscordActivity(Activity));
+		});
 	});
+
+	DiscordSubsystem->GetUserManager()->OnCurrentUserUpdatedNative.AddUObject(this, &UDiscordActivityManager::OnCurrentUserUpdated);
 }
 
 void UDiscordActivityManager::BeginDestroy()
@@ -48,123 +76,313 @@ void UDiscordActivityManager::BeginDestroy()
 		Internal_ActivityManager->OnActivityJoinRequest.Disconnect(Internal_OnJoinRequestCallback);
 		Internal_ActivityManager->OnActivityInvite.Disconnect(Internal_OnInviteCallback);
 	}
+
+	if (ActivityBuilder)
+	{
+		delete ActivityBuilder;
+		ActivityBuilder = nullptr;
+	}
 	
 	UObject::BeginDestroy();
 }
 
+bool UDiscordActivityManager::FlushPendingActivity(const double Now)
+{
+	if (!PendingActivity.IsSet() && !bPendingClear) return true;
+
+	TArray<TFunction<void(discord::Result)>> Callbacks = MoveTemp(PendingActivityCallbacks);
+	PendingActivityCallbacks.Reset();
+
+	// The updates that came in while waiting may have put the activity back to what was last sent
+	if (PendingActivity.IsSet() && LastSentActivity.IsSet() && *LastSentActivity == *PendingActivity)
+	{
+		ActivityUpdateStats.Skipped++;
+		PendingActivity.Reset();
+
+		for (const TFunction<void(discord::Result)>& Callback : Callbacks)
+		{
+			Callback(discord::Result::Ok);
+		}
+		return true;
+	}
+
+	if (!ActivityRateLimiter.TryAcquire(Now))
+	{
+		PendingActivityCallbacks = MoveTemp(Callbacks);
+		return false;
+	}
+
+	if (bPendingClear)
+	{
+		bPendingClear = false;
+		LastSentActivity.Reset();
+		++LastSentActivitySerial;
+
+		DiscordSubsystem->RunOnSdkThread([Manager = Internal_ActivityManager, Callbacks = MoveTemp(Callbacks)]
+		{
+			Manager->ClearActivity([Callbacks](discord::Result Result)
+			{
+				for (const TFunction<void(discord::Result)>& Callback : Callbacks)
+				{
+					Callback(Result);
+				}
+			});
+		});
+
+		return true;
+	}
+
+	ActivityUpdateStats.Sent++;
+	LastSentActivity = MoveTemp(*PendingActivity);
+	PendingActivity.Reset();
+
+	DiscordSubsystem->RunOnSdkThread([this, Manager = Internal_ActivityManager, Activity = ActivityBuilder->Build(*LastSentActivity),
+		Serial = ++LastSentActivitySerial, Callbacks = MoveTemp(Callbacks)]
+	{
+		Manager->UpdateActivity(Activity, [this, Serial, Callbacks](discord::Result Result)
+		{
+			if (Result != discord::Result::Ok)
+			{
+				// Don't skip a retry of an update that didn't go through
+				DiscordSubsystem->RunOnGameThread([this, Serial]
+				{
+					if (Serial == LastSentActivitySerial) LastSentActivity.Reset();
+				});
+			}
+
+			for (const TFunction<void(discord::Result)>& Callback : Callbacks)
+			{
+				Callback(Result);
+			}
+		});
+	});
+
+	return true;
+}
+
+void UDiscordActivityManager::SupersedePendingActivity()
+{
+	// The callbacks are kept, and fire with the result of whatever is sent instead
+	PendingActivity.Reset();
+	bPendingClear = false;
+}
+
+void UDiscordActivityManager::OnCurrentUserUpdated(const FDiscordUtf8User& User)
+{
+	// Also fires for profile changes, which only costs a single update that could have been skipped
+	LastSentActivity.Reset();
+	++LastSentActivitySerial;
+}
+
 bool UDiscordActivityManager::RegisterCommand(const FString Command)
 {
+	DISCORD_SCOPE_CALL(ActivityManager_RegisterCommand);
+	
 	if (!DiscordSubsystem->IsActive()) return false;
 	
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
 	return Internal_ActivityManager->RegisterCommand(TCHAR_TO_UTF8(*Command)) == discord::Result::Ok;
 }
 
 bool UDiscordActivityManager::RegisterSteam(const int32 SteamAppID)
 {
+	DISCORD_SCOPE_CALL(ActivityManager_RegisterSteam);
+	
 	if (!DiscordSubsystem->IsActive()) return false;
 	
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
 	return Internal_ActivityManager->RegisterSteam(SteamAppID) == discord::Result::Ok;
 }
 
 void UDiscordActivityManager::UpdateActivity(const UObject* WorldContext, const FLatentActionInfo LatentInfo,
-	const FDiscordActivity NewActivity, EDiscordOutputPins& OutputPins)
+	const FDiscordActivity& NewActivity, EDiscordOutputPins& OutputPins)
 {
-	FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins, [this, NewActivity](auto* Action) mutable
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = UpdateActivity(NewActivity, [Action](discord::Result Result)
 	{
-		UpdateActivity(NewActivity, [Action](discord::Result Result) mutable
-		{
-			Action->FinishOperation(Result == discord::Result::Ok);
-		});
+		Action->FinishOperation(Result == discord::Result::Ok);
 	});
+	Action->SetOperation(DiscordSubsystem, Handle);
 }
 
-void UDiscordActivityManager::UpdateActivity(const FDiscordActivity NewActivity, TFunction<void(discord::Result)> Callback)
+FDiscordOperationHandle UDiscordActivityManager::UpdateActivity(const FDiscordActivity& NewActivity, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
 {
+	DISCORD_SCOPE_CALL(ActivityManager_UpdateActivity);
+	
 	if (!DiscordSubsystem->IsActive()) {
 		Callback(discord::Result::InternalError);
-		return;
+		return {};
 	}
-	
-	discord::Activity Activity = NewActivity.ToDiscordType();
-	Internal_ActivityManager->UpdateActivity(Activity, Callback);
+
+	if (bPendingClear)
+	{
+		SupersedePendingActivity();
+	}
+	else if (!PendingActivity.IsSet() && LastSentActivity.IsSet() && *LastSentActivity == NewActivity)
+	{
+		ActivityUpdateStats.Skipped++;
+		Callback(discord::Result::Ok);
+		return {};
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	// The timeout only starts once the update is actually sent
+	float Timeout = TimeoutSeconds < 0.f ? GetDefault<UDiscordSettings>()->TimeoutSeconds : TimeoutSeconds;
+	if (Timeout > 0.f)
+	{
+		Timeout += ActivityRateLimiter.GetTimeUntilAvailable(Now);
+	}
+
+	FDiscordOperationHandle Handle;
+	PendingActivityCallbacks.Add(DiscordSubsystem->WrapCallback(MoveTemp(Callback), Timeout, Handle));
+
+	if (PendingActivity.IsSet())
+	{
+		ActivityUpdateStats.Coalesced++;
+	}
+	PendingActivity = NewActivity;
+
+	if (!FlushPendingActivity(Now))
+	{
+		ActivityUpdateStats.Deferred++;
+		LOG_DISCORD(Verbose, "Deferred activity update by {Delay}s to respect the rate limit", ActivityRateLimiter.GetTimeUntilAvailable(Now));
+	}
+
+	return Handle;
 }
 
 void UDiscordActivityManager::ClearActivity(const UObject* WorldContext, const FLatentActionInfo LatentInfo,
 	EDiscordOutputPins& OutputPins)
 {
-	FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins, [this](auto* Action) mutable
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = ClearActivity([Action](discord::Result Result)
 	{
-		ClearActivity([Action](discord::Result Result) mutable
-		{
-			Action->FinishOperation(Result == discord::Result::Ok);
-		});
+		Action->FinishOperation(Result == discord::Result::Ok);
 	});
+	Action->SetOperation(DiscordSubsystem, Handle);
 }
 
-void UDiscordActivityManager::ClearActivity(TFunction<void(discord::Result)> Callback)
+FDiscordOperationHandle UDiscordActivityManager::ClearActivity(TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
 {
+	DISCORD_SCOPE_CALL(ActivityManager_ClearActivity);
+	
 	if (!DiscordSubsystem->IsActive()) {
 		Callback(discord::Result::InternalError);
-		return;
+		return {};
 	}
 	
 	LOG_DISCORD(Warning, "This probably won't work, see issue https://github.com/discord/discord-api-docs/issues/6612");
-	Internal_ActivityManager->ClearActivity(Callback);
+
+	// An update still waiting would otherwise go out after the clear and override it
+	if (PendingActivity.IsSet())
+	{
+		SupersedePendingActivity();
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	// Clears count against the same rate limit as updates, so they wait for it the same way
+	float Timeout = TimeoutSeconds < 0.f ? GetDefault<UDiscordSettings>()->TimeoutSeconds : TimeoutSeconds;
+	if (Timeout > 0.f)
+	{
+		Timeout += ActivityRateLimiter.GetTimeUntilAvailable(Now);
+	}
+
+	FDiscordOperationHandle Handle;
+	PendingActivityCallbacks.Add(DiscordSubsystem->WrapCallback(MoveTemp(Callback), Timeout, Handle));
+	bPendingClear = true;
+
+	if (!FlushPendingActivity(Now))
+	{
+		LOG_DISCORD(Verbose, "Deferred activity clear by {Delay}s to respect the rate limit", ActivityRateLimiter.GetTimeUntilAvailable(Now));
+	}
+
+	return Handle;
 }
 
 void UDiscordActivityManager::SendRequestReply(const UObject* WorldContext, const FLatentActionInfo LatentInfo,
 	const int64 UserID, const EDiscordActivityJoinRequestReplyTypes::Type Reply, EDiscordOutputPins& OutputPins)
 {
-	FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins, [this, UserID, Reply](auto* Action) mutable
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = SendRequestReply(UserID, Reply, [Action](discord::Result Result)
 	{
-		SendRequestReply(UserID, Reply, [Action](discord::Result Result) mutable
-		{
-			Action->FinishOperation(Result == discord::Result::Ok);
-		});
+		Action->FinishOperation(Result == discord::Result::Ok);
 	});
+	Action->SetOperation(DiscordSubsystem, Handle);
 }
 
-void UDiscordActivityManager::SendRequestReply(const int64 UserID, const EDiscordActivityJoinRequestReplyTypes::Type Reply, TFunction<void(discord::Result)> Callback) const
+FDiscordOperationHandle UDiscordActivityManager::SendRequestReply(const int64 UserID, const EDiscordActivityJoinRequestReplyTypes::Type Reply, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds) const
 {
+	DISCORD_SCOPE_CALL(ActivityManager_SendRequestReply);
+	
 	if (!DiscordSubsystem->IsActive()) {
 		Callback(discord::Result::InternalError);
-		return;
+		return {};
 	}
 	
-	Internal_ActivityManager->SendRequestReply(UserID, static_cast<discord::ActivityJoinRequestReply>(Reply), Callback);
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_ActivityManager, UserID, Reply, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Manager->SendRequestReply(UserID, static_cast<discord::ActivityJoinRequestReply>(Reply), WrappedCallback);
+	});
+
+	return Handle;
 }
 
 void UDiscordActivityManager::SendInvite(const UObject* WorldContext, const FLatentActionInfo LatentInfo,
-	const int64 UserID, const FString Content, EDiscordOutputPins& OutputPins)
+	const int64 UserID, const FString& Content, EDiscordOutputPins& OutputPins)
 {
-	FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins, [this, UserID, Content](auto* Action) mutable
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = SendInvite(UserID, Content, [Action](discord::Result Result)
 	{
-		SendInvite(UserID, Content, [Action](discord::Result Result) mutable
-		{
-			Action->FinishOperation(Result == discord::Result::Ok);
-		});
+		Action->FinishOperation(Result == discord::Result::Ok);
 	});
+	Action->SetOperation(DiscordSubsystem, Handle);
 }
 
-void UDiscordActivityManager::SendInvite(const int64 UserID, const FString Content, TFunction<void(discord::Result)> Callback) const
+FDiscordOperationHandle UDiscordActivityManager::SendInvite(const int64 UserID, const FString& Content, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds) const
 {
+	DISCORD_SCOPE_CALL(ActivityManager_SendInvite);
+	
 	if (!DiscordSubsystem->IsActive()) {
 		Callback(discord::Result::InternalError);
-		return;
+		return {};
 	}
 	
-	Internal_ActivityManager->SendInvite(UserID, discord::ActivityActionType::Join, TCHAR_TO_UTF8(*Content), Callback);
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_ActivityManager, UserID, Content, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Manager->SendInvite(UserID, discord::ActivityActionType::Join, TCHAR_TO_UTF8(*Content), WrappedCallback);
+	});
+
+	return Handle;
 }
 
 void UDiscordActivityManager::AcceptInvite(const int64 UserID) const
 {
+	DISCORD_SCOPE_CALL(ActivityManager_AcceptInvite);
+	
 	if (!DiscordSubsystem->IsActive()) return;
 	
-	Internal_ActivityManager->AcceptInvite(UserID, [](discord::Result Result)
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_ActivityManager, UserID]
 	{
-		// This callback apparently never fires
-		if (Result != discord::Result::Ok) {
-			LOG_DISCORD_ERROR(Result);
-		}
+		Manager->AcceptInvite(UserID, [](discord::Result Result)
+		{
+			// This callback apparently never fires
+			if (Result != discord::Result::Ok) {
+				LOG_DISCORD_ERROR(Result);
+			}
+		});
 	});
 }
@@ -0,0 +1,41 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordBufferPool.h"
+
+#include "Misc/ScopeLock.h"
+
+
+FDiscordBufferPool::FDiscordBufferPool(const int32 InMaxBuffers, const int32 InMaxBufferSize)
+	: MaxBuffers(InMaxBuffers), MaxBufferSize(InMaxBufferSize)
+{
+	FreeBuffers.Reserve(MaxBuffers);
+}
+
+TArray<uint8> FDiscordBufferPool::Acquire(const int32 MinCapacity)
+{
+	TArray<uint8> Buffer;
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (FreeBuffers.Num() > 0)
+		{
+			Buffer = FreeBuffers.Pop(EAllowShrinking::No);
+		}
+	}
+
+	Buffer.Reserve(MinCapacity);
+	return Buffer;
+}
+
+void FDiscordBufferPool::Release(TArray<uint8>&& Buffer)
+{
+	// Oversized buffers would pin their memory for good
+	if (Buffer.Max() == 0 || Buffer.Max() > MaxBufferSize) return;
+
+	Buffer.Reset();
+
+	FScopeLock ScopeLock(&Lock);
+	if (FreeBuffers.Num() < MaxBuffers)
+	{
+		FreeBuffers.Add(MoveTemp(Buffer));
+	}
+}
@@ -0,0 +1,39 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+
+/**
+ * Keeps byte buffers around once they're released, so that their memory is reused by the next ones instead of being
+ * allocated again. Buffers can be acquired and released from any thread.
+ */
+class FDiscordBufferPool final
+{
+public:
+	/**
+	 * Keeps up to MaxBuffers released buffers, and drops those that grew larger than MaxBufferSize.
+	 */
+	FDiscordBufferPool(const int32 InMaxBuffers, const int32 InMaxBufferSize);
+
+	/**
+	 * Returns an empty buffer that can hold at least MinCapacity bytes without growing.
+	 */
+	TArray<uint8> Acquire(const int32 MinCapacity = 0);
+
+	/**
+	 * Gives a buffer back to the pool.
+	 */
+	void Release(TArray<uint8>&& Buffer);
+
+private:
+	FCriticalSection Lock;
+
+	TArray<TArray<uint8>> FreeBuffers;
+
+	int32 MaxBuffers;
+
+	int32 MaxBufferSize;
+};
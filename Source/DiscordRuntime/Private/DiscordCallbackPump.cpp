@@ -0,0 +1,118 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordCallbackPump.h"
+
+#include "DiscordLogChannel.h"
+#include "DiscordPumpScheduler.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Discord/core.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+
+
+FDiscordCallbackPump::FDiscordCallbackPump(discord::Core* InCore, FDiscordPumpScheduler* InScheduler)
+	: Core(InCore), Scheduler(InScheduler)
+{
+	check(Core && Scheduler);
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("DiscordCallbackPump"), 0, TPri_BelowNormal);
+}
+
+FDiscordCallbackPump::~FDiscordCallbackPump()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FDiscordCallbackPump::EnqueueSdkCommand(TUniqueFunction<void()>&& Command)
+{
+	SdkCommands.Enqueue(MoveTemp(Command));
+	WakeEvent->Trigger();
+}
+
+void FDiscordCallbackPump::EnqueueGameThreadTask(TUniqueFunction<void()>&& Task)
+{
+	GameThreadTasks.Enqueue(MoveTemp(Task));
+}
+
+int32 FDiscordCallbackPump::DrainGameThreadTasks(const double BudgetSeconds)
+{
+	check(IsInGameThread());
+	DISCORD_SCOPE_CYCLE_COUNTER(DrainGameThreadTasks);
+
+	const double EndTime = FPlatformTime::Seconds() + BudgetSeconds;
+	int32 NumTasks = 0;
+
+	// Always run at least one task so that a tiny budget can't starve the queue
+	TUniqueFunction<void()> Task;
+	while (GameThreadTasks.Dequeue(Task))
+	{
+		DISCORD_SCOPE_CYCLE_COUNTER(DispatchCallback);
+		INC_DWORD_STAT(STAT_DiscordDispatchedCallbacks);
+		Task();
+		NumTasks++;
+
+		if (FPlatformTime::Seconds() >= EndTime) break;
+	}
+
+	return NumTasks;
+}
+
+uint32 FDiscordCallbackPump::Run()
+{
+	LOG_DISCORD(Log, "Started callback pump worker thread");
+
+	while (!bStopping)
+	{
+		// The lock is taken per command and again for the pump, so that a synchronous call from the game thread waits
+		// for at most one of them instead of the whole batch
+		TUniqueFunction<void()> Command;
+		while (SdkCommands.Dequeue(Command))
+		{
+			FScopeLock Lock(&SdkLock);
+			Command();
+		}
+
+		{
+			FScopeLock Lock(&SdkLock);
+			DISCORD_SCOPE_CYCLE_COUNTER(RunCallbacks);
+			Core->RunCallbacks();
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		Scheduler->OnPumped(Now);
+
+		// Queued commands trigger the event, so they never wait for the full interval
+		WakeEvent->Wait(FTimespan::FromSeconds(Scheduler->GetPumpInterval(Now)));
+	}
+
+	LOG_DISCORD(Log, "Stopped callback pump worker thread");
+	return 0;
+}
+
+void FDiscordCallbackPump::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+FDiscordSdkScopeLock::FDiscordSdkScopeLock(const UDiscordSubsystem* DiscordSubsystem)
+	: SdkLock(DiscordSubsystem->GetSdkLock())
+{
+	if (SdkLock) SdkLock->Lock();
+}
+
+FDiscordSdkScopeLock::~FDiscordSdkScopeLock()
+{
+	if (SdkLock) SdkLock->Unlock();
+}
@@ -0,0 +1,83 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordTypes.h"
+#include "Containers/Queue.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FDiscordPumpScheduler;
+class FEvent;
+class FRunnableThread;
+class UDiscordSubsystem;
+
+
+/**
+ * Owns the Discord Core while callbacks are pumped on a dedicated worker thread. Commands that call into the SDK are
+ * queued to the worker, and results and events are handed back to the game thread through a lock-free MPSC queue.
+ */
+class FDiscordCallbackPump final : public FRunnable
+{
+public:
+	FDiscordCallbackPump(discord::Core* InCore, FDiscordPumpScheduler* InScheduler);
+	virtual ~FDiscordCallbackPump() override;
+
+	/**
+	 * Queues a command to run on the worker thread before its next pump.
+	 */
+	void EnqueueSdkCommand(TUniqueFunction<void()>&& Command);
+
+	/**
+	 * Queues a task to run on the game thread the next time tasks are drained.
+	 */
+	void EnqueueGameThreadTask(TUniqueFunction<void()>&& Task);
+
+	/**
+	 * Runs queued game thread tasks until the queue is empty or the budget is spent. Returns the number of tasks run.
+	 */
+	int32 DrainGameThreadTasks(const double BudgetSeconds);
+
+	/**
+	 * The lock held by the worker thread while it runs a command or pumps the callbacks. Synchronous SDK calls must hold
+	 * it too, so they may wait for the command or pump in progress.
+	 */
+	FCriticalSection& GetSdkLock() { return SdkLock; }
+
+	// Begin FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable interface
+
+private:
+	discord::Core* Core;
+
+	FDiscordPumpScheduler* Scheduler;
+
+	FRunnableThread* Thread = nullptr;
+
+	FEvent* WakeEvent = nullptr;
+
+	FCriticalSection SdkLock;
+
+	std::atomic<bool> bStopping = false;
+
+	TQueue<TUniqueFunction<void()>, EQueueMode::Mpsc> SdkCommands;
+
+	TQueue<TUniqueFunction<void()>, EQueueMode::Mpsc> GameThreadTasks;
+};
+
+
+/**
+ * Locks the SDK for a synchronous call when callbacks are pumped on a worker thread. Does nothing otherwise.
+ */
+class FDiscordSdkScopeLock
+{
+public:
+	explicit FDiscordSdkScopeLock(const UDiscordSubsystem* DiscordSubsystem);
+	~FDiscordSdkScopeLock();
+
+private:
+	FCriticalSection* SdkLock;
+};
@@ -3,14 +3,38 @@
 #include "DiscordLatentAction.h"
 
 #include "DiscordLogChannel.h"
+#include "DiscordSubsystem.h"
+#include "Containers/AllocatorFixedSizeFreeList.h"
 #include "Engine/Engine.h"
 #include "Engine/World.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordLatentAction)
 
 
-void FDiscordLatentAction::CreateAndAdd(const UObject* WorldContext, const FLatentActionInfo& LatentInfo,
-                                        EDiscordOutputPins& OutputPins, TFunction<void(FDiscordLatentAction*)> DiscordAction)
+/** Latent actions only live on the game thread, so a single-threaded free list is enough. */
+using FDiscordLatentActionPool = TAllocatorFixedSizeFreeList<sizeof(FDiscordLatentAction), 16>;
+
+static FDiscordLatentActionPool& GetLatentActionPool()
+{
+	static FDiscordLatentActionPool Pool;
+	return Pool;
+}
+
+void* FDiscordLatentAction::operator new(size_t Size)
+{
+	check(IsInGameThread());
+	check(Size == sizeof(FDiscordLatentAction));
+	return GetLatentActionPool().Allocate();
+}
+
+void FDiscordLatentAction::operator delete(void* Action)
+{
+	check(IsInGameThread());
+	if (Action) GetLatentActionPool().Free(Action);
+}
+
+FDiscordLatentAction* FDiscordLatentAction::CreateAndAdd(const UObject* WorldContext, const FLatentActionInfo& LatentInfo,
+                                                         EDiscordOutputPins& OutputPins)
 {
 	UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::Assert);
 	FLatentActionManager& LatentActionManager = World->GetLatentActionManager();
@@ -18,31 +42,36 @@ void FDiscordLatentAction::CreateAndAdd(const UObject* WorldContext, const FLate
 	if (LatentActionManager.FindExistingAction<FDiscordLatentAction>(LatentInfo.CallbackTarget, LatentInfo.UUID))
 	{
 		LOG_DISCORD(Warning, "Tried to re-execute ongoing action [{UUID}] in {Function}", LatentInfo.UUID, LatentInfo.ExecutionFunction);
-		return;
+		return nullptr;
 	}
 
-	FDiscordLatentAction* Action = new FDiscordLatentAction(LatentInfo, OutputPins, DiscordAction);
+	LOG_DISCORD(Log, "Started Discord latent action [{UUID}]", LatentInfo.UUID);
+	FDiscordLatentAction* Action = new FDiscordLatentAction(LatentInfo, OutputPins);
 	LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, Action);
+	return Action;
+}
+
+FDiscordLatentAction::~FDiscordLatentAction()
+{
+	if (!bShouldFinish && DiscordSubsystem.IsValid() && DiscordSubsystem->CancelOperation(Operation))
+	{
+		LOG_DISCORD(Verbose, "Cancelled Discord latent action [{UUID}]", LatentInfo.UUID);
+	}
 }
 
 void FDiscordLatentAction::UpdateOperation(FLatentResponse& Response)
 {
-	ElapsedTime += Response.ElapsedTime();
-	
-	if (!bInitialized)
+	if (!bTriggeredThen)
 	{
-		LOG_DISCORD(Log, "Started Discord latent action [{UUID}] timeout", LatentInfo.UUID);
-		bInitialized = true;
-		DiscordAction(this);
+		bTriggeredThen = true;
 		Response.TriggerLink(LatentInfo.ExecutionFunction, LatentInfo.Linkage, LatentInfo.CallbackTarget);
 		return;
 	}
 
-	if (!bShouldFinish && ElapsedTime > Timeout)
+	// The callback may fire before the Then pin was triggered, so the output is only set once we're done with it
+	if (bShouldFinish)
 	{
-		bShouldFinish = true;
-		Output = EDiscordOutputPins::Failed;
-		LOG_DISCORD(Warning, "Discord latent action [{UUID}] timeout", LatentInfo.UUID);
+		Output = bSucceeded ? EDiscordOutputPins::Success : EDiscordOutputPins::Failed;
 	}
 	
 	Response.FinishAndTriggerIf(bShouldFinish, LatentInfo.ExecutionFunction, LatentInfo.Linkage, LatentInfo.CallbackTarget);
@@ -50,6 +79,14 @@ void FDiscordLatentAction::UpdateOperation(FLatentResponse& Response)
 
 void FDiscordLatentAction::FinishOperation(const bool bSuccess)
 {
+	if (bShouldFinish) return;
+
 	bShouldFinish = true;
-	Output = bSuccess ? EDiscordOutputPins::Success : EDiscordOutputPins::Failed;
+	bSucceeded = bSuccess;
+}
+
+void FDiscordLatentAction::SetOperation(const UDiscordSubsystem* InDiscordSubsystem, const FDiscordOperationHandle InOperation)
+{
+	DiscordSubsystem = InDiscordSubsystem;
+	Operation = InOperation;
 }
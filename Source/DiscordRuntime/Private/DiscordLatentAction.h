@@ -2,11 +2,13 @@
 
 #pragma once
 
-#include "DiscordSettings.h"
+#include "DiscordOperation.h"
 #include "Engine/LatentActionManager.h"
 #include "LatentActions.h"
 #include "DiscordLatentAction.generated.h"
 
+class UDiscordSubsystem;
+
 
 UENUM()
 enum class EDiscordOutputPins : uint8
@@ -16,40 +18,61 @@ enum class EDiscordOutputPins : uint8
 	Failed
 };
 
+/**
+ * Latent action backing the Blueprint versions of the functions with a `Callback` parameter. Actions are recycled
+ * through a pool, and the native call is issued as soon as the action is added, so nothing needs to be captured.
+ * Timeouts are handled by the subsystem's operation table, which fails the native callback. If the action is destroyed
+ * before its callback fires, for instance because its owner was, the operation is cancelled so the callback never
+ * touches the freed action.
+ */
 class FDiscordLatentAction final : public FPendingLatentAction
 {
 	const FLatentActionInfo LatentInfo;
 
 	EDiscordOutputPins& Output;
 
-	TFunction<void(FDiscordLatentAction*)> DiscordAction;
-
-	float ElapsedTime = 0;
-	
-	float Timeout;
-
-	bool bInitialized = false;
+	bool bTriggeredThen = false;
 	
 	bool bShouldFinish = false;
 
+	bool bSucceeded = false;
+
+	TWeakObjectPtr<const UDiscordSubsystem> DiscordSubsystem;
+
+	FDiscordOperationHandle Operation;
+
 public:
-	FDiscordLatentAction(const FLatentActionInfo& InLatentInfo, EDiscordOutputPins& InOutputPins, TFunction<void(FDiscordLatentAction*)> InDiscordAction)
-		: LatentInfo(InLatentInfo), Output(InOutputPins), DiscordAction(InDiscordAction)
+	FDiscordLatentAction(const FLatentActionInfo& InLatentInfo, EDiscordOutputPins& InOutputPins)
+		: LatentInfo(InLatentInfo), Output(InOutputPins)
 	{
-		Timeout = GetDefault<UDiscordSettings>()->TimeoutSeconds;
 		Output = EDiscordOutputPins::Then;
 	}
 
-	static void CreateAndAdd(const UObject* WorldContext, const FLatentActionInfo& LatentInfo, EDiscordOutputPins& OutputPins, TFunction<void(FDiscordLatentAction*)> DiscordAction);
+	virtual ~FDiscordLatentAction() override;
+
+	/**
+	 * Adds a new action to the world's latent action manager. Returns nullptr if the same action is still ongoing, in
+	 * which case the native call must not be issued.
+	 */
+	static FDiscordLatentAction* CreateAndAdd(const UObject* WorldContext, const FLatentActionInfo& LatentInfo, EDiscordOutputPins& OutputPins);
+
+	static void* operator new(size_t Size);
+
+	static void operator delete(void* Action);
 
 	virtual void UpdateOperation(FLatentResponse& Response) override;
 
 	void FinishOperation(const bool bSuccess);
 
+	/**
+	 * Ties the action to the operation it is waiting on, so that it can be cancelled if the action goes away first.
+	 */
+	void SetOperation(const UDiscordSubsystem* InDiscordSubsystem, const FDiscordOperationHandle InOperation);
+
 #if WITH_EDITOR
 	virtual FString GetDescription() const override
 	{
-		return FString::Printf(TEXT("Time spent: %.1fs | Timeout: %.1f"), ElapsedTime, Timeout);
+		return bShouldFinish ? TEXT("Finished") : TEXT("Waiting for Discord");
 	}
 #endif
 };
\ No newline at end of file
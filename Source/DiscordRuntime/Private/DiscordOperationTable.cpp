@@ -0,0 +1,133 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordOperationTable.h"
+
+#include "DiscordLogChannel.h"
+#include "Containers/AllocatorFixedSizeFreeList.h"
+
+
+/** Operations only live on the game thread, so a single-threaded free list is enough. */
+using FDiscordPendingOperationPool = TAllocatorFixedSizeFreeList<FDiscordPendingOperation::PooledSize, 32>;
+
+static FDiscordPendingOperationPool& GetPendingOperationPool()
+{
+	static FDiscordPendingOperationPool Pool;
+	return Pool;
+}
+
+void* FDiscordPendingOperation::operator new(size_t Size)
+{
+	check(IsInGameThread());
+	check(Size <= PooledSize);
+	return GetPendingOperationPool().Allocate();
+}
+
+void FDiscordPendingOperation::operator delete(void* Operation)
+{
+	check(IsInGameThread());
+	if (Operation) GetPendingOperationPool().Free(Operation);
+}
+
+
+SIZE_T FDiscordOperationTable::GetOperationPoolSize()
+{
+	return GetPendingOperationPool().GetAllocatedSize();
+}
+
+FDiscordOperationTable::FDiscordOperationTable(const double Now)
+	: TimeoutWheel(Now)
+{
+}
+
+FDiscordOperationHandle FDiscordOperationTable::Add(const double TimeoutSeconds, TUniquePtr<FDiscordPendingOperation>&& Operation)
+{
+	check(IsInGameThread());
+	check(Operation);
+
+	const int32 Index = FreeIndices.Num() > 0 ? FreeIndices.Pop(EAllowShrinking::No) : Slots.AddDefaulted();
+	NumOperations++;
+
+	FSlot& Slot = Slots[Index];
+	Slot.Operation = MoveTemp(Operation);
+
+	const FDiscordOperationHandle Handle{Index, Slot.Generation};
+	Slot.Timeout = TimeoutWheel.Add(TimeoutSeconds, PackHandle(Handle));
+
+	return Handle;
+}
+
+TUniquePtr<FDiscordPendingOperation> FDiscordOperationTable::Remove(const FDiscordOperationHandle Handle)
+{
+	check(IsInGameThread());
+
+	FSlot* Slot = FindSlot(Handle);
+	if (!Slot) return nullptr;
+
+	if (Slot->Timeout.IsValid())
+	{
+		TimeoutWheel.Remove(Slot->Timeout);
+	}
+
+	return Release(Handle.Index);
+}
+
+bool FDiscordOperationTable::RestartTimeout(const FDiscordOperationHandle Handle, const double TimeoutSeconds)
+{
+	check(IsInGameThread());
+
+	FSlot* Slot = FindSlot(Handle);
+	if (!Slot) return false;
+
+	if (Slot->Timeout.IsValid())
+	{
+		TimeoutWheel.Remove(Slot->Timeout);
+	}
+
+	Slot->Timeout = TimeoutWheel.Add(TimeoutSeconds, PackHandle(Handle));
+	return true;
+}
+
+void FDiscordOperationTable::Advance(const double Now)
+{
+	TimeoutWheel.Advance(Now, [this](const uint64 Payload)
+	{
+		// The wheel already released this timeout, so removing it from there again is a no-op
+		if (TUniquePtr<FDiscordPendingOperation> TimedOutOperation = Remove(UnpackHandle(Payload)))
+		{
+			LOG_DISCORD(Warning, "Discord request timed out");
+			TimedOutOperation->TimeOut();
+		}
+	});
+}
+
+FDiscordOperationTable::FSlot* FDiscordOperationTable::FindSlot(const FDiscordOperationHandle Handle)
+{
+	if (!Slots.IsValidIndex(Handle.Index)) return nullptr;
+
+	FSlot& Slot = Slots[Handle.Index];
+	return Slot.Generation == Handle.Generation && Slot.Operation ? &Slot : nullptr;
+}
+
+uint64 FDiscordOperationTable::PackHandle(const FDiscordOperationHandle Handle)
+{
+	return static_cast<uint64>(Handle.Generation) << 32 | static_cast<uint32>(Handle.Index);
+}
+
+FDiscordOperationHandle FDiscordOperationTable::UnpackHandle(const uint64 Payload)
+{
+	return FDiscordOperationHandle{static_cast<int32>(Payload & MAX_uint32), static_cast<uint32>(Payload >> 32)};
+}
+
+TUniquePtr<FDiscordPendingOperation> FDiscordOperationTable::Release(const int32 Index)
+{
+	FSlot& Slot = Slots[Index];
+	TUniquePtr<FDiscordPendingOperation> Operation = MoveTemp(Slot.Operation);
+	Slot.Timeout = FDiscordTimeoutHandle();
+
+	// Zero is kept for handles that were never valid
+	Slot.Generation = Slot.Generation == MAX_uint32 ? 1 : Slot.Generation + 1;
+
+	FreeIndices.Push(Index);
+	NumOperations--;
+	return Operation;
+}
@@ -0,0 +1,76 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordOperation.h"
+#include "DiscordTimeoutWheel.h"
+
+
+/**
+ * Generation-counted table of the pending requests. The SDK callbacks only hold a handle into it, so a late answer to
+ * a request that timed out or was cancelled is dropped in O(1) without touching whatever its callback captured. Must
+ * only be used on the game thread.
+ */
+class FDiscordOperationTable final
+{
+public:
+	explicit FDiscordOperationTable(const double Now);
+
+	/**
+	 * Starts tracking a request. A timeout of zero or less never expires.
+	 */
+	FDiscordOperationHandle Add(const double TimeoutSeconds, TUniquePtr<FDiscordPendingOperation>&& Operation);
+
+	/**
+	 * Stops tracking a request and hands it back. Returns nullptr if the handle is stale.
+	 */
+	TUniquePtr<FDiscordPendingOperation> Remove(const FDiscordOperationHandle Handle);
+
+	/**
+	 * Starts the timeout of a request over, with a new duration. Returns false if the handle is stale.
+	 */
+	bool RestartTimeout(const FDiscordOperationHandle Handle, const double TimeoutSeconds);
+
+	/**
+	 * Moves the timeouts forward, timing out the requests that expired in the meantime.
+	 */
+	void Advance(const double Now);
+
+	/**
+	 * Returns how many requests are pending.
+	 */
+	int32 Num() const { return NumOperations; }
+
+	/**
+	 * Returns how much heap memory the table holds, not counting the operations themselves.
+	 */
+	SIZE_T GetAllocatedSize() const { return Slots.GetAllocatedSize() + FreeIndices.GetAllocatedSize() + TimeoutWheel.GetAllocatedSize(); }
+
+	/**
+	 * Returns how much heap memory the pool the operations come from holds.
+	 */
+	static SIZE_T GetOperationPoolSize();
+
+private:
+	struct FSlot
+	{
+		TUniquePtr<FDiscordPendingOperation> Operation;
+		FDiscordTimeoutHandle Timeout;
+		uint32 Generation = 1;
+	};
+
+	FSlot* FindSlot(const FDiscordOperationHandle Handle);
+
+	static uint64 PackHandle(const FDiscordOperationHandle Handle);
+	static FDiscordOperationHandle UnpackHandle(const uint64 Payload);
+
+	TUniquePtr<FDiscordPendingOperation> Release(const int32 Index);
+
+	FDiscordTimeoutWheel TimeoutWheel;
+
+	TArray<FSlot> Slots;
+
+	TArray<int32> FreeIndices;
+
+	int32 NumOperations = 0;
+};
@@ -0,0 +1,34 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordPumpScheduler.h"
+
+#include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+
+
+FDiscordPumpScheduler::FDiscordPumpScheduler(const UDiscordSettings* Settings, const double InBoostedInterval)
+	: BoostedInterval(InBoostedInterval)
+{
+	ActiveInterval = Settings->MaxPumpRate > 0.f ? FMath::Max(1.0 / Settings->MaxPumpRate, BoostedInterval) : BoostedInterval;
+	IdleInterval = Settings->IdlePumpRate > 0.f ? FMath::Max(1.0 / Settings->IdlePumpRate, ActiveInterval) : ActiveInterval;
+	IdleDelay = Settings->IdleDelaySeconds;
+}
+
+double FDiscordPumpScheduler::GetPumpInterval(const double Now) const
+{
+	if (NumPendingRequests > 0) return BoostedInterval;
+
+	return Now - LastDispatchTime < IdleDelay ? ActiveInterval : IdleInterval;
+}
+
+void FDiscordPumpScheduler::OnPumped(const double Now)
+{
+	LastPumpTime = Now;
+	LastPumpDispatchCount = NumDispatchedThisPump.exchange(0);
+
+	if (LastPumpDispatchCount > 0)
+	{
+		LastDispatchTime = Now;
+		LOG_DISCORD(VeryVerbose, "Dispatched {Count} callbacks, {Pending} requests pending", LastPumpDispatchCount.load(), NumPendingRequests.load());
+	}
+}
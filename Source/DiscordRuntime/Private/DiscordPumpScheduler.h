@@ -0,0 +1,70 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+class UDiscordSettings;
+
+
+/**
+ * Decides when the SDK callbacks should be pumped. Pumps at a capped rate, boosts to the shortest interval while
+ * requests are outstanding, and backs off once nothing has been dispatched for a while.
+ */
+class FDiscordPumpScheduler final
+{
+public:
+	/**
+	 * BoostedInterval is the interval used while requests are outstanding. Zero means every tick.
+	 */
+	FDiscordPumpScheduler(const UDiscordSettings* Settings, const double InBoostedInterval);
+
+	/**
+	 * Returns the time to wait between the last pump and the next one.
+	 */
+	double GetPumpInterval(const double Now) const;
+
+	/**
+	 * Returns whether enough time passed since the last pump.
+	 */
+	bool ShouldPump(const double Now) const { return Now - LastPumpTime >= GetPumpInterval(Now); }
+
+	/**
+	 * Must be called after each pump, on the thread that pumps.
+	 */
+	void OnPumped(const double Now);
+
+	/**
+	 * Updates how many requests are waiting on their callback. Can be called from any thread.
+	 */
+	void SetNumPendingRequests(const int32 InNumPendingRequests) { NumPendingRequests = InNumPendingRequests; }
+
+	/**
+	 * Counts a result or event handed over during the current pump. Can be called from any thread.
+	 */
+	void OnCallbackDispatched() { ++NumDispatchedThisPump; }
+
+	int32 GetNumPendingRequests() const { return NumPendingRequests; }
+
+	int32 GetLastPumpDispatchCount() const { return LastPumpDispatchCount; }
+
+private:
+	double BoostedInterval;
+
+	double ActiveInterval;
+
+	double IdleInterval;
+
+	double IdleDelay;
+
+	double LastPumpTime = 0.0;
+
+	double LastDispatchTime = 0.0;
+
+	std::atomic<int32> LastPumpDispatchCount = 0;
+
+	std::atomic<int32> NumPendingRequests = 0;
+
+	std::atomic<int32> NumDispatchedThisPump = 0;
+};
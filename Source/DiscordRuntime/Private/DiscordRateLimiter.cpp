@@ -0,0 +1,28 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordRateLimiter.h"
+
+
+FDiscordRateLimiter::FDiscordRateLimiter(const int32 MaxCalls, const double InWindowSeconds)
+	: WindowSeconds(InWindowSeconds)
+{
+	CallTimes.SetNumZeroed(FMath::Max(MaxCalls, 1));
+}
+
+bool FDiscordRateLimiter::TryAcquire(const double Now)
+{
+	if (GetTimeUntilAvailable(Now) > 0.0) return false;
+
+	// Once full, this overwrites the oldest call, which just left the window
+	CallTimes[NextIndex] = Now;
+	NextIndex = (NextIndex + 1) % CallTimes.Num();
+	NumCalls = FMath::Min(NumCalls + 1, CallTimes.Num());
+	return true;
+}
+
+double FDiscordRateLimiter::GetTimeUntilAvailable(const double Now) const
+{
+	if (NumCalls < CallTimes.Num()) return 0.0;
+
+	return FMath::Max(0.0, CallTimes[NextIndex] + WindowSeconds - Now);
+}
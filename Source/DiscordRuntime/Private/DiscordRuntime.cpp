@@ -2,7 +2,10 @@
 
 #include "DiscordRuntime.h"
 
+#include "DiscordLogChannel.h"
 #include "HAL/PlatformProcess.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
 #include "Misc/Paths.h"
 #include "Modules/ModuleManager.h"
 
@@ -14,6 +17,15 @@ FDiscordRuntimeModule& FDiscordRuntimeModule::Get()
 
 void FDiscordRuntimeModule::StartupModule()
 {
+#if WITH_DISCORD_MOCK_SDK
+	if (FParse::Param(FCommandLine::Get(), TEXT("DiscordMockSdk")))
+	{
+		LOG_DISCORD(Display, "Using the mock Discord Game SDK");
+		bUseMockSdk = true;
+		return;
+	}
+#endif
+
 	FString PathToDll = FPaths::ProjectPluginsDir() / TEXT("Discord/Binaries/ThirdParty/DiscordGameSdk") / FPlatformProcess::GetBinariesSubdirectory();
 	const FString DllName = FString::Printf(TEXT("discord_game_sdk.%s"), FPlatformProcess::GetModuleExtension());
 
@@ -39,7 +51,7 @@ void FDiscordRuntimeModule::ShutdownModule()
 
 bool FDiscordRuntimeModule::IsSdkAvailable() const
 {
-	return DiscordGameSdkDllHandle != nullptr;
+	return DiscordGameSdkDllHandle != nullptr || bUseMockSdk;
 }
 	
 IMPLEMENT_MODULE(FDiscordRuntimeModule, DiscordRuntime)
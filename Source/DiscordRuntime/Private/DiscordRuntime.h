@@ -9,10 +9,24 @@ class FDiscordRuntimeModule final : public IModuleInterface
 {
 private:
 	void* DiscordGameSdkDllHandle = nullptr;
+
+	bool bUseMockSdk = false;
 	
 public:
 	static FDiscordRuntimeModule& Get();
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 	bool IsSdkAvailable() const;
+
+	/**
+	 * Whether the mock SDK is used instead of the real one. Selected by launching with `-DiscordMockSdk`.
+	 */
+	bool IsUsingMockSdk() const { return bUseMockSdk; }
+
+#if WITH_DISCORD_MOCK_SDK
+	/**
+	 * Selects the mock SDK for the subsystems initialized from now on, e.g. by the automation tests.
+	 */
+	void SetUsingMockSdk(const bool bInUseMockSdk) { bUseMockSdk = bInUseMockSdk; }
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,51 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordStats.h"
+
+#include "ProfilingDebugging/CountersTrace.h"
+#include <atomic>
+
+DEFINE_STAT(STAT_DiscordCalls);
+DEFINE_STAT(STAT_DiscordCallsPerSecond);
+DEFINE_STAT(STAT_DiscordDispatchedCallbacks);
+DEFINE_STAT(STAT_DiscordPendingRequests);
+
+UE_TRACE_CHANNEL_DEFINE(DiscordChannel);
+
+TRACE_DECLARE_INT_COUNTER(DiscordCallsPerSecond, TEXT("Discord/CallsPerSecond"));
+TRACE_DECLARE_INT_COUNTER(DiscordPendingRequests, TEXT("Discord/PendingRequests"));
+
+
+namespace DiscordStats
+{
+	static std::atomic<int32> NumCallsThisSecond = 0;
+
+	/** Negative until the first update, which starts the first window. */
+	static double SecondStartTime = -1.0;
+
+	void CountCall()
+	{
+		INC_DWORD_STAT(STAT_DiscordCalls);
+		++NumCallsThisSecond;
+	}
+
+	void Update(const double Now, const int32 NumPendingRequests)
+	{
+		SET_DWORD_STAT(STAT_DiscordPendingRequests, NumPendingRequests);
+		TRACE_COUNTER_SET(DiscordPendingRequests, NumPendingRequests);
+
+		if (SecondStartTime < 0.0)
+		{
+			SecondStartTime = Now;
+			return;
+		}
+
+		if (Now - SecondStartTime < 1.0) return;
+
+		const int32 CallsPerSecond = FMath::RoundToInt32(NumCallsThisSecond.exchange(0) / (Now - SecondStartTime));
+		SecondStartTime = Now;
+
+		SET_DWORD_STAT(STAT_DiscordCallsPerSecond, CallsPerSecond);
+		TRACE_COUNTER_SET(DiscordCallsPerSecond, CallsPerSecond);
+	}
+}
@@ -0,0 +1,43 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+DECLARE_STATS_GROUP(TEXT("Discord"), STATGROUP_Discord, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Calls"), STAT_DiscordCalls, STATGROUP_Discord, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Calls Per Second"), STAT_DiscordCallsPerSecond, STATGROUP_Discord, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dispatched Callbacks"), STAT_DiscordDispatchedCallbacks, STATGROUP_Discord, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Requests"), STAT_DiscordPendingRequests, STATGROUP_Discord, );
+
+UE_TRACE_CHANNEL_EXTERN(DiscordChannel);
+
+/**
+ * Times the enclosing scope in STATGROUP_Discord and in Unreal Insights under the Discord trace channel.
+ */
+#define DISCORD_SCOPE_CYCLE_COUNTER(Name) \
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT(#Name), STAT_Discord_##Name, STATGROUP_Discord); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Discord_##Name, DiscordChannel)
+
+/**
+ * Same as DISCORD_SCOPE_CYCLE_COUNTER, but also counts the scope as a call into the plugin.
+ */
+#define DISCORD_SCOPE_CALL(Name) \
+	DISCORD_SCOPE_CYCLE_COUNTER(Name); \
+	DiscordStats::CountCall()
+
+namespace DiscordStats
+{
+	/**
+	 * Counts a call into the plugin. Can be called from any thread.
+	 */
+	void CountCall();
+
+	/**
+	 * Publishes the per-second and outstanding counters. Must be called once per frame on the game thread.
+	 */
+	void Update(const double Now, const int32 NumPendingRequests);
+}
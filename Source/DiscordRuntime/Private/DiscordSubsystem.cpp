@@ -2,13 +2,26 @@
 
 #include "DiscordSubsystem.h"
 
+#include "DiscordCallbackPump.h"
 #include "DiscordLogChannel.h"
+#include "DiscordPumpScheduler.h"
 #include "DiscordRuntime.h"
 #include "DiscordSettings.h"
+#include "DiscordStats.h"
+#include "DiscordOperationTable.h"
+#include "Mock/DiscordMockSdk.h"
 #include "Discord/core.h"
+#include "Achievements/DiscordAchievementManager.h"
 #include "Activities/DiscordActivityManager.h"
+#include "Images/DiscordImageManager.h"
 #include "Overlay/DiscordOverlayManager.h"
+#include "Relationships/DiscordRelationshipManager.h"
+#include "Lobbies/DiscordLobbyManager.h"
+#include "Networking/DiscordNetworkManager.h"
+#include "Storage/DiscordStorageManager.h"
+#include "Store/DiscordStoreManager.h"
 #include "Users/DiscordUserManager.h"
+#include "Voice/DiscordVoiceManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordSubsystem)
 
@@ -43,6 +56,14 @@ void UDiscordSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	ActivityManager = NewObject<UDiscordActivityManager>(this);
 	UserManager = NewObject<UDiscordUserManager>(this);
 	OverlayManager = NewObject<UDiscordOverlayManager>(this);
+	RelationshipManager = NewObject<UDiscordRelationshipManager>(this);
+	LobbyManager = NewObject<UDiscordLobbyManager>(this);
+	NetworkManager = NewObject<UDiscordNetworkManager>(this);
+	StorageManager = NewObject<UDiscordStorageManager>(this);
+	ImageManager = NewObject<UDiscordImageManager>(this);
+	AchievementManager = NewObject<UDiscordAchievementManager>(this);
+	StoreManager = NewObject<UDiscordStoreManager>(this);
+	VoiceManager = NewObject<UDiscordVoiceManager>(this);
 
 	if (DiscordSettings->ClientID <= 0)
 	{
@@ -56,8 +77,14 @@ void UDiscordSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 		return;
 	}
 
+#if WITH_DISCORD_MOCK_SDK
+	const discord::Core::CreateFunction CreateFunction = FDiscordRuntimeModule::Get().IsUsingMockSdk() ? &FDiscordMockSdk::Create : &DiscordCreate;
+#else
+	const discord::Core::CreateFunction CreateFunction = &DiscordCreate;
+#endif
+
 #if PLATFORM_DESKTOP && !WITH_EDITOR
-	const auto CreateResult = discord::Core::Create(DiscordSettings->ClientID, DiscordSettings->bRequireDiscord ? DiscordCreateFlags_Default : DiscordCreateFlags_NoRequireDiscord, &Core);
+	const auto CreateResult = discord::Core::Create(DiscordSettings->ClientID, DiscordSettings->bRequireDiscord ? DiscordCreateFlags_Default : DiscordCreateFlags_NoRequireDiscord, &Core, CreateFunction);
 #else
 #if WITH_EDITOR
 	if (DiscordSettings->bRequireDiscord)
@@ -65,7 +92,7 @@ void UDiscordSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 		LOG_DISCORD(Warning, "Discord is required, but we can't force-relaunch the editor. Please make sure Discord is open!");
 	}
 #endif
-	const auto CreateResult = discord::Core::Create(DiscordSettings->ClientID, DiscordCreateFlags_NoRequireDiscord, &Core);
+	const auto CreateResult = discord::Core::Create(DiscordSettings->ClientID, DiscordCreateFlags_NoRequireDiscord, &Core, CreateFunction);
 #endif
 
 	if (CreateResult != discord::Result::Ok)
@@ -80,6 +107,31 @@ void UDiscordSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	ActivityManager->Initialize(&Core->ActivityManager());
 	UserManager->Initialize(&Core->UserManager());
 	OverlayManager->Initialize(&Core->OverlayManager());
+	RelationshipManager->Initialize(&Core->RelationshipManager());
+	LobbyManager->Initialize(&Core->LobbyManager());
+	NetworkManager->Initialize(&Core->NetworkManager());
+	StorageManager->Initialize(&Core->StorageManager());
+	ImageManager->Initialize(&Core->ImageManager());
+	AchievementManager->Initialize(&Core->AchievementManager());
+	StoreManager->Initialize(&Core->StoreManager());
+	VoiceManager->Initialize(&Core->VoiceManager());
+
+	if (DiscordSettings->bRunCallbacksOnWorkerThread && FPlatformProcess::SupportsMultithreading())
+	{
+		PumpScheduler = new FDiscordPumpScheduler(DiscordSettings, DiscordSettings->WorkerPumpIntervalMs / 1000.0);
+		CallbackPump = new FDiscordCallbackPump(Core, PumpScheduler);
+	}
+	else
+	{
+		if (DiscordSettings->bRunCallbacksOnWorkerThread)
+		{
+			LOG_DISCORD(Warning, "Multithreading isn't supported on this platform. Callbacks will be pumped on the game thread");
+		}
+
+		PumpScheduler = new FDiscordPumpScheduler(DiscordSettings, 0.0);
+	}
+
+	OperationTable = new FDiscordOperationTable(FPlatformTime::Seconds());
 	
 	LOG_DISCORD(Log, "Initialized Core");
 
@@ -90,7 +142,45 @@ void UDiscordSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 
 void UDiscordSubsystem::Tick(const float DeltaTime)
 {
-	if (IsActive()) Core->RunCallbacks();
+	if (!IsActive()) return;
+
+	DISCORD_SCOPE_CYCLE_COUNTER(Tick);
+
+	OperationTable->Advance(FPlatformTime::Seconds());
+	PumpScheduler->SetNumPendingRequests(OperationTable->Num());
+
+	DiscordStats::Update(FPlatformTime::Seconds(), PumpScheduler->GetNumPendingRequests());
+
+	ActivityManager->FlushPendingActivity(FPlatformTime::Seconds());
+	LobbyManager->FlushPendingWrites(FPlatformTime::Seconds());
+	AchievementManager->FlushPendingProgress(FPlatformTime::Seconds());
+
+	if (CallbackPump)
+	{
+		CallbackPump->DrainGameThreadTasks(GetDefault<UDiscordSettings>()->GameThreadDispatchBudgetMs / 1000.0);
+	}
+	else
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (PumpScheduler->ShouldPump(Now))
+		{
+			DISCORD_SCOPE_CYCLE_COUNTER(RunCallbacks);
+			Core->RunCallbacks();
+			PumpScheduler->OnPumped(Now);
+		}
+	}
+
+	RelationshipManager->FlushNotifications();
+	ImageManager->FlushPendingUploads();
+	VoiceManager->FlushPendingChanges(FPlatformTime::Seconds());
+
+	// Last, so that the messages queued by this frame's events go out with the rest
+	LobbyManager->FlushNetworkMessages();
+}
+
+TStatId UDiscordSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDiscordSubsystem, STATGROUP_Discord);
 }
 
 UWorld* UDiscordSubsystem::GetTickableGameObjectWorld() const
@@ -123,12 +213,111 @@ bool UDiscordSubsystem::IsActive() const
 	return Core != nullptr;
 }
 
+int32 UDiscordSubsystem::GetLastPumpCallbackCount() const
+{
+	return PumpScheduler ? PumpScheduler->GetLastPumpDispatchCount() : 0;
+}
+
+int32 UDiscordSubsystem::GetPendingRequestCount() const
+{
+	return PumpScheduler ? PumpScheduler->GetNumPendingRequests() : 0;
+}
+
+FDiscordOperationHandle UDiscordSubsystem::BeginOperation(const float TimeoutSeconds, TUniquePtr<FDiscordPendingOperation>&& Operation) const
+{
+	check(OperationTable);
+
+	const float Timeout = TimeoutSeconds < 0.f ? GetDefault<UDiscordSettings>()->TimeoutSeconds : TimeoutSeconds;
+	const FDiscordOperationHandle Handle = OperationTable->Add(Timeout, MoveTemp(Operation));
+
+	PumpScheduler->SetNumPendingRequests(OperationTable->Num());
+	return Handle;
+}
+
+TUniquePtr<FDiscordPendingOperation> UDiscordSubsystem::EndOperation(const FDiscordOperationHandle Handle) const
+{
+	if (!OperationTable) return nullptr;
+
+	TUniquePtr<FDiscordPendingOperation> Operation = OperationTable->Remove(Handle);
+	if (!Operation)
+	{
+		LOG_DISCORD(Verbose, "Dropped the answer to a Discord request that timed out or was cancelled");
+		return nullptr;
+	}
+
+	PumpScheduler->SetNumPendingRequests(OperationTable->Num());
+	return Operation;
+}
+
+bool UDiscordSubsystem::CancelOperation(const FDiscordOperationHandle Handle) const
+{
+	if (!OperationTable) return false;
+
+	const bool bCancelled = OperationTable->Remove(Handle).IsValid();
+	PumpScheduler->SetNumPendingRequests(OperationTable->Num());
+	return bCancelled;
+}
+
+bool UDiscordSubsystem::RestartOperationTimeout(const FDiscordOperationHandle Handle, const float TimeoutSeconds) const
+{
+	if (!OperationTable) return false;
+
+	const float Timeout = TimeoutSeconds < 0.f ? GetDefault<UDiscordSettings>()->TimeoutSeconds : TimeoutSeconds;
+	return OperationTable->RestartTimeout(Handle, Timeout);
+}
+
+// Every result and event coming out of the SDK is handed over through one of these two
+void UDiscordSubsystem::QueueGameThreadTask(TUniqueFunction<void()>&& Task) const
+{
+	if (PumpScheduler) PumpScheduler->OnCallbackDispatched();
+	CallbackPump->EnqueueGameThreadTask(MoveTemp(Task));
+}
+
+void UDiscordSubsystem::DispatchGameThreadTask(TFunctionRef<void()> Task) const
+{
+	if (PumpScheduler) PumpScheduler->OnCallbackDispatched();
+
+	DISCORD_SCOPE_CYCLE_COUNTER(DispatchCallback);
+	INC_DWORD_STAT(STAT_DiscordDispatchedCallbacks);
+	Task();
+}
+
+void UDiscordSubsystem::QueueSdkCommand(TUniqueFunction<void()>&& Command) const
+{
+	CallbackPump->EnqueueSdkCommand(MoveTemp(Command));
+}
+
+FCriticalSection* UDiscordSubsystem::GetSdkLock() const
+{
+	return CallbackPump ? &CallbackPump->GetSdkLock() : nullptr;
+}
+
 void UDiscordSubsystem::Deinitialize()
 {
 #if DISCORD_UE_VERSION >= 505
 	SetTickableTickType(ETickableTickType::Never);
 #endif
 
+	if (CallbackPump)
+	{
+		// Stops the worker thread and drops any command or result that was still queued
+		delete CallbackPump;
+		CallbackPump = nullptr;
+	}
+
+	if (OperationTable)
+	{
+		// Pending requests are dropped without firing their callbacks, since their owners may be going away too
+		delete OperationTable;
+		OperationTable = nullptr;
+	}
+
+	if (PumpScheduler)
+	{
+		delete PumpScheduler;
+		PumpScheduler = nullptr;
+	}
+
 	if (IsActive())
 	{
 		delete Core;
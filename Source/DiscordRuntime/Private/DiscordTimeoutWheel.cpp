@@ -0,0 +1,156 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordTimeoutWheel.h"
+
+
+FDiscordTimeoutWheel::FDiscordTimeoutWheel(const double Now)
+	: StartTime(Now)
+{
+	for (int32& Head : Heads)
+	{
+		Head = INDEX_NONE;
+	}
+}
+
+FDiscordTimeoutHandle FDiscordTimeoutWheel::Add(const double TimeoutSeconds, const uint64 Payload)
+{
+	check(IsInGameThread());
+
+	const int32 Index = FreeIndices.Num() > 0 ? FreeIndices.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+	NumEntries++;
+
+	FEntry& Entry = Entries[Index];
+	Entry.Payload = Payload;
+	Entry.bLive = true;
+
+	if (TimeoutSeconds > 0.0)
+	{
+		// The current tick may lag behind by up to one tick, which is accounted for so that nothing expires early
+		Entry.ExpiryTick = CurrentTick + 1 + FMath::CeilToInt64(TimeoutSeconds / TickSeconds);
+		Link(Index);
+	}
+
+	return FDiscordTimeoutHandle{Index, Entry.Serial};
+}
+
+bool FDiscordTimeoutWheel::Remove(const FDiscordTimeoutHandle Handle)
+{
+	check(IsInGameThread());
+
+	if (!Entries.IsValidIndex(Handle.Index)) return false;
+
+	const FEntry& Entry = Entries[Handle.Index];
+	if (!Entry.bLive || Entry.Serial != Handle.Serial) return false;
+
+	Unlink(Handle.Index);
+	Release(Handle.Index);
+	return true;
+}
+
+void FDiscordTimeoutWheel::Advance(const double Now, TFunctionRef<void(uint64 Payload)> OnExpired)
+{
+	check(IsInGameThread());
+
+	const uint64 TargetTick = static_cast<uint64>((Now - StartTime) / TickSeconds);
+
+	while (CurrentTick < TargetTick)
+	{
+		CurrentTick++;
+
+		if ((CurrentTick & SlotMask) == 0)
+		{
+			Cascade();
+		}
+
+		ExpireSlot(static_cast<int32>(CurrentTick & SlotMask), OnExpired);
+	}
+}
+
+void FDiscordTimeoutWheel::Link(const int32 Index)
+{
+	FEntry& Entry = Entries[Index];
+
+	const uint64 Delta = Entry.ExpiryTick > CurrentTick ? Entry.ExpiryTick - CurrentTick : 0;
+	if (Delta < NumSlots)
+	{
+		Entry.Slot = static_cast<int32>(Entry.ExpiryTick & SlotMask);
+	}
+	else
+	{
+		// Anything further than the second level can cover is parked in its last slot and re-linked on each cascade
+		const uint64 UpperTick = FMath::Min<uint64>(Entry.ExpiryTick >> SlotBits, (CurrentTick >> SlotBits) + SlotMask);
+		Entry.Slot = NumSlots + static_cast<int32>(UpperTick & SlotMask);
+	}
+
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = Heads[Entry.Slot];
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Index;
+	}
+	Heads[Entry.Slot] = Index;
+}
+
+void FDiscordTimeoutWheel::Unlink(const int32 Index)
+{
+	FEntry& Entry = Entries[Index];
+	if (Entry.Slot == NoSlot) return;
+
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = Entry.Next;
+	}
+	else
+	{
+		Heads[Entry.Slot] = Entry.Next;
+	}
+
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Entry.Prev;
+	}
+
+	Entry.Slot = NoSlot;
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
+
+void FDiscordTimeoutWheel::Release(const int32 Index)
+{
+	FEntry& Entry = Entries[Index];
+	Entry.bLive = false;
+	Entry.Serial++;
+
+	FreeIndices.Push(Index);
+	NumEntries--;
+}
+
+void FDiscordTimeoutWheel::Cascade()
+{
+	const int32 Slot = NumSlots + static_cast<int32>((CurrentTick >> SlotBits) & SlotMask);
+
+	// Re-linking never puts an entry back in the slot being emptied, since it now covers ticks that are behind us
+	while (Heads[Slot] != INDEX_NONE)
+	{
+		const int32 Index = Heads[Slot];
+		Unlink(Index);
+		Link(Index);
+	}
+}
+
+void FDiscordTimeoutWheel::ExpireSlot(const int32 Slot, TFunctionRef<void(uint64 Payload)> OnExpired)
+{
+	// Everything in a first level slot expires on the tick that reaches it. Expiring may add or remove timeouts, but
+	// never in this slot, since new ones can't expire before the next tick
+	while (Heads[Slot] != INDEX_NONE)
+	{
+		const int32 Index = Heads[Slot];
+		check(Entries[Index].ExpiryTick <= CurrentTick);
+
+		Unlink(Index);
+		const uint64 Payload = Entries[Index].Payload;
+		Release(Index);
+
+		OnExpired(Payload);
+	}
+}
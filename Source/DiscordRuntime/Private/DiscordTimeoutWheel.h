@@ -0,0 +1,91 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+struct FDiscordTimeoutHandle
+{
+	int32 Index = INDEX_NONE;
+
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+};
+
+
+/**
+ * Two-level hierarchical timing wheel tracking every in-flight SDK request. Adding, removing and expiring a timeout
+ * are all O(1), no matter how many requests are pending. Must only be used on the game thread.
+ */
+class FDiscordTimeoutWheel final
+{
+public:
+	/** Resolution of the wheel. Timeouts are rounded up to the next tick. */
+	static constexpr double TickSeconds = 1.0 / 16.0;
+
+	explicit FDiscordTimeoutWheel(const double Now);
+
+	/**
+	 * Starts tracking a request, identified by Payload. It's handed to Advance's callback unless the request is removed
+	 * before TimeoutSeconds elapsed. A timeout of zero or less is never expired, but can still be removed.
+	 */
+	FDiscordTimeoutHandle Add(const double TimeoutSeconds, const uint64 Payload);
+
+	/**
+	 * Stops tracking a request. Returns false if it already expired or was removed, in which case nothing happens.
+	 */
+	bool Remove(const FDiscordTimeoutHandle Handle);
+
+	/**
+	 * Moves the wheel forward and calls OnExpired with the payload of each timeout that expired in the meantime.
+	 */
+	void Advance(const double Now, TFunctionRef<void(uint64 Payload)> OnExpired);
+
+	/**
+	 * Returns how many requests are being tracked.
+	 */
+	int32 Num() const { return NumEntries; }
+
+	/**
+	 * Returns how much heap memory the wheel holds, which stops growing once it tracked as many requests as it will.
+	 */
+	SIZE_T GetAllocatedSize() const { return Entries.GetAllocatedSize() + FreeIndices.GetAllocatedSize(); }
+
+private:
+	static constexpr int32 SlotBits = 6;
+	static constexpr int32 NumSlots = 1 << SlotBits;
+	static constexpr int32 SlotMask = NumSlots - 1;
+	static constexpr int32 NoSlot = INDEX_NONE;
+
+	struct FEntry
+	{
+		uint64 Payload = 0;
+		uint64 ExpiryTick = 0;
+		uint32 Serial = 0;
+		int32 Slot = NoSlot;
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+		bool bLive = false;
+	};
+
+	void Link(const int32 Index);
+	void Unlink(const int32 Index);
+	void Release(const int32 Index);
+	void Cascade();
+	void ExpireSlot(const int32 Slot, TFunctionRef<void(uint64 Payload)> OnExpired);
+
+	/** Slot list heads. The first NumSlots cover one tick each, the next NumSlots cover NumSlots ticks each. */
+	int32 Heads[NumSlots * 2];
+
+	TArray<FEntry> Entries;
+
+	TArray<int32> FreeIndices;
+
+	double StartTime;
+
+	uint64 CurrentTick = 0;
+
+	int32 NumEntries = 0;
+};
@@ -20,6 +20,36 @@ namespace discord
 	class UserManager;
 	class User;
 
+	// Relationships
+	class RelationshipManager;
+	class Relationship;
+
+	// Lobbies
+	class LobbyManager;
+	class Lobby;
+
+	// Networking
+	class NetworkManager;
+
 	// Overlay
 	class OverlayManager;
+
+	// Storage
+	class StorageManager;
+
+	// Images
+	class ImageManager;
+
+	// Voice
+	class VoiceManager;
+	class InputMode;
+
+	// Store
+	class StoreManager;
+	class Sku;
+	class Entitlement;
+
+	// Achievements
+	class AchievementManager;
+	class UserAchievement;
 }
\ No newline at end of file
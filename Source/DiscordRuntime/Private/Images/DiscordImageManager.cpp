@@ -0,0 +1,346 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Images/DiscordImageManager.h"
+
+#include "DiscordCallbackPump.h"
+#include "DiscordLatentAction.h"
+#include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Async/Async.h"
+#include "Discord/image_manager.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "TextureResource.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordImageManager)
+
+
+/** Width and height, followed by the pixels. */
+static constexpr int64 DiskCacheHeaderSize = 2 * sizeof(uint32);
+
+static constexpr int32 BytesPerPixel = 4;
+
+static uint32 ToAvatarSize(const int32 Size)
+{
+	return FMath::RoundUpToPowerOfTwo(FMath::Clamp(Size, 16, 256));
+}
+
+static discord::ImageHandle ToImageHandle(const FDiscordAvatarKey& Key)
+{
+	discord::ImageHandle Handle{};
+	Handle.SetType(discord::ImageType::User);
+	Handle.SetId(Key.UserID);
+	Handle.SetSize(Key.Size);
+	return Handle;
+}
+
+/**
+ * Resizes the first mip of a texture and locks it for writing.
+ */
+static uint8* LockMip(UTexture2D* Texture, const int64 NumBytes)
+{
+	FByteBulkData& BulkData = Texture->GetPlatformData()->Mips[0].BulkData;
+	BulkData.Lock(LOCK_READ_WRITE);
+	return static_cast<uint8*>(BulkData.Realloc(NumBytes));
+}
+
+static void UnlockMip(UTexture2D* Texture)
+{
+	Texture->GetPlatformData()->Mips[0].BulkData.Unlock();
+}
+
+
+UDiscordImageManager::UDiscordImageManager()
+{
+	const auto Outer = GetOuter();
+	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
+	{
+		DiscordSubsystem = Cast<UDiscordSubsystem>(GetOuter());
+	}
+}
+
+void UDiscordImageManager::Initialize(discord::ImageManager* ImageManager)
+{
+	Internal_ImageManager = ImageManager;
+
+	Avatars.Empty(FMath::Max(GetDefault<UDiscordSettings>()->AvatarCacheSize, 1));
+	DiskCacheDirectory = FPaths::ProjectSavedDir() / TEXT("Discord") / TEXT("Avatars");
+}
+
+void UDiscordImageManager::BeginDestroy()
+{
+	UObject::BeginDestroy();
+}
+
+void UDiscordImageManager::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UDiscordImageManager* This = CastChecked<UDiscordImageManager>(InThis);
+
+	for (TLruCache<FDiscordAvatarKey, UTexture2D*>::TConstIterator It(This->Avatars); It; ++It)
+	{
+		UTexture2D* Texture = It.Value();
+		Collector.AddReferencedObject(Texture, This);
+	}
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+void UDiscordImageManager::FetchAvatar(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 UserID,
+	const int32 Size, UTexture2D*& Avatar, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = FetchAvatar(UserID, Size, [&Avatar, Action](discord::Result Result, UTexture2D* Texture)
+	{
+		Avatar = Texture;
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordImageManager::FetchAvatar(const int64 UserID, const int32 Size, TFunction<void(discord::Result, UTexture2D*)> Callback,
+	const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(ImageManager_FetchAvatar);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError, nullptr);
+		return {};
+	}
+
+	const FDiscordAvatarKey Key{UserID, ToAvatarSize(Size)};
+	if (UTexture2D* const* Texture = Avatars.FindAndTouch(Key))
+	{
+		Callback(discord::Result::Ok, *Texture);
+		return {};
+	}
+
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+
+	// Already on its way, so the new caller only waits for it
+	if (FPendingFetch* Fetch = PendingFetches.Find(Key))
+	{
+		Fetch->Callbacks.Add(MoveTemp(WrappedCallback));
+		return Handle;
+	}
+
+	FPendingFetch& Fetch = PendingFetches.Add(Key);
+	Fetch.Callbacks.Add(MoveTemp(WrappedCallback));
+
+	// Tracked like any other request, so that a fetch that never completes, e.g. when the SDK loses the answer, times
+	// out and doesn't keep later requests waiting on it. Only the timeout is used, the fetch finishes through FinishFetch
+	DiscordSubsystem->WrapCallback(TFunction<void(discord::Result, UTexture2D*)>([this, Key](discord::Result Result, UTexture2D* Texture)
+	{
+		FinishFetch(Key, Result, Texture);
+	}), -1.f, Fetch.Handle);
+
+	if (GetDefault<UDiscordSettings>()->bCacheAvatarsOnDisk)
+	{
+		LoadFromDisk(Key);
+	}
+	else
+	{
+		FetchFromSdk(Key);
+	}
+
+	return Handle;
+}
+
+UTexture2D* UDiscordImageManager::FindAvatar(const int64 UserID, const int32 Size)
+{
+	UTexture2D* const* Texture = Avatars.FindAndTouch({UserID, ToAvatarSize(Size)});
+	return Texture ? *Texture : nullptr;
+}
+
+void UDiscordImageManager::FetchFromSdk(const FDiscordAvatarKey& Key)
+{
+	DiscordSubsystem->RunOnSdkThread([this, Key]
+	{
+		Internal_ImageManager->Fetch(ToImageHandle(Key), false, [this, Key](discord::Result Result, discord::ImageHandle)
+		{
+			// The SDK keeps the image, so only the key goes to the game thread and the pixels are read from there
+			DiscordSubsystem->RunOnGameThread([this, Key, Result]
+			{
+				if (Result != discord::Result::Ok)
+				{
+					LOG_DISCORD_ERROR(Result);
+					FinishFetch(Key, Result, nullptr);
+					return;
+				}
+
+				PendingUploads.Add({Key});
+			});
+		});
+	});
+}
+
+void UDiscordImageManager::LoadFromDisk(const FDiscordAvatarKey& Key)
+{
+	const double LifetimeSeconds = GetDefault<UDiscordSettings>()->AvatarDiskCacheLifetimeHours * 3600.0;
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis = TWeakObjectPtr<UDiscordImageManager>(this), Key, Path = GetDiskCachePath(Key), LifetimeSeconds]() mutable
+	{
+		FPendingUpload PendingUpload{Key};
+
+		const FDateTime Timestamp = IFileManager::Get().GetTimeStamp(*Path);
+		if (Timestamp != FDateTime::MinValue() && (FDateTime::UtcNow() - Timestamp).GetTotalSeconds() < LifetimeSeconds)
+		{
+			if (const TUniquePtr<FArchive> Reader = TUniquePtr<FArchive>(IFileManager::Get().CreateFileReader(*Path, FILEREAD_Silent)))
+			{
+				uint32 Width = 0;
+				uint32 Height = 0;
+				*Reader << Width << Height;
+
+				// A file cut short by a crash, or from another size, is fetched again
+				const int64 NumBytes = static_cast<int64>(Width) * Height * BytesPerPixel;
+				if (Width == Key.Size && Height == Key.Size && Reader->TotalSize() == DiskCacheHeaderSize + NumBytes)
+				{
+					PendingUpload.Dimensions = FIntPoint(Width, Height);
+					PendingUpload.Pixels.SetNumUninitialized(static_cast<int32>(NumBytes));
+					Reader->Serialize(PendingUpload.Pixels.GetData(), NumBytes);
+				}
+			}
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, PendingUpload = MoveTemp(PendingUpload)]() mutable
+		{
+			UDiscordImageManager* This = WeakThis.Get();
+			if (!This || !This->DiscordSubsystem->IsActive()) return;
+
+			if (PendingUpload.Pixels.Num() > 0)
+			{
+				This->PendingUploads.Add(MoveTemp(PendingUpload));
+			}
+			else
+			{
+				This->FetchFromSdk(PendingUpload.Key);
+			}
+		});
+	});
+}
+
+void UDiscordImageManager::SaveToDisk(const FDiscordAvatarKey& Key, const FIntPoint Dimensions, TArray<uint8>&& Pixels) const
+{
+	Async(EAsyncExecution::ThreadPool, [Path = GetDiskCachePath(Key), Dimensions, Pixels = MoveTemp(Pixels)]() mutable
+	{
+		const TUniquePtr<FArchive> Writer = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*Path, FILEWRITE_Silent));
+		if (!Writer) return;
+
+		uint32 Width = Dimensions.X;
+		uint32 Height = Dimensions.Y;
+		*Writer << Width << Height;
+		Writer->Serialize(Pixels.GetData(), Pixels.Num());
+	});
+}
+
+FString UDiscordImageManager::GetDiskCachePath(const FDiscordAvatarKey& Key) const
+{
+	return DiskCacheDirectory / FString::Printf(TEXT("%lld_%u.rgba"), Key.UserID, Key.Size);
+}
+
+void UDiscordImageManager::FlushPendingUploads()
+{
+	if (PendingUploads.Num() == 0) return;
+
+	DISCORD_SCOPE_CYCLE_COUNTER(ImageManager_FlushPendingUploads);
+
+	// Spread over several frames, so that a list showing a hundred avatars at once doesn't hitch
+	const int32 NumUploads = FMath::Min(PendingUploads.Num(), FMath::Max(GetDefault<UDiscordSettings>()->MaxAvatarUploadsPerFrame, 1));
+	for (int32 Index = 0; Index < NumUploads; Index++)
+	{
+		Upload(PendingUploads[Index]);
+	}
+
+	PendingUploads.RemoveAt(0, NumUploads, EAllowShrinking::No);
+}
+
+void UDiscordImageManager::Upload(FPendingUpload& PendingUpload)
+{
+	const FDiscordAvatarKey& Key = PendingUpload.Key;
+	UTexture2D* Texture = nullptr;
+
+	if (PendingUpload.Pixels.Num() > 0)
+	{
+		Texture = UTexture2D::CreateTransient(PendingUpload.Dimensions.X, PendingUpload.Dimensions.Y, PF_R8G8B8A8);
+		FMemory::Memcpy(LockMip(Texture, PendingUpload.Pixels.Num()), PendingUpload.Pixels.GetData(), PendingUpload.Pixels.Num());
+		UnlockMip(Texture);
+	}
+	else
+	{
+		FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+		const discord::ImageHandle Handle = ToImageHandle(Key);
+
+		discord::ImageDimensions SdkDimensions{};
+		auto Result = Internal_ImageManager->GetDimensions(Handle, &SdkDimensions);
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+			FinishFetch(Key, Result, nullptr);
+			return;
+		}
+
+		const FIntPoint Dimensions(SdkDimensions.GetWidth(), SdkDimensions.GetHeight());
+		const int64 NumBytes = static_cast<int64>(Dimensions.X) * Dimensions.Y * BytesPerPixel;
+		Texture = UTexture2D::CreateTransient(Dimensions.X, Dimensions.Y, PF_R8G8B8A8);
+
+		const bool bCacheOnDisk = GetDefault<UDiscordSettings>()->bCacheAvatarsOnDisk;
+		TArray<uint8> Pixels;
+
+		uint8* MipData = LockMip(Texture, NumBytes);
+		if (bCacheOnDisk)
+		{
+			// Read once into the buffer the disk cache takes over, and uploaded from there
+			Pixels.SetNumUninitialized(static_cast<int32>(NumBytes));
+			Result = Internal_ImageManager->GetData(Handle, Pixels.GetData(), static_cast<uint32>(NumBytes));
+			if (Result == discord::Result::Ok)
+			{
+				FMemory::Memcpy(MipData, Pixels.GetData(), NumBytes);
+			}
+		}
+		else
+		{
+			// Read straight into the texture, without going through another buffer
+			Result = Internal_ImageManager->GetData(Handle, MipData, static_cast<uint32>(NumBytes));
+		}
+		UnlockMip(Texture);
+
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+			FinishFetch(Key, Result, nullptr);
+			return;
+		}
+
+		if (bCacheOnDisk)
+		{
+			SaveToDisk(Key, Dimensions, MoveTemp(Pixels));
+		}
+	}
+
+	Texture->UpdateResource();
+
+	// Evicts the least recent avatar by itself when full
+	Avatars.Add(Key, Texture);
+
+	FinishFetch(Key, discord::Result::Ok, Texture);
+}
+
+void UDiscordImageManager::FinishFetch(const FDiscordAvatarKey& Key, const discord::Result Result, UTexture2D* Texture)
+{
+	FPendingFetch Fetch;
+	if (!PendingFetches.RemoveAndCopyValue(Key, Fetch)) return;
+
+	// A no-op when this is the timeout itself
+	DiscordSubsystem->CancelOperation(Fetch.Handle);
+
+	for (const TFunction<void(discord::Result, UTexture2D*)>& Callback : Fetch.Callbacks)
+	{
+		Callback(Result, Texture);
+	}
+}
@@ -0,0 +1,21 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Lobbies/DiscordLobby.h"
+
+#include "DiscordStats.h"
+#include "Discord/types.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordLobby)
+
+
+FDiscordLobby::FDiscordLobby(discord::Lobby const& Lobby)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordLobby_FromDiscordType);
+
+	ID = Lobby.GetId();
+	Type = static_cast<EDiscordLobbyTypes::Type>(Lobby.GetType());
+	OwnerID = Lobby.GetOwnerId();
+	Secret = UTF8_TO_TCHAR(Lobby.GetSecret());
+	Capacity = Lobby.GetCapacity();
+	bLocked = Lobby.GetLocked();
+}
@@ -0,0 +1,992 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Lobbies/DiscordLobbyManager.h"
+
+#include "DiscordCallbackPump.h"
+#include "DiscordLatentAction.h"
+#include "DiscordLobbyNetwork.h"
+#include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Discord/lobby_manager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordLobbyManager)
+
+
+/** Discord allows 10 updates per 5 seconds for each lobby, and for each lobby member. */
+static constexpr int32 LobbyUpdateLimit = 10;
+static constexpr double LobbyUpdateWindowSeconds = 5.0;
+
+
+/**
+ * Reads every metadata entry through the given function, reusing the same key and value buffers for all of them.
+ */
+static void ReadMetadata(const int32 Count, TFunctionRef<discord::Result(int32 Index, char Key[256], char Value[4096])> ReadEntry, TMap<FString, FString>& OutMetadata)
+{
+	char Key[256];
+	char Value[4096];
+
+	OutMetadata.Reserve(Count);
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		const auto Result = ReadEntry(Index, Key, Value);
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+			continue;
+		}
+
+		OutMetadata.Add(UTF8_TO_TCHAR(Key), UTF8_TO_TCHAR(Value));
+	}
+}
+
+
+/**
+ * Adds the merged metadata writes to a lobby or member transaction.
+ */
+template <typename TransactionType>
+static void AddMetadataChanges(TransactionType& Transaction, const TMap<FString, TOptional<FString>>& Changes)
+{
+	for (const TPair<FString, TOptional<FString>>& Change : Changes)
+	{
+		const auto Result = Change.Value.IsSet()
+			? Transaction.SetMetadata(TCHAR_TO_UTF8(*Change.Key), TCHAR_TO_UTF8(*Change.Value.GetValue()))
+			: Transaction.DeleteMetadata(TCHAR_TO_UTF8(*Change.Key));
+
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+		}
+	}
+}
+
+/**
+ * Fires the callbacks of all the writes merged into an update with its result.
+ */
+static void FinishMetadataWrites(const TArray<TFunction<void(discord::Result)>>& Callbacks, const discord::Result Result)
+{
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+	}
+
+	for (const TFunction<void(discord::Result)>& Callback : Callbacks)
+	{
+		Callback(Result);
+	}
+}
+
+
+UDiscordLobbyManager::FPendingWrites::FPendingWrites()
+	: RateLimiter(LobbyUpdateLimit, LobbyUpdateWindowSeconds)
+{
+}
+
+UDiscordLobbyManager::UDiscordLobbyManager()
+{
+	const auto Outer = GetOuter();
+	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
+	{
+		DiscordSubsystem = Cast<UDiscordSubsystem>(GetOuter());
+	}
+}
+
+void UDiscordLobbyManager::Initialize(discord::LobbyManager* LobbyManager)
+{
+	Internal_LobbyManager = LobbyManager;
+	Network = new FDiscordLobbyNetwork();
+
+	// The handlers run on whichever thread pumps the callbacks, so they read what changed right away and only hand it
+	// over. Only the lobby or member named by the event is read again.
+	Internal_OnLobbyUpdateCallback = Internal_LobbyManager->OnLobbyUpdate.Connect([this](const int64 LobbyID)
+	{
+		FLobbyMirror Lobby;
+		if (!ReadLobby(Internal_LobbyManager, LobbyID, false, Lobby)) return;
+
+		DiscordSubsystem->RunOnGameThread([this, LobbyID, Lobby = MoveTemp(Lobby)]() mutable
+		{
+			if (FLobbyMirror* Mirror = Lobbies.Find(LobbyID))
+			{
+				Mirror->Lobby = MoveTemp(Lobby.Lobby);
+				Mirror->Metadata = MoveTemp(Lobby.Metadata);
+			}
+
+			OnLobbyUpdatedNative.Broadcast(LobbyID);
+			OnLobbyUpdated.Broadcast(LobbyID);
+		});
+	});
+
+	Internal_OnLobbyDeleteCallback = Internal_LobbyManager->OnLobbyDelete.Connect([this](const int64 LobbyID, const uint32 Reason)
+	{
+		DiscordSubsystem->RunOnGameThread([this, LobbyID, Reason]
+		{
+			RemoveLobby(LobbyID);
+			OnLobbyDeletedNative.Broadcast(LobbyID, Reason);
+			OnLobbyDeleted.Broadcast(LobbyID, Reason);
+		});
+	});
+
+	Internal_OnMemberConnectCallback = Internal_LobbyManager->OnMemberConnect.Connect([this](const int64 LobbyID, const int64 UserID)
+	{
+		FMemberMirror Member;
+		if (!ReadMember(Internal_LobbyManager, LobbyID, UserID, Member)) return;
+
+		DiscordSubsystem->RunOnGameThread([this, LobbyID, UserID, Member = MoveTemp(Member)]() mutable
+		{
+			if (FLobbyMirror* Mirror = Lobbies.Find(LobbyID))
+			{
+				Mirror->Members.Add(UserID, MoveTemp(Member));
+			}
+
+			OnMemberConnectedNative.Broadcast(LobbyID, UserID);
+			OnMemberConnected.Broadcast(LobbyID, UserID);
+		});
+	});
+
+	Internal_OnMemberUpdateCallback = Internal_LobbyManager->OnMemberUpdate.Connect([this](const int64 LobbyID, const int64 UserID)
+	{
+		FMemberMirror Member;
+		if (!ReadMember(Internal_LobbyManager, LobbyID, UserID, Member)) return;
+
+		DiscordSubsystem->RunOnGameThread([this, LobbyID, UserID, Member = MoveTemp(Member)]() mutable
+		{
+			if (FLobbyMirror* Mirror = Lobbies.Find(LobbyID))
+			{
+				Mirror->Members.Add(UserID, MoveTemp(Member));
+			}
+
+			OnMemberUpdatedNative.Broadcast(LobbyID, UserID);
+			OnMemberUpdated.Broadcast(LobbyID, UserID);
+		});
+	});
+
+	Internal_OnMemberDisconnectCallback = Internal_LobbyManager->OnMemberDisconnect.Connect([this](const int64 LobbyID, const int64 UserID)
+	{
+		DiscordSubsystem->RunOnGameThread([this, LobbyID, UserID]
+		{
+			if (FLobbyMirror* Mirror = Lobbies.Find(LobbyID))
+			{
+				Mirror->Members.Remove(UserID);
+			}
+
+			OnMemberDisconnectedNative.Broadcast(LobbyID, UserID);
+			OnMemberDisconnected.Broadcast(LobbyID, UserID);
+		});
+	});
+
+	// The data only lives for the duration of the event. When it already fires on the game thread, it's handed out as
+	// is, otherwise it's copied once into a pooled buffer.
+	Internal_OnNetworkMessageCallback = Internal_LobbyManager->OnNetworkMessage.Connect([this](const int64 LobbyID, const int64 UserID, const uint8 ChannelID, uint8* Data, const uint32 DataLength)
+	{
+		if (!DiscordSubsystem->IsPumpingOnWorkerThread())
+		{
+			DispatchNetworkMessage(LobbyID, UserID, ChannelID, TArrayView<const uint8>(Data, DataLength));
+			return;
+		}
+
+		TArray<uint8> Buffer = Network->GetBufferPool().Acquire(DataLength);
+		Buffer.Append(Data, DataLength);
+
+		DiscordSubsystem->RunOnGameThread([this, LobbyID, UserID, ChannelID, Buffer = MoveTemp(Buffer)]() mutable
+		{
+			DispatchNetworkMessage(LobbyID, UserID, ChannelID, Buffer);
+			Network->GetBufferPool().Release(MoveTemp(Buffer));
+		});
+	});
+}
+
+void UDiscordLobbyManager::BeginDestroy()
+{
+	if (Internal_LobbyManager)
+	{
+		Internal_LobbyManager->OnLobbyUpdate.Disconnect(Internal_OnLobbyUpdateCallback);
+		Internal_LobbyManager->OnLobbyDelete.Disconnect(Internal_OnLobbyDeleteCallback);
+		Internal_LobbyManager->OnMemberConnect.Disconnect(Internal_OnMemberConnectCallback);
+		Internal_LobbyManager->OnMemberUpdate.Disconnect(Internal_OnMemberUpdateCallback);
+		Internal_LobbyManager->OnMemberDisconnect.Disconnect(Internal_OnMemberDisconnectCallback);
+		Internal_LobbyManager->OnNetworkMessage.Disconnect(Internal_OnNetworkMessageCallback);
+	}
+
+	delete Network;
+	Network = nullptr;
+	
+	UObject::BeginDestroy();
+}
+
+bool UDiscordLobbyManager::ReadLobby(discord::LobbyManager* LobbyManager, const int64 LobbyID, const bool bWithMembers, FLobbyMirror& OutLobby)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(LobbyManager_ReadLobby);
+
+	discord::Lobby Lobby;
+	auto Result = LobbyManager->GetLobby(LobbyID, &Lobby);
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	OutLobby.Lobby = FDiscordLobby(Lobby);
+
+	int32 MetadataCount = 0;
+	Result = LobbyManager->LobbyMetadataCount(LobbyID, &MetadataCount);
+	if (Result == discord::Result::Ok)
+	{
+		ReadMetadata(MetadataCount, [LobbyManager, LobbyID](const int32 Index, char Key[256], char Value[4096])
+		{
+			const auto EntryResult = LobbyManager->GetLobbyMetadataKey(LobbyID, Index, Key);
+			return EntryResult == discord::Result::Ok ? LobbyManager->GetLobbyMetadataValue(LobbyID, Key, Value) : EntryResult;
+		}, OutLobby.Metadata);
+	}
+	else
+	{
+		LOG_DISCORD_ERROR(Result);
+	}
+
+	if (!bWithMembers) return true;
+
+	int32 MemberCount = 0;
+	Result = LobbyManager->MemberCount(LobbyID, &MemberCount);
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return true;
+	}
+
+	OutLobby.Members.Reserve(MemberCount);
+	for (int32 Index = 0; Index < MemberCount; Index++)
+	{
+		int64 UserID = 0;
+		FMemberMirror Member;
+		if (LobbyManager->GetMemberUserId(LobbyID, Index, &UserID) == discord::Result::Ok && ReadMember(LobbyManager, LobbyID, UserID, Member))
+		{
+			OutLobby.Members.Add(UserID, MoveTemp(Member));
+		}
+	}
+
+	return true;
+}
+
+bool UDiscordLobbyManager::ReadMember(discord::LobbyManager* LobbyManager, const int64 LobbyID, const int64 UserID, FMemberMirror& OutMember)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(LobbyManager_ReadMember);
+
+	discord::User User;
+	auto Result = LobbyManager->GetMemberUser(LobbyID, UserID, &User);
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	OutMember.User = FDiscordUtf8User(User);
+
+	int32 MetadataCount = 0;
+	Result = LobbyManager->MemberMetadataCount(LobbyID, UserID, &MetadataCount);
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return true;
+	}
+
+	ReadMetadata(MetadataCount, [LobbyManager, LobbyID, UserID](const int32 Index, char Key[256], char Value[4096])
+	{
+		const auto EntryResult = LobbyManager->GetMemberMetadataKey(LobbyID, UserID, Index, Key);
+		return EntryResult == discord::Result::Ok ? LobbyManager->GetMemberMetadataValue(LobbyID, UserID, Key, Value) : EntryResult;
+	}, OutMember.Metadata);
+
+	return true;
+}
+
+void UDiscordLobbyManager::MirrorLobby(const int64 LobbyID)
+{
+	FLobbyMirror Lobby;
+	if (!ReadLobby(Internal_LobbyManager, LobbyID, true, Lobby)) return;
+
+	DiscordSubsystem->RunOnGameThread([this, LobbyID, Lobby = MoveTemp(Lobby)]() mutable
+	{
+		Lobbies.Add(LobbyID, MoveTemp(Lobby));
+	});
+}
+
+void UDiscordLobbyManager::ForgetLobby(const int64 LobbyID)
+{
+	DiscordSubsystem->RunOnGameThread([this, LobbyID]
+	{
+		RemoveLobby(LobbyID);
+	});
+}
+
+void UDiscordLobbyManager::RemoveLobby(const int64 LobbyID)
+{
+	Lobbies.Remove(LobbyID);
+	Network->CloseLobby(LobbyID);
+
+	// Failed once everything is removed, since the callbacks may queue more writes
+	TArray<TFunction<void(discord::Result)>> Callbacks;
+
+	FPendingWrites LobbyWrites;
+	if (PendingLobbyWrites.RemoveAndCopyValue(LobbyID, LobbyWrites))
+	{
+		Callbacks.Append(MoveTemp(LobbyWrites.Callbacks));
+	}
+
+	for (auto It = PendingMemberWrites.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Key != LobbyID) continue;
+
+		Callbacks.Append(MoveTemp(It.Value().Callbacks));
+		It.RemoveCurrent();
+	}
+
+	if (Callbacks.Num() > 0)
+	{
+		FinishMetadataWrites(Callbacks, discord::Result::NotFound);
+	}
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::QueueMetadataWrite(const int64 LobbyID, const int64 UserID, const FString& Key,
+	TOptional<FString>&& Value, TFunction<void(discord::Result)>&& Callback, const float TimeoutSeconds)
+{
+	if (!DiscordSubsystem->IsActive())
+	{
+		if (Callback) Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	FPendingWrites& Writes = UserID != 0 ? PendingMemberWrites.FindOrAdd({LobbyID, UserID}) : PendingLobbyWrites.FindOrAdd(LobbyID);
+
+	// A later write to the same key replaces the pending one
+	Writes.Changes.Add(Key, MoveTemp(Value));
+	Writes.NumWrites++;
+	WriteStats.Writes++;
+
+	// Fire-and-forget writes don't need to be tracked
+	if (!Callback) return {};
+
+	const UDiscordSettings* Settings = GetDefault<UDiscordSettings>();
+	const double Now = FPlatformTime::Seconds();
+
+	// The timeout only starts once the writes are actually sent
+	float Timeout = TimeoutSeconds < 0.f ? Settings->TimeoutSeconds : TimeoutSeconds;
+	if (Timeout > 0.f)
+	{
+		Timeout += FMath::Max(Settings->LobbyWriteIntervalSeconds - (Now - Writes.LastFlushTime), 0.0) + Writes.RateLimiter.GetTimeUntilAvailable(Now);
+	}
+
+	FDiscordOperationHandle Handle;
+	Writes.Callbacks.Add(DiscordSubsystem->WrapCallback(MoveTemp(Callback), Timeout, Handle));
+	return Handle;
+}
+
+void UDiscordLobbyManager::FlushPendingWrites(const double Now)
+{
+	if (PendingLobbyWrites.Num() == 0 && PendingMemberWrites.Num() == 0) return;
+
+	const double Interval = GetDefault<UDiscordSettings>()->LobbyWriteIntervalSeconds;
+
+	// Broadcast once done, since the handlers may queue more writes
+	TArray<FFlushReport> Reports;
+
+	for (auto It = PendingLobbyWrites.CreateIterator(); It; ++It)
+	{
+		FPendingWrites& Writes = It.Value();
+		if (Writes.NumWrites == 0)
+		{
+			// Once the last update left the rate limit window, there's nothing left worth keeping
+			if (Now - Writes.LastFlushTime > LobbyUpdateWindowSeconds) It.RemoveCurrent();
+			continue;
+		}
+
+		if (Now - Writes.LastFlushTime >= Interval && Writes.RateLimiter.TryAcquire(Now))
+		{
+			SendLobbyWrites(It.Key(), Writes, Now, Reports);
+		}
+	}
+
+	for (auto It = PendingMemberWrites.CreateIterator(); It; ++It)
+	{
+		FPendingWrites& Writes = It.Value();
+		if (Writes.NumWrites == 0)
+		{
+			if (Now - Writes.LastFlushTime > LobbyUpdateWindowSeconds) It.RemoveCurrent();
+			continue;
+		}
+
+		if (Now - Writes.LastFlushTime >= Interval && Writes.RateLimiter.TryAcquire(Now))
+		{
+			SendMemberWrites(It.Key().Key, It.Key().Value, Writes, Now, Reports);
+		}
+	}
+
+	for (const FFlushReport& Report : Reports)
+	{
+		OnMetadataFlushedNative.Broadcast(Report.LobbyID, Report.UserID, Report.NumWrites, Report.NumMerged);
+		OnMetadataFlushed.Broadcast(Report.LobbyID, Report.UserID, Report.NumWrites, Report.NumMerged);
+	}
+}
+
+void UDiscordLobbyManager::SendLobbyWrites(const int64 LobbyID, FPendingWrites& Writes, const double Now, TArray<FFlushReport>& OutReports)
+{
+	const int32 NumWrites = Writes.NumWrites;
+	const int32 NumMerged = NumWrites - Writes.Changes.Num();
+	WriteStats.Merged += NumMerged;
+	WriteStats.Transactions++;
+
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_LobbyManager, LobbyID, Changes = MoveTemp(Writes.Changes), Callbacks = MoveTemp(Writes.Callbacks)]
+	{
+		discord::LobbyTransaction Transaction;
+		const auto Result = Manager->GetLobbyUpdateTransaction(LobbyID, &Transaction);
+		if (Result != discord::Result::Ok)
+		{
+			FinishMetadataWrites(Callbacks, Result);
+			return;
+		}
+
+		AddMetadataChanges(Transaction, Changes);
+		Manager->UpdateLobby(LobbyID, Transaction, [Callbacks](discord::Result Result)
+		{
+			FinishMetadataWrites(Callbacks, Result);
+		});
+	});
+
+	Writes.Changes.Reset();
+	Writes.Callbacks.Reset();
+	Writes.NumWrites = 0;
+	Writes.LastFlushTime = Now;
+
+	LOG_DISCORD(Verbose, "Sent {NumWrites} metadata writes to lobby {LobbyID} in one update, {NumMerged} of them merged", NumWrites, LobbyID, NumMerged);
+	OutReports.Add({LobbyID, 0, NumWrites, NumMerged});
+}
+
+void UDiscordLobbyManager::SendMemberWrites(const int64 LobbyID, const int64 UserID, FPendingWrites& Writes, const double Now, TArray<FFlushReport>& OutReports)
+{
+	const int32 NumWrites = Writes.NumWrites;
+	const int32 NumMerged = NumWrites - Writes.Changes.Num();
+	WriteStats.Merged += NumMerged;
+	WriteStats.Transactions++;
+
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_LobbyManager, LobbyID, UserID, Changes = MoveTemp(Writes.Changes), Callbacks = MoveTemp(Writes.Callbacks)]
+	{
+		discord::LobbyMemberTransaction Transaction;
+		const auto Result = Manager->GetMemberUpdateTransaction(LobbyID, UserID, &Transaction);
+		if (Result != discord::Result::Ok)
+		{
+			FinishMetadataWrites(Callbacks, Result);
+			return;
+		}
+
+		AddMetadataChanges(Transaction, Changes);
+		Manager->UpdateMember(LobbyID, UserID, Transaction, [Callbacks](discord::Result Result)
+		{
+			FinishMetadataWrites(Callbacks, Result);
+		});
+	});
+
+	Writes.Changes.Reset();
+	Writes.Callbacks.Reset();
+	Writes.NumWrites = 0;
+	Writes.LastFlushTime = Now;
+
+	LOG_DISCORD(Verbose, "Sent {NumWrites} metadata writes to member {UserID} of lobby {LobbyID} in one update, {NumMerged} of them merged", NumWrites, UserID, LobbyID, NumMerged);
+	OutReports.Add({LobbyID, UserID, NumWrites, NumMerged});
+}
+
+void UDiscordLobbyManager::DispatchNetworkMessage(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const TArrayView<const uint8> Data)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(LobbyManager_DispatchNetworkMessage);
+
+	Network->Stats.MessagesReceived++;
+	Network->Stats.BytesReceived += Data.Num();
+
+	OnNetworkMessageNative.Broadcast(LobbyID, UserID, ChannelID, Data);
+
+	// Only Blueprints need their own copy
+	if (OnNetworkMessage.IsBound())
+	{
+		OnNetworkMessage.Broadcast(LobbyID, UserID, ChannelID, TArray<uint8>(Data));
+	}
+}
+
+void UDiscordLobbyManager::FlushNetworkMessages()
+{
+	if (!Network->HasQueuedMessages()) return;
+
+	DISCORD_SCOPE_CYCLE_COUNTER(LobbyManager_FlushNetworkMessages);
+
+	TArray<FDiscordLobbyNetwork::FMessage> Messages;
+	Network->TakeQueuedMessages(Messages);
+	Network->Stats.Flushes++;
+
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_LobbyManager, Network = Network, Messages = MoveTemp(Messages)]() mutable
+	{
+		for (FDiscordLobbyNetwork::FMessage& Message : Messages)
+		{
+			const auto Result = Manager->SendNetworkMessage(Message.LobbyID, Message.UserID, Message.ChannelID, Message.Data.GetData(), Message.Data.Num());
+			if (Result != discord::Result::Ok)
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+
+			Network->GetBufferPool().Release(MoveTemp(Message.Data));
+		}
+
+		const auto Result = Manager->FlushNetwork();
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+		}
+	});
+}
+
+void UDiscordLobbyManager::CreateLobby(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const EDiscordLobbyTypes::Type Type,
+	const int32 Capacity, const bool bLocked, const TMap<FString, FString>& Metadata, FDiscordLobby& Lobby, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = CreateLobby(Type, Capacity, bLocked, Metadata, [&Lobby, Action](discord::Result Result, discord::Lobby const& ResultLobby)
+	{
+		if (Result == discord::Result::Ok) Lobby = FDiscordLobby(ResultLobby);
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::CreateLobby(const EDiscordLobbyTypes::Type Type, const int32 Capacity, const bool bLocked,
+	const TMap<FString, FString>& Metadata, TFunction<void(discord::Result, discord::Lobby const&)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_CreateLobby);
+	
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError, discord::Lobby{});
+		return {};
+	}
+	
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, Manager = Internal_LobbyManager, Type, Capacity, bLocked, Metadata, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		discord::LobbyTransaction Transaction;
+		const auto Result = Manager->GetLobbyCreateTransaction(&Transaction);
+		if (Result != discord::Result::Ok)
+		{
+			WrappedCallback(Result, discord::Lobby{});
+			return;
+		}
+
+		Transaction.SetType(static_cast<discord::LobbyType>(Type));
+		Transaction.SetCapacity(Capacity);
+		Transaction.SetLocked(bLocked);
+		for (const TPair<FString, FString>& Entry : Metadata)
+		{
+			Transaction.SetMetadata(TCHAR_TO_UTF8(*Entry.Key), TCHAR_TO_UTF8(*Entry.Value));
+		}
+
+		Manager->CreateLobby(Transaction, [this, WrappedCallback](discord::Result Result, discord::Lobby const& Lobby)
+		{
+			// The copy is queued first, so it's ready by the time the callback fires
+			if (Result == discord::Result::Ok) MirrorLobby(Lobby.GetId());
+			WrappedCallback(Result, Lobby);
+		});
+	});
+
+	return Handle;
+}
+
+void UDiscordLobbyManager::DeleteLobby(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 LobbyID, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = DeleteLobby(LobbyID, [Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::DeleteLobby(const int64 LobbyID, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_DeleteLobby);
+	
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+	
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, Manager = Internal_LobbyManager, LobbyID, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Manager->DeleteLobby(LobbyID, [this, LobbyID, WrappedCallback](discord::Result Result)
+		{
+			if (Result == discord::Result::Ok) ForgetLobby(LobbyID);
+			WrappedCallback(Result);
+		});
+	});
+
+	return Handle;
+}
+
+void UDiscordLobbyManager::ConnectLobby(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 LobbyID,
+	const FString& Secret, FDiscordLobby& Lobby, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = ConnectLobby(LobbyID, Secret, [&Lobby, Action](discord::Result Result, discord::Lobby const& ResultLobby)
+	{
+		if (Result == discord::Result::Ok) Lobby = FDiscordLobby(ResultLobby);
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::ConnectLobby(const int64 LobbyID, const FString& Secret, TFunction<void(discord::Result, discord::Lobby const&)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_ConnectLobby);
+	
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError, discord::Lobby{});
+		return {};
+	}
+	
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, Manager = Internal_LobbyManager, LobbyID, Secret, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Manager->ConnectLobby(LobbyID, TCHAR_TO_UTF8(*Secret), [this, WrappedCallback](discord::Result Result, discord::Lobby const& Lobby)
+		{
+			if (Result == discord::Result::Ok) MirrorLobby(Lobby.GetId());
+			WrappedCallback(Result, Lobby);
+		});
+	});
+
+	return Handle;
+}
+
+void UDiscordLobbyManager::ConnectLobbyWithActivitySecret(const UObject* WorldContext, const FLatentActionInfo LatentInfo,
+	const FString& ActivitySecret, FDiscordLobby& Lobby, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = ConnectLobbyWithActivitySecret(ActivitySecret, [&Lobby, Action](discord::Result Result, discord::Lobby const& ResultLobby)
+	{
+		if (Result == discord::Result::Ok) Lobby = FDiscordLobby(ResultLobby);
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::ConnectLobbyWithActivitySecret(const FString& ActivitySecret, TFunction<void(discord::Result, discord::Lobby const&)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_ConnectLobbyWithActivitySecret);
+	
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError, discord::Lobby{});
+		return {};
+	}
+	
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, Manager = Internal_LobbyManager, ActivitySecret, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Manager->ConnectLobbyWithActivitySecret(TCHAR_TO_UTF8(*ActivitySecret), [this, WrappedCallback](discord::Result Result, discord::Lobby const& Lobby)
+		{
+			if (Result == discord::Result::Ok) MirrorLobby(Lobby.GetId());
+			WrappedCallback(Result, Lobby);
+		});
+	});
+
+	return Handle;
+}
+
+void UDiscordLobbyManager::DisconnectLobby(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 LobbyID, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = DisconnectLobby(LobbyID, [Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::DisconnectLobby(const int64 LobbyID, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_DisconnectLobby);
+	
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+	
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, Manager = Internal_LobbyManager, LobbyID, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Manager->DisconnectLobby(LobbyID, [this, LobbyID, WrappedCallback](discord::Result Result)
+		{
+			if (Result == discord::Result::Ok) ForgetLobby(LobbyID);
+			WrappedCallback(Result);
+		});
+	});
+
+	return Handle;
+}
+
+void UDiscordLobbyManager::SetLobbyMetadata(const int64 LobbyID, const FString& Key, const FString& Value)
+{
+	SetLobbyMetadata(LobbyID, Key, Value, nullptr);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::SetLobbyMetadata(const int64 LobbyID, const FString& Key, const FString& Value, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_SetLobbyMetadata);
+
+	return QueueMetadataWrite(LobbyID, 0, Key, Value, MoveTemp(Callback), TimeoutSeconds);
+}
+
+void UDiscordLobbyManager::DeleteLobbyMetadata(const int64 LobbyID, const FString& Key)
+{
+	DeleteLobbyMetadata(LobbyID, Key, nullptr);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::DeleteLobbyMetadata(const int64 LobbyID, const FString& Key, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_DeleteLobbyMetadata);
+
+	return QueueMetadataWrite(LobbyID, 0, Key, NullOpt, MoveTemp(Callback), TimeoutSeconds);
+}
+
+void UDiscordLobbyManager::SetMemberMetadata(const int64 LobbyID, const int64 UserID, const FString& Key, const FString& Value)
+{
+	SetMemberMetadata(LobbyID, UserID, Key, Value, nullptr);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::SetMemberMetadata(const int64 LobbyID, const int64 UserID, const FString& Key, const FString& Value, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_SetMemberMetadata);
+
+	return QueueMetadataWrite(LobbyID, UserID, Key, Value, MoveTemp(Callback), TimeoutSeconds);
+}
+
+void UDiscordLobbyManager::DeleteMemberMetadata(const int64 LobbyID, const int64 UserID, const FString& Key)
+{
+	DeleteMemberMetadata(LobbyID, UserID, Key, nullptr);
+}
+
+FDiscordOperationHandle UDiscordLobbyManager::DeleteMemberMetadata(const int64 LobbyID, const int64 UserID, const FString& Key, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_DeleteMemberMetadata);
+
+	return QueueMetadataWrite(LobbyID, UserID, Key, NullOpt, MoveTemp(Callback), TimeoutSeconds);
+}
+
+bool UDiscordLobbyManager::GetLobbyActivitySecret(const int64 LobbyID, FString& ActivitySecret) const
+{
+	DISCORD_SCOPE_CALL(LobbyManager_GetLobbyActivitySecret);
+	
+	if (!DiscordSubsystem->IsActive()) return false;
+	
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	char Secret[128];
+	const auto Result = Internal_LobbyManager->GetLobbyActivitySecret(LobbyID, Secret);
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	ActivitySecret = UTF8_TO_TCHAR(Secret);
+	return true;
+}
+
+bool UDiscordLobbyManager::ConnectNetwork(const int64 LobbyID)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_ConnectNetwork);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	const auto Result = Internal_LobbyManager->ConnectNetwork(LobbyID);
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return true;
+}
+
+bool UDiscordLobbyManager::DisconnectNetwork(const int64 LobbyID)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_DisconnectNetwork);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	Network->CloseLobby(LobbyID);
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	const auto Result = Internal_LobbyManager->DisconnectNetwork(LobbyID);
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return true;
+}
+
+bool UDiscordLobbyManager::OpenNetworkChannel(const int64 LobbyID, const uint8 ChannelID, const bool bReliable)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_OpenNetworkChannel);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	const auto Result = Internal_LobbyManager->OpenNetworkChannel(LobbyID, ChannelID, bReliable);
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	Network->OpenChannel(LobbyID, ChannelID, bReliable);
+	return true;
+}
+
+bool UDiscordLobbyManager::SendNetworkMessage(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const TArray<uint8>& Data)
+{
+	return SendNetworkMessage(LobbyID, UserID, ChannelID, MakeArrayView(Data));
+}
+
+bool UDiscordLobbyManager::SendNetworkMessage(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const TArrayView<const uint8> Data)
+{
+	TArray<uint8>* Buffer = AllocNetworkMessage(LobbyID, UserID, ChannelID, Data.Num());
+	if (!Buffer) return false;
+
+	Buffer->Append(Data.GetData(), Data.Num());
+	return true;
+}
+
+TArray<uint8>* UDiscordLobbyManager::AllocNetworkMessage(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const int32 SizeHint)
+{
+	DISCORD_SCOPE_CALL(LobbyManager_AllocNetworkMessage);
+
+	if (!DiscordSubsystem->IsActive()) return nullptr;
+
+	return Network->Enqueue(LobbyID, UserID, ChannelID, SizeHint);
+}
+
+FDiscordLobbyNetworkStats UDiscordLobbyManager::GetNetworkStats() const
+{
+	return Network ? Network->Stats : FDiscordLobbyNetworkStats();
+}
+
+TArray<int64> UDiscordLobbyManager::GetLobbyIDs() const
+{
+	TArray<int64> LobbyIDs;
+	Lobbies.GenerateKeyArray(LobbyIDs);
+	return LobbyIDs;
+}
+
+bool UDiscordLobbyManager::GetLobby(const int64 LobbyID, FDiscordLobby& Lobby) const
+{
+	DISCORD_SCOPE_CALL(LobbyManager_GetLobby);
+
+	const FLobbyMirror* Mirror = Lobbies.Find(LobbyID);
+	if (!Mirror) return false;
+
+	Lobby = Mirror->Lobby;
+	return true;
+}
+
+bool UDiscordLobbyManager::GetLobbyMetadataValue(const int64 LobbyID, const FString& Key, FString& Value) const
+{
+	DISCORD_SCOPE_CALL(LobbyManager_GetLobbyMetadataValue);
+
+	const TMap<FString, FString>* Metadata = FindLobbyMetadata(LobbyID);
+	const FString* FoundValue = Metadata ? Metadata->Find(Key) : nullptr;
+	if (!FoundValue) return false;
+
+	Value = *FoundValue;
+	return true;
+}
+
+TMap<FString, FString> UDiscordLobbyManager::GetLobbyMetadata(const int64 LobbyID) const
+{
+	const TMap<FString, FString>* Metadata = FindLobbyMetadata(LobbyID);
+	return Metadata ? *Metadata : TMap<FString, FString>();
+}
+
+const TMap<FString, FString>* UDiscordLobbyManager::FindLobbyMetadata(const int64 LobbyID) const
+{
+	const FLobbyMirror* Mirror = Lobbies.Find(LobbyID);
+	return Mirror ? &Mirror->Metadata : nullptr;
+}
+
+TArray<int64> UDiscordLobbyManager::GetMemberIDs(const int64 LobbyID) const
+{
+	TArray<int64> MemberIDs;
+	if (const FLobbyMirror* Mirror = Lobbies.Find(LobbyID))
+	{
+		Mirror->Members.GenerateKeyArray(MemberIDs);
+	}
+	return MemberIDs;
+}
+
+int32 UDiscordLobbyManager::GetMemberCount(const int64 LobbyID) const
+{
+	const FLobbyMirror* Mirror = Lobbies.Find(LobbyID);
+	return Mirror ? Mirror->Members.Num() : 0;
+}
+
+bool UDiscordLobbyManager::GetMemberUser(const int64 LobbyID, const int64 UserID, FDiscordUser& User) const
+{
+	DISCORD_SCOPE_CALL(LobbyManager_GetMemberUser);
+
+	const FLobbyMirror* Mirror = Lobbies.Find(LobbyID);
+	const FMemberMirror* Member = Mirror ? Mirror->Members.Find(UserID) : nullptr;
+	if (!Member) return false;
+
+	User = FDiscordUser(Member->User);
+	return true;
+}
+
+bool UDiscordLobbyManager::GetMemberMetadataValue(const int64 LobbyID, const int64 UserID, const FString& Key, FString& Value) const
+{
+	DISCORD_SCOPE_CALL(LobbyManager_GetMemberMetadataValue);
+
+	const TMap<FString, FString>* Metadata = FindMemberMetadata(LobbyID, UserID);
+	const FString* FoundValue = Metadata ? Metadata->Find(Key) : nullptr;
+	if (!FoundValue) return false;
+
+	Value = *FoundValue;
+	return true;
+}
+
+TMap<FString, FString> UDiscordLobbyManager::GetMemberMetadata(const int64 LobbyID, const int64 UserID) const
+{
+	const TMap<FString, FString>* Metadata = FindMemberMetadata(LobbyID, UserID);
+	return Metadata ? *Metadata : TMap<FString, FString>();
+}
+
+const TMap<FString, FString>* UDiscordLobbyManager::FindMemberMetadata(const int64 LobbyID, const int64 UserID) const
+{
+	const FLobbyMirror* Mirror = Lobbies.Find(LobbyID);
+	const FMemberMirror* Member = Mirror ? Mirror->Members.Find(UserID) : nullptr;
+	return Member ? &Member->Metadata : nullptr;
+}
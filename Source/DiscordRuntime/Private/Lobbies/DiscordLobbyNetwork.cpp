@@ -0,0 +1,83 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordLobbyNetwork.h"
+
+#include "DiscordLogChannel.h"
+
+
+/** Buffers kept for reuse. Enough for a few frames' worth of messages in both directions. */
+static constexpr int32 MaxPooledBuffers = 256;
+
+/** Buffers that grew larger than this are freed rather than kept, so that a single large message can't pin memory. */
+static constexpr int32 MaxPooledBufferSize = 64 * 1024;
+
+/** Unreliable messages beyond this on a channel replace the oldest one, since it would be stale by the time it's sent. */
+static constexpr int32 MaxQueuedUnreliableMessages = 256;
+
+
+FDiscordLobbyNetwork::FDiscordLobbyNetwork()
+	: BufferPool(MaxPooledBuffers, MaxPooledBufferSize)
+{
+}
+
+void FDiscordLobbyNetwork::OpenChannel(const int64 LobbyID, const uint8 ChannelID, const bool bReliable)
+{
+	Channels.FindOrAdd({LobbyID, ChannelID}).bReliable = bReliable;
+}
+
+void FDiscordLobbyNetwork::CloseLobby(const int64 LobbyID)
+{
+	for (auto It = Channels.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Key != LobbyID) continue;
+
+		for (FMessage& Message : It.Value().Queue)
+		{
+			BufferPool.Release(MoveTemp(Message.Data));
+		}
+
+		NumQueued -= It.Value().Queue.Num();
+		Stats.MessagesDropped += It.Value().Queue.Num();
+		It.RemoveCurrent();
+	}
+}
+
+TArray<uint8>* FDiscordLobbyNetwork::Enqueue(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const int32 SizeHint)
+{
+	FChannel* Channel = Channels.Find({LobbyID, ChannelID});
+	if (!Channel)
+	{
+		LOG_DISCORD(Warning, "Can't send a message on channel {ChannelID} of lobby {LobbyID}, it isn't open", ChannelID, LobbyID);
+		return nullptr;
+	}
+
+	if (!Channel->bReliable && Channel->Queue.Num() >= MaxQueuedUnreliableMessages)
+	{
+		BufferPool.Release(MoveTemp(Channel->Queue[0].Data));
+		Channel->Queue.RemoveAt(0, 1, EAllowShrinking::No);
+		NumQueued--;
+		Stats.MessagesDropped++;
+	}
+
+	NumQueued++;
+	return &Channel->Queue.Add_GetRef({LobbyID, UserID, ChannelID, BufferPool.Acquire(SizeHint)}).Data;
+}
+
+void FDiscordLobbyNetwork::TakeQueuedMessages(TArray<FMessage>& OutMessages)
+{
+	OutMessages.Reserve(OutMessages.Num() + NumQueued);
+
+	for (TPair<TPair<int64, uint8>, FChannel>& Channel : Channels)
+	{
+		for (FMessage& Message : Channel.Value.Queue)
+		{
+			Stats.MessagesSent++;
+			Stats.BytesSent += Message.Data.Num();
+			OutMessages.Add(MoveTemp(Message));
+		}
+
+		Channel.Value.Queue.Reset();
+	}
+
+	NumQueued = 0;
+}
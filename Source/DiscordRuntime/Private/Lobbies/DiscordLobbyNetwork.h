@@ -0,0 +1,67 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordBufferPool.h"
+#include "Lobbies/DiscordLobbyManager.h"
+
+
+/**
+ * Send side of the lobby networking. Messages are written into pooled buffers and queued per channel, then handed to
+ * the SDK all at once with a single `FlushNetwork` per frame. Must only be used on the game thread, except for the
+ * buffer pool.
+ */
+class FDiscordLobbyNetwork final
+{
+public:
+	/** A message waiting to be sent. */
+	struct FMessage
+	{
+		int64 LobbyID;
+		int64 UserID;
+		uint8 ChannelID;
+		TArray<uint8> Data;
+	};
+
+	FDiscordLobbyNetwork();
+
+	/**
+	 * Starts queuing messages for a channel of a lobby.
+	 */
+	void OpenChannel(const int64 LobbyID, const uint8 ChannelID, const bool bReliable);
+
+	/**
+	 * Forgets the channels of a lobby, and drops the messages still queued for it.
+	 */
+	void CloseLobby(const int64 LobbyID);
+
+	/**
+	 * Queues a message and returns its buffer to write it into, or nullptr if the channel isn't open. When an unreliable
+	 * channel has too many messages queued, the oldest one is dropped.
+	 */
+	TArray<uint8>* Enqueue(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const int32 SizeHint);
+
+	/**
+	 * Moves all the queued messages out, in the order they were queued on each channel.
+	 */
+	void TakeQueuedMessages(TArray<FMessage>& OutMessages);
+
+	bool HasQueuedMessages() const { return NumQueued > 0; }
+
+	FDiscordBufferPool& GetBufferPool() { return BufferPool; }
+
+	FDiscordLobbyNetworkStats Stats;
+
+private:
+	struct FChannel
+	{
+		bool bReliable = true;
+		TArray<FMessage> Queue;
+	};
+
+	TMap<TPair<int64, uint8>, FChannel> Channels;
+
+	FDiscordBufferPool BufferPool;
+
+	int32 NumQueued = 0;
+};
@@ -0,0 +1,2078 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Mock/DiscordMockSdk.h"
+
+#if WITH_DISCORD_MOCK_SDK
+
+#include "DiscordLogChannel.h"
+
+
+static FDiscordMockSdk* MockInstance = nullptr;
+
+EDiscordResult FDiscordMockSdk::Create(DiscordVersion Version, DiscordCreateParams* Params, IDiscordCore** OutCore)
+{
+	if (!Params || !OutCore) return DiscordResult_InternalError;
+
+	if (MockInstance)
+	{
+		LOG_DISCORD(Error, "Only one mock Discord Game SDK can run at a time");
+		return DiscordResult_InternalError;
+	}
+
+	MockInstance = new FDiscordMockSdk(*Params);
+	*OutCore = &MockInstance->CoreVtable;
+
+	LOG_DISCORD(Display, "Created the mock Discord Game SDK for client {ClientID}", Params->client_id);
+	return DiscordResult_Ok;
+}
+
+FDiscordMockSdk* FDiscordMockSdk::Get()
+{
+	return MockInstance;
+}
+
+FDiscordMockSdk::FDiscordMockSdk(const DiscordCreateParams& Params)
+	: EventData(Params.event_data)
+	, UserEvents(Params.user_events)
+	, ActivityEvents(Params.activity_events)
+	, RelationshipEvents(Params.relationship_events)
+	, LobbyEvents(Params.lobby_events)
+	, NetworkEvents(Params.network_events)
+	, OverlayEvents(Params.overlay_events)
+	, AchievementEvents(Params.achievement_events)
+	, StoreEvents(Params.store_events)
+	, VoiceEvents(Params.voice_events)
+{
+	CoreVtable.destroy = &Core_Destroy;
+	CoreVtable.run_callbacks = &Core_RunCallbacks;
+	CoreVtable.set_log_hook = &Core_SetLogHook;
+	CoreVtable.get_user_manager = &Core_GetUserManager;
+	CoreVtable.get_activity_manager = &Core_GetActivityManager;
+	CoreVtable.get_relationship_manager = &Core_GetRelationshipManager;
+	CoreVtable.get_lobby_manager = &Core_GetLobbyManager;
+	CoreVtable.get_network_manager = &Core_GetNetworkManager;
+	CoreVtable.get_overlay_manager = &Core_GetOverlayManager;
+	CoreVtable.get_storage_manager = &Core_GetStorageManager;
+	CoreVtable.get_image_manager = &Core_GetImageManager;
+	CoreVtable.get_achievement_manager = &Core_GetAchievementManager;
+	CoreVtable.get_store_manager = &Core_GetStoreManager;
+	CoreVtable.get_voice_manager = &Core_GetVoiceManager;
+
+	UserVtable.get_current_user = &User_GetCurrentUser;
+	UserVtable.get_user = &User_GetUser;
+	UserVtable.get_current_user_premium_type = &User_GetCurrentUserPremiumType;
+	UserVtable.current_user_has_flag = &User_CurrentUserHasFlag;
+
+	ActivityVtable.register_command = &Activity_RegisterCommand;
+	ActivityVtable.register_steam = &Activity_RegisterSteam;
+	ActivityVtable.update_activity = &Activity_UpdateActivity;
+	ActivityVtable.clear_activity = &Activity_ClearActivity;
+	ActivityVtable.send_request_reply = &Activity_SendRequestReply;
+	ActivityVtable.send_invite = &Activity_SendInvite;
+	ActivityVtable.accept_invite = &Activity_AcceptInvite;
+
+	RelationshipVtable.filter = &Relationship_Filter;
+	RelationshipVtable.count = &Relationship_Count;
+	RelationshipVtable.get = &Relationship_Get;
+	RelationshipVtable.get_at = &Relationship_GetAt;
+
+	LobbyVtable.get_lobby_create_transaction = &Lobby_GetLobbyCreateTransaction;
+	LobbyVtable.get_lobby_update_transaction = &Lobby_GetLobbyUpdateTransaction;
+	LobbyVtable.get_member_update_transaction = &Lobby_GetMemberUpdateTransaction;
+	LobbyVtable.create_lobby = &Lobby_CreateLobby;
+	LobbyVtable.update_lobby = &Lobby_UpdateLobby;
+	LobbyVtable.delete_lobby = &Lobby_DeleteLobby;
+	LobbyVtable.connect_lobby = &Lobby_ConnectLobby;
+	LobbyVtable.connect_lobby_with_activity_secret = &Lobby_ConnectLobbyWithActivitySecret;
+	LobbyVtable.disconnect_lobby = &Lobby_DisconnectLobby;
+	LobbyVtable.get_lobby = &Lobby_GetLobby;
+	LobbyVtable.get_lobby_activity_secret = &Lobby_GetLobbyActivitySecret;
+	LobbyVtable.get_lobby_metadata_value = &Lobby_GetLobbyMetadataValue;
+	LobbyVtable.get_lobby_metadata_key = &Lobby_GetLobbyMetadataKey;
+	LobbyVtable.lobby_metadata_count = &Lobby_LobbyMetadataCount;
+	LobbyVtable.member_count = &Lobby_MemberCount;
+	LobbyVtable.get_member_user_id = &Lobby_GetMemberUserId;
+	LobbyVtable.get_member_user = &Lobby_GetMemberUser;
+	LobbyVtable.get_member_metadata_value = &Lobby_GetMemberMetadataValue;
+	LobbyVtable.get_member_metadata_key = &Lobby_GetMemberMetadataKey;
+	LobbyVtable.member_metadata_count = &Lobby_MemberMetadataCount;
+	LobbyVtable.update_member = &Lobby_UpdateMember;
+	LobbyVtable.connect_network = &Lobby_ConnectNetwork;
+	LobbyVtable.disconnect_network = &Lobby_DisconnectNetwork;
+	LobbyVtable.flush_network = &Lobby_FlushNetwork;
+	LobbyVtable.open_network_channel = &Lobby_OpenNetworkChannel;
+	LobbyVtable.send_network_message = &Lobby_SendNetworkMessage;
+
+	NetworkVtable.get_peer_id = &Network_GetPeerId;
+	NetworkVtable.flush = &Network_Flush;
+	NetworkVtable.open_peer = &Network_OpenPeer;
+	NetworkVtable.update_peer = &Network_UpdatePeer;
+	NetworkVtable.close_peer = &Network_ClosePeer;
+	NetworkVtable.open_channel = &Network_OpenChannel;
+	NetworkVtable.close_channel = &Network_CloseChannel;
+	NetworkVtable.send_message = &Network_SendMessage;
+
+	OverlayVtable.is_enabled = &Overlay_IsEnabled;
+	OverlayVtable.is_locked = &Overlay_IsLocked;
+	OverlayVtable.set_locked = &Overlay_SetLocked;
+	OverlayVtable.open_activity_invite = &Overlay_OpenActivityInvite;
+	OverlayVtable.open_guild_invite = &Overlay_OpenGuildInvite;
+	OverlayVtable.open_voice_settings = &Overlay_OpenVoiceSettings;
+
+	StorageVtable.read = &Storage_Read;
+	StorageVtable.read_async = &Storage_ReadAsync;
+	StorageVtable.read_async_partial = &Storage_ReadAsyncPartial;
+	StorageVtable.write = &Storage_Write;
+	StorageVtable.write_async = &Storage_WriteAsync;
+	StorageVtable.delete_ = &Storage_Delete;
+	StorageVtable.exists = &Storage_Exists;
+	StorageVtable.count = &Storage_Count;
+	StorageVtable.stat = &Storage_Stat;
+	StorageVtable.stat_at = &Storage_StatAt;
+	StorageVtable.get_path = &Storage_GetPath;
+
+	ImageVtable.fetch = &Image_Fetch;
+	ImageVtable.get_dimensions = &Image_GetDimensions;
+	ImageVtable.get_data = &Image_GetData;
+
+	AchievementVtable.set_user_achievement = &Achievement_SetUserAchievement;
+	AchievementVtable.fetch_user_achievements = &Achievement_FetchUserAchievements;
+	AchievementVtable.count_user_achievements = &Achievement_CountUserAchievements;
+	AchievementVtable.get_user_achievement = &Achievement_GetUserAchievement;
+	AchievementVtable.get_user_achievement_at = &Achievement_GetUserAchievementAt;
+
+	StoreVtable.fetch_skus = &Store_FetchSkus;
+	StoreVtable.count_skus = &Store_CountSkus;
+	StoreVtable.get_sku = &Store_GetSku;
+	StoreVtable.get_sku_at = &Store_GetSkuAt;
+	StoreVtable.fetch_entitlements = &Store_FetchEntitlements;
+	StoreVtable.count_entitlements = &Store_CountEntitlements;
+	StoreVtable.get_entitlement = &Store_GetEntitlement;
+	StoreVtable.get_entitlement_at = &Store_GetEntitlementAt;
+	StoreVtable.has_sku_entitlement = &Store_HasSkuEntitlement;
+	StoreVtable.start_purchase = &Store_StartPurchase;
+
+	VoiceVtable.get_input_mode = &Voice_GetInputMode;
+	VoiceVtable.set_input_mode = &Voice_SetInputMode;
+	VoiceVtable.is_self_mute = &Voice_IsSelfMute;
+	VoiceVtable.set_self_mute = &Voice_SetSelfMute;
+	VoiceVtable.is_self_deaf = &Voice_IsSelfDeaf;
+	VoiceVtable.set_self_deaf = &Voice_SetSelfDeaf;
+	VoiceVtable.is_local_mute = &Voice_IsLocalMute;
+	VoiceVtable.set_local_mute = &Voice_SetLocalMute;
+	VoiceVtable.get_local_volume = &Voice_GetLocalVolume;
+	VoiceVtable.set_local_volume = &Voice_SetLocalVolume;
+
+	CurrentUser.id = 1;
+	FCStringAnsi::Strncpy(CurrentUser.username, "MockUser", sizeof(CurrentUser.username));
+	FCStringAnsi::Strncpy(CurrentUser.discriminator, "0", sizeof(CurrentUser.discriminator));
+	Users.Add(CurrentUser.id, CurrentUser);
+
+	// Like the real SDK, the route is only known a moment after starting
+	FireRouteUpdate(TEXT("{\"mock_peer_id\":4096}"));
+}
+
+void FDiscordMockSdk::SetLatency(const double LatencySeconds, const double JitterSeconds)
+{
+	FScopeLock ScopeLock(&Lock);
+	Latency = FMath::Max(LatencySeconds, 0.0);
+	Jitter = FMath::Max(JitterSeconds, 0.0);
+}
+
+void FDiscordMockSdk::SetResult(const FName Operation, const EDiscordResult Result)
+{
+	FScopeLock ScopeLock(&Lock);
+	ForcedResults.Add(Operation, Result);
+}
+
+void FDiscordMockSdk::ClearResult(const FName Operation)
+{
+	FScopeLock ScopeLock(&Lock);
+	ForcedResults.Remove(Operation);
+}
+
+void FDiscordMockSdk::SetFailureRate(const float Rate)
+{
+	FScopeLock ScopeLock(&Lock);
+	FailureRate = FMath::Clamp(Rate, 0.f, 1.f);
+}
+
+void FDiscordMockSdk::SetCurrentUser(const DiscordUser& User)
+{
+	FScopeLock ScopeLock(&Lock);
+	CurrentUser = User;
+	Users.Add(User.id, User);
+}
+
+void FDiscordMockSdk::AddUser(const DiscordUser& User)
+{
+	FScopeLock ScopeLock(&Lock);
+	Users.Add(User.id, User);
+}
+
+void FDiscordMockSdk::SetRelationship(const DiscordRelationship& Relationship)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		Relationships.Add(Relationship.user.id, Relationship);
+	}
+
+	Schedule(0.0, [this, Relationship]() mutable
+	{
+		if (RelationshipEvents && RelationshipEvents->on_relationship_update) RelationshipEvents->on_relationship_update(EventData, &Relationship);
+	});
+}
+
+void FDiscordMockSdk::AddLobbyMember(const DiscordLobbyId LobbyID, const DiscordUser& User)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		FLobby* Lobby = Lobbies.Find(LobbyID);
+		if (!Lobby) return;
+
+		Lobby->Members.FindOrAdd(User.id).User = User;
+		if (!Lobby->bConnected) return;
+	}
+
+	Schedule(0.0, [this, LobbyID, UserID = User.id]
+	{
+		if (LobbyEvents && LobbyEvents->on_member_connect) LobbyEvents->on_member_connect(EventData, LobbyID, UserID);
+	});
+}
+
+void FDiscordMockSdk::RemoveLobbyMember(const DiscordLobbyId LobbyID, const DiscordUserId UserID)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		FLobby* Lobby = Lobbies.Find(LobbyID);
+		if (!Lobby || Lobby->Members.Remove(UserID) == 0 || !Lobby->bConnected) return;
+	}
+
+	Schedule(0.0, [this, LobbyID, UserID]
+	{
+		if (LobbyEvents && LobbyEvents->on_member_disconnect) LobbyEvents->on_member_disconnect(EventData, LobbyID, UserID);
+	});
+}
+
+void FDiscordMockSdk::SetLobbyMemberMetadata(const DiscordLobbyId LobbyID, const DiscordUserId UserID, const FString& Key, const FString& Value)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		FLobby* Lobby = Lobbies.Find(LobbyID);
+		FLobbyMember* Member = Lobby ? Lobby->Members.Find(UserID) : nullptr;
+		if (!Member) return;
+
+		Member->Metadata.Add(Key, Value);
+		if (!Lobby->bConnected) return;
+	}
+
+	Schedule(0.0, [this, LobbyID, UserID]
+	{
+		if (LobbyEvents && LobbyEvents->on_member_update) LobbyEvents->on_member_update(EventData, LobbyID, UserID);
+	});
+}
+
+int64 FDiscordMockSdk::GetNetworkBytesSent() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NetworkBytesSent;
+}
+
+void FDiscordMockSdk::SetOverlayEnabled(const bool bEnabled)
+{
+	FScopeLock ScopeLock(&Lock);
+	bOverlayEnabled = bEnabled;
+}
+
+void FDiscordMockSdk::SetFile(const FString& Name, const TArray<uint8>& Data)
+{
+	FScopeLock ScopeLock(&Lock);
+	Files.Add(Name, {Data, static_cast<uint64>(FDateTime::UtcNow().ToUnixTimestamp())});
+}
+
+bool FDiscordMockSdk::GetFile(const FString& Name, TArray<uint8>& OutData) const
+{
+	FScopeLock ScopeLock(&Lock);
+	const FStoredFile* File = Files.Find(Name);
+	if (!File) return false;
+
+	OutData = File->Data;
+	return true;
+}
+
+void FDiscordMockSdk::SetUserAchievement(const DiscordUserAchievement& UserAchievement)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		UserAchievements.Add(UserAchievement.achievement_id, UserAchievement);
+	}
+
+	Schedule(0.0, [this, UserAchievement]() mutable
+	{
+		if (AchievementEvents && AchievementEvents->on_user_achievement_update) AchievementEvents->on_user_achievement_update(EventData, &UserAchievement);
+	});
+}
+
+void FDiscordMockSdk::AddSku(const DiscordSku& Sku)
+{
+	FScopeLock ScopeLock(&Lock);
+	Skus.Add(Sku.id, Sku);
+}
+
+void FDiscordMockSdk::AddEntitlement(const DiscordEntitlement& Entitlement)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		Entitlements.Add(Entitlement.id, Entitlement);
+	}
+
+	Schedule(0.0, [this, Entitlement]() mutable
+	{
+		if (StoreEvents && StoreEvents->on_entitlement_create) StoreEvents->on_entitlement_create(EventData, &Entitlement);
+	});
+}
+
+void FDiscordMockSdk::RemoveEntitlement(const DiscordSnowflake EntitlementID)
+{
+	DiscordEntitlement Entitlement{};
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (!Entitlements.RemoveAndCopyValue(EntitlementID, Entitlement)) return;
+	}
+
+	Schedule(0.0, [this, Entitlement]() mutable
+	{
+		if (StoreEvents && StoreEvents->on_entitlement_delete) StoreEvents->on_entitlement_delete(EventData, &Entitlement);
+	});
+}
+
+void FDiscordMockSdk::SetSelfVoiceSettings(const bool bMute, const bool bDeaf)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		bSelfMute = bMute;
+		bSelfDeaf = bDeaf;
+	}
+
+	ScheduleVoiceSettingsUpdate();
+}
+
+void FDiscordMockSdk::SetLocalVoiceSettings(const DiscordUserId UserID, const bool bMute, const uint8 Volume)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		LocalVoiceSettings.Add(UserID, {bMute, Volume});
+	}
+
+	ScheduleVoiceSettingsUpdate();
+}
+
+int32 FDiscordMockSdk::GetNumCalls(const FName Operation) const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumCalls.FindRef(Operation);
+}
+
+DiscordActivity FDiscordMockSdk::GetCurrentActivity() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return CurrentActivity;
+}
+
+void FDiscordMockSdk::FireCurrentUserUpdate()
+{
+	Schedule(0.0, [this]
+	{
+		if (UserEvents && UserEvents->on_current_user_update) UserEvents->on_current_user_update(EventData);
+	});
+}
+
+void FDiscordMockSdk::FireActivityJoin(const char* Secret)
+{
+	Schedule(0.0, [this, Secret = TArray<ANSICHAR>(Secret, FCStringAnsi::Strlen(Secret) + 1)]
+	{
+		if (ActivityEvents && ActivityEvents->on_activity_join) ActivityEvents->on_activity_join(EventData, Secret.GetData());
+	});
+}
+
+void FDiscordMockSdk::FireActivityJoinRequest(const DiscordUser& User)
+{
+	Schedule(0.0, [this, User]() mutable
+	{
+		if (ActivityEvents && ActivityEvents->on_activity_join_request) ActivityEvents->on_activity_join_request(EventData, &User);
+	});
+}
+
+void FDiscordMockSdk::FireActivityInvite(const EDiscordActivityActionType Type, const DiscordUser& User, const DiscordActivity& Activity)
+{
+	Schedule(0.0, [this, Type, User, Activity]() mutable
+	{
+		if (ActivityEvents && ActivityEvents->on_activity_invite) ActivityEvents->on_activity_invite(EventData, Type, &User, &Activity);
+	});
+}
+
+void FDiscordMockSdk::FireRelationshipRefresh()
+{
+	Schedule(0.0, [this]
+	{
+		if (RelationshipEvents && RelationshipEvents->on_refresh) RelationshipEvents->on_refresh(EventData);
+	});
+}
+
+void FDiscordMockSdk::FireNetworkMessage(const DiscordLobbyId LobbyID, const DiscordUserId UserID, const uint8 ChannelID, const TArray<uint8>& Data)
+{
+	Schedule(0.0, [this, LobbyID, UserID, ChannelID, Data]() mutable
+	{
+		if (LobbyEvents && LobbyEvents->on_network_message) LobbyEvents->on_network_message(EventData, LobbyID, UserID, ChannelID, Data.GetData(), Data.Num());
+	});
+}
+
+void FDiscordMockSdk::FirePeerMessage(const DiscordNetworkPeerId PeerID, const uint8 ChannelID, const TArray<uint8>& Data)
+{
+	Schedule(0.0, [this, PeerID, ChannelID, Data]() mutable
+	{
+		if (NetworkEvents && NetworkEvents->on_message) NetworkEvents->on_message(EventData, PeerID, ChannelID, Data.GetData(), Data.Num());
+	});
+}
+
+void FDiscordMockSdk::FireRouteUpdate(const FString& Route)
+{
+	const FTCHARToUTF8 Utf8Route(*Route);
+	Schedule(0.0, [this, Route = TArray<ANSICHAR>(Utf8Route.Get(), Utf8Route.Length() + 1)]
+	{
+		if (NetworkEvents && NetworkEvents->on_route_update) NetworkEvents->on_route_update(EventData, Route.GetData());
+	});
+}
+
+void FDiscordMockSdk::FireOverlayToggle(const bool bLocked)
+{
+	Schedule(0.0, [this, bLocked]
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			bOverlayLocked = bLocked;
+		}
+
+		if (OverlayEvents && OverlayEvents->on_toggle) OverlayEvents->on_toggle(EventData, bLocked);
+	});
+}
+
+void FDiscordMockSdk::ScheduleVoiceSettingsUpdate()
+{
+	Schedule(0.0, [this]
+	{
+		if (VoiceEvents && VoiceEvents->on_settings_update) VoiceEvents->on_settings_update(EventData);
+	});
+}
+
+EDiscordResult FDiscordMockSdk::BeginCall(const FName Operation)
+{
+	FScopeLock ScopeLock(&Lock);
+	NumCalls.FindOrAdd(Operation)++;
+
+	if (const EDiscordResult* ForcedResult = ForcedResults.Find(Operation)) return *ForcedResult;
+
+	return FailureRate > 0.f && FMath::FRand() < FailureRate ? DiscordResult_InternalError : DiscordResult_Ok;
+}
+
+void FDiscordMockSdk::ApplyMetadataChanges(const FMetadataChanges& Changes, TMap<FString, FString>& Metadata)
+{
+	for (const TPair<FString, TOptional<FString>>& Change : Changes)
+	{
+		if (Change.Value.IsSet())
+		{
+			Metadata.Add(Change.Key, Change.Value.GetValue());
+		}
+		else
+		{
+			Metadata.Remove(Change.Key);
+		}
+	}
+}
+
+IDiscordLobbyTransaction* FDiscordMockSdk::CreateLobbyTransaction()
+{
+	FLobbyTransaction* Transaction = new FLobbyTransaction();
+	Transaction->Vtable.set_type = &LobbyTransaction_SetType;
+	Transaction->Vtable.set_owner = &LobbyTransaction_SetOwner;
+	Transaction->Vtable.set_capacity = &LobbyTransaction_SetCapacity;
+	Transaction->Vtable.set_metadata = &LobbyTransaction_SetMetadata;
+	Transaction->Vtable.delete_metadata = &LobbyTransaction_DeleteMetadata;
+	Transaction->Vtable.set_locked = &LobbyTransaction_SetLocked;
+	return &Transaction->Vtable;
+}
+
+void FDiscordMockSdk::ScheduleLobbyResult(const EDiscordResult Result, const DiscordLobby& Lobby, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*))
+{
+	Schedule(GetLatency(), [CallbackData, Callback, Result, Lobby]() mutable
+	{
+		Callback(CallbackData, Result, &Lobby);
+	});
+}
+
+void FDiscordMockSdk::ConnectToLobby(FLobby& Lobby, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*))
+{
+	Lobby.bConnected = true;
+	Lobby.Members.FindOrAdd(CurrentUser.id).User = CurrentUser;
+
+	Schedule(GetLatency(), [CallbackData, Callback, DiscordLobby = Lobby.Lobby]() mutable
+	{
+		Callback(CallbackData, DiscordResult_Ok, &DiscordLobby);
+	});
+}
+
+void FDiscordMockSdk::Schedule(const double DelaySeconds, TUniqueFunction<void()>&& Callback)
+{
+	FScopeLock ScopeLock(&Lock);
+	ScheduledCallbacks.Add({FPlatformTime::Seconds() + DelaySeconds, NextSequence++, MoveTemp(Callback)});
+}
+
+void FDiscordMockSdk::ScheduleResult(const FName Operation, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	const EDiscordResult Result = BeginCall(Operation);
+	Schedule(GetLatency(), [CallbackData, Callback, Result]
+	{
+		Callback(CallbackData, Result);
+	});
+}
+
+double FDiscordMockSdk::GetLatency() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Latency + (Jitter > 0.0 ? FMath::FRandRange(0.0, Jitter) : 0.0);
+}
+
+void FDiscordMockSdk::Log(const EDiscordLogLevel Level, const FString& Message) const
+{
+	if (LogHook && Level <= LogMinLevel)
+	{
+		LogHook(LogHookData, Level, TCHAR_TO_UTF8(*FString::Printf(TEXT("[Mock] %s"), *Message)));
+	}
+}
+
+EDiscordResult FDiscordMockSdk::RunCallbacks()
+{
+	TArray<FScheduledCallback> DueCallbacks;
+	{
+		FScopeLock ScopeLock(&Lock);
+		const double Now = FPlatformTime::Seconds();
+
+		for (int32 Index = 0; Index < ScheduledCallbacks.Num(); )
+		{
+			if (ScheduledCallbacks[Index].DueTime <= Now)
+			{
+				DueCallbacks.Add(MoveTemp(ScheduledCallbacks[Index]));
+				ScheduledCallbacks.RemoveAt(Index, 1, EAllowShrinking::No);
+			}
+			else
+			{
+				Index++;
+			}
+		}
+	}
+
+	// Fired in order, and without holding the lock since the handlers may call back into the SDK
+	DueCallbacks.Sort([](const FScheduledCallback& A, const FScheduledCallback& B)
+	{
+		return A.DueTime != B.DueTime ? A.DueTime < B.DueTime : A.Sequence < B.Sequence;
+	});
+
+	for (FScheduledCallback& DueCallback : DueCallbacks)
+	{
+		DueCallback.Callback();
+	}
+
+	return DiscordResult_Ok;
+}
+
+// Core
+
+void FDiscordMockSdk::Core_Destroy(IDiscordCore* Core)
+{
+	check(MockInstance && Core == &MockInstance->CoreVtable);
+
+	delete MockInstance;
+	MockInstance = nullptr;
+}
+
+EDiscordResult FDiscordMockSdk::Core_RunCallbacks(IDiscordCore* Core)
+{
+	return Get()->RunCallbacks();
+}
+
+void FDiscordMockSdk::Core_SetLogHook(IDiscordCore* Core, EDiscordLogLevel MinLevel, void* HookData, void (DISCORD_API *Hook)(void*, EDiscordLogLevel, const char*))
+{
+	Get()->LogMinLevel = MinLevel;
+	Get()->LogHookData = HookData;
+	Get()->LogHook = Hook;
+	Get()->Log(DiscordLogLevel_Info, TEXT("Log hook set"));
+}
+
+IDiscordUserManager* FDiscordMockSdk::Core_GetUserManager(IDiscordCore* Core)
+{
+	return &Get()->UserVtable;
+}
+
+IDiscordActivityManager* FDiscordMockSdk::Core_GetActivityManager(IDiscordCore* Core)
+{
+	return &Get()->ActivityVtable;
+}
+
+IDiscordRelationshipManager* FDiscordMockSdk::Core_GetRelationshipManager(IDiscordCore* Core)
+{
+	return &Get()->RelationshipVtable;
+}
+
+IDiscordLobbyManager* FDiscordMockSdk::Core_GetLobbyManager(IDiscordCore* Core)
+{
+	return &Get()->LobbyVtable;
+}
+
+IDiscordNetworkManager* FDiscordMockSdk::Core_GetNetworkManager(IDiscordCore* Core)
+{
+	return &Get()->NetworkVtable;
+}
+
+IDiscordOverlayManager* FDiscordMockSdk::Core_GetOverlayManager(IDiscordCore* Core)
+{
+	return &Get()->OverlayVtable;
+}
+
+IDiscordStorageManager* FDiscordMockSdk::Core_GetStorageManager(IDiscordCore* Core)
+{
+	return &Get()->StorageVtable;
+}
+
+IDiscordImageManager* FDiscordMockSdk::Core_GetImageManager(IDiscordCore* Core)
+{
+	return &Get()->ImageVtable;
+}
+
+IDiscordAchievementManager* FDiscordMockSdk::Core_GetAchievementManager(IDiscordCore* Core)
+{
+	return &Get()->AchievementVtable;
+}
+
+IDiscordStoreManager* FDiscordMockSdk::Core_GetStoreManager(IDiscordCore* Core)
+{
+	return &Get()->StoreVtable;
+}
+
+IDiscordVoiceManager* FDiscordMockSdk::Core_GetVoiceManager(IDiscordCore* Core)
+{
+	return &Get()->VoiceVtable;
+}
+
+// Users
+
+EDiscordResult FDiscordMockSdk::User_GetCurrentUser(IDiscordUserManager* Manager, DiscordUser* OutCurrentUser)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetCurrentUser"));
+	if (Result == DiscordResult_Ok)
+	{
+		FScopeLock ScopeLock(&Get()->Lock);
+		*OutCurrentUser = Get()->CurrentUser;
+	}
+	return Result;
+}
+
+void FDiscordMockSdk::User_GetUser(IDiscordUserManager* Manager, DiscordUserId UserID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordUser*))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	EDiscordResult Result = Mock->BeginCall(TEXT("GetUser"));
+	DiscordUser User{};
+	if (Result == DiscordResult_Ok)
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		if (const DiscordUser* FoundUser = Mock->Users.Find(UserID))
+		{
+			User = *FoundUser;
+		}
+		else
+		{
+			Result = DiscordResult_NotFound;
+		}
+	}
+
+	Mock->Schedule(Mock->GetLatency(), [CallbackData, Callback, Result, User]() mutable
+	{
+		Callback(CallbackData, Result, &User);
+	});
+}
+
+EDiscordResult FDiscordMockSdk::User_GetCurrentUserPremiumType(IDiscordUserManager* Manager, EDiscordPremiumType* PremiumType)
+{
+	*PremiumType = DiscordPremiumType_None;
+	return Get()->BeginCall(TEXT("GetCurrentUserPremiumType"));
+}
+
+EDiscordResult FDiscordMockSdk::User_CurrentUserHasFlag(IDiscordUserManager* Manager, EDiscordUserFlag Flag, bool* bHasFlag)
+{
+	*bHasFlag = false;
+	return Get()->BeginCall(TEXT("CurrentUserHasFlag"));
+}
+
+// Activities
+
+EDiscordResult FDiscordMockSdk::Activity_RegisterCommand(IDiscordActivityManager* Manager, const char* Command)
+{
+	return Get()->BeginCall(TEXT("RegisterCommand"));
+}
+
+EDiscordResult FDiscordMockSdk::Activity_RegisterSteam(IDiscordActivityManager* Manager, uint32_t SteamID)
+{
+	return Get()->BeginCall(TEXT("RegisterSteam"));
+}
+
+void FDiscordMockSdk::Activity_UpdateActivity(IDiscordActivityManager* Manager, DiscordActivity* Activity, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		Mock->CurrentActivity = *Activity;
+	}
+
+	Mock->ScheduleResult(TEXT("UpdateActivity"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Activity_ClearActivity(IDiscordActivityManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		Mock->CurrentActivity = DiscordActivity{};
+	}
+
+	Mock->ScheduleResult(TEXT("ClearActivity"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Activity_SendRequestReply(IDiscordActivityManager* Manager, DiscordUserId UserID, EDiscordActivityJoinRequestReply Reply, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("SendRequestReply"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Activity_SendInvite(IDiscordActivityManager* Manager, DiscordUserId UserID, EDiscordActivityActionType Type, const char* Content, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("SendInvite"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Activity_AcceptInvite(IDiscordActivityManager* Manager, DiscordUserId UserID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("AcceptInvite"), CallbackData, Callback);
+}
+
+// Relationships
+
+void FDiscordMockSdk::Relationship_Filter(IDiscordRelationshipManager* Manager, void* FilterData, bool (DISCORD_API *Filter)(void*, DiscordRelationship*))
+{
+	FDiscordMockSdk* Mock = Get();
+	Mock->BeginCall(TEXT("Filter"));
+
+	// The filter only looks at the relationship, so it's fine to run it under the lock
+	FScopeLock ScopeLock(&Mock->Lock);
+	Mock->FilteredRelationships.Reset();
+	for (TPair<DiscordUserId, DiscordRelationship>& Pair : Mock->Relationships)
+	{
+		if (Filter(FilterData, &Pair.Value)) Mock->FilteredRelationships.Add(Pair.Value);
+	}
+}
+
+EDiscordResult FDiscordMockSdk::Relationship_Count(IDiscordRelationshipManager* Manager, int32_t* Count)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("Count"));
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*Count = Get()->FilteredRelationships.Num();
+	return Result;
+}
+
+EDiscordResult FDiscordMockSdk::Relationship_Get(IDiscordRelationshipManager* Manager, DiscordUserId UserID, DiscordRelationship* OutRelationship)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("Get"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const DiscordRelationship* Relationship = Get()->Relationships.Find(UserID);
+	if (!Relationship) return DiscordResult_NotFound;
+
+	*OutRelationship = *Relationship;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Relationship_GetAt(IDiscordRelationshipManager* Manager, uint32_t Index, DiscordRelationship* OutRelationship)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetAt"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	if (!Get()->FilteredRelationships.IsValidIndex(Index)) return DiscordResult_NotFound;
+
+	*OutRelationship = Get()->FilteredRelationships[Index];
+	return DiscordResult_Ok;
+}
+
+// Lobbies
+
+EDiscordResult FDiscordMockSdk::Lobby_GetLobbyCreateTransaction(IDiscordLobbyManager* Manager, IDiscordLobbyTransaction** OutTransaction)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetLobbyCreateTransaction"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	*OutTransaction = CreateLobbyTransaction();
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetLobbyUpdateTransaction(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, IDiscordLobbyTransaction** OutTransaction)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetLobbyUpdateTransaction"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	{
+		FScopeLock ScopeLock(&Get()->Lock);
+		if (!Get()->Lobbies.Contains(LobbyID)) return DiscordResult_NotFound;
+	}
+
+	*OutTransaction = CreateLobbyTransaction();
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetMemberUpdateTransaction(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, IDiscordLobbyMemberTransaction** OutTransaction)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetMemberUpdateTransaction"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FMemberTransaction* Transaction = new FMemberTransaction();
+	Transaction->Vtable.set_metadata = &MemberTransaction_SetMetadata;
+	Transaction->Vtable.delete_metadata = &MemberTransaction_DeleteMetadata;
+
+	*OutTransaction = &Transaction->Vtable;
+	return DiscordResult_Ok;
+}
+
+void FDiscordMockSdk::Lobby_CreateLobby(IDiscordLobbyManager* Manager, IDiscordLobbyTransaction* Transaction, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	// Like the real SDK, the transaction is consumed by the call
+	const TUniquePtr<FLobbyTransaction> Changes(reinterpret_cast<FLobbyTransaction*>(Transaction));
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("CreateLobby"));
+	if (Result != DiscordResult_Ok)
+	{
+		Mock->ScheduleLobbyResult(Result, DiscordLobby{}, CallbackData, Callback);
+		return;
+	}
+
+	FScopeLock ScopeLock(&Mock->Lock);
+	const DiscordLobbyId LobbyID = Mock->NextLobbyID++;
+
+	FLobby& Lobby = Mock->Lobbies.Add(LobbyID);
+	Lobby.Lobby.id = LobbyID;
+	Lobby.Lobby.type = Changes->Type.Get(DiscordLobbyType_Private);
+	Lobby.Lobby.owner_id = Changes->OwnerID.Get(Mock->CurrentUser.id);
+	Lobby.Lobby.capacity = Changes->Capacity.Get(16);
+	Lobby.Lobby.locked = Changes->bLocked.Get(false);
+	FCStringAnsi::Snprintf(Lobby.Lobby.secret, sizeof(Lobby.Lobby.secret), "mock-secret-%lld", static_cast<long long>(LobbyID));
+	ApplyMetadataChanges(Changes->Metadata, Lobby.Metadata);
+
+	Mock->ConnectToLobby(Lobby, CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Lobby_UpdateLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, IDiscordLobbyTransaction* Transaction, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+	const TUniquePtr<FLobbyTransaction> Changes(reinterpret_cast<FLobbyTransaction*>(Transaction));
+
+	EDiscordResult Result = Mock->BeginCall(TEXT("UpdateLobby"));
+	if (Result == DiscordResult_Ok)
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		if (FLobby* Lobby = Mock->Lobbies.Find(LobbyID))
+		{
+			if (Changes->Type.IsSet()) Lobby->Lobby.type = Changes->Type.GetValue();
+			if (Changes->OwnerID.IsSet()) Lobby->Lobby.owner_id = Changes->OwnerID.GetValue();
+			if (Changes->Capacity.IsSet()) Lobby->Lobby.capacity = Changes->Capacity.GetValue();
+			if (Changes->bLocked.IsSet()) Lobby->Lobby.locked = Changes->bLocked.GetValue();
+			ApplyMetadataChanges(Changes->Metadata, Lobby->Metadata);
+		}
+		else
+		{
+			Result = DiscordResult_NotFound;
+		}
+	}
+
+	Mock->Schedule(Mock->GetLatency(), [Mock, LobbyID, CallbackData, Callback, Result]
+	{
+		Callback(CallbackData, Result);
+
+		if (Result == DiscordResult_Ok && Mock->LobbyEvents && Mock->LobbyEvents->on_lobby_update) Mock->LobbyEvents->on_lobby_update(Mock->EventData, LobbyID);
+	});
+}
+
+void FDiscordMockSdk::Lobby_DeleteLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	EDiscordResult Result = Mock->BeginCall(TEXT("DeleteLobby"));
+	if (Result == DiscordResult_Ok)
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		if (Mock->Lobbies.Remove(LobbyID) == 0) Result = DiscordResult_NotFound;
+	}
+
+	Mock->Schedule(Mock->GetLatency(), [Mock, LobbyID, CallbackData, Callback, Result]
+	{
+		Callback(CallbackData, Result);
+
+		if (Result == DiscordResult_Ok && Mock->LobbyEvents && Mock->LobbyEvents->on_lobby_delete) Mock->LobbyEvents->on_lobby_delete(Mock->EventData, LobbyID, 0);
+	});
+}
+
+void FDiscordMockSdk::Lobby_ConnectLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, char* Secret, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	EDiscordResult Result = Mock->BeginCall(TEXT("ConnectLobby"));
+	if (Result == DiscordResult_Ok)
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		FLobby* Lobby = Mock->Lobbies.Find(LobbyID);
+		if (!Lobby)
+		{
+			Result = DiscordResult_NotFound;
+		}
+		else if (FCStringAnsi::Strcmp(Lobby->Lobby.secret, Secret) != 0)
+		{
+			Result = DiscordResult_InvalidLobbySecret;
+		}
+		else
+		{
+			Mock->ConnectToLobby(*Lobby, CallbackData, Callback);
+			return;
+		}
+	}
+
+	Mock->ScheduleLobbyResult(Result, DiscordLobby{}, CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Lobby_ConnectLobbyWithActivitySecret(IDiscordLobbyManager* Manager, char* ActivitySecret, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	EDiscordResult Result = Mock->BeginCall(TEXT("ConnectLobbyWithActivitySecret"));
+	if (Result == DiscordResult_Ok)
+	{
+		// Activity secrets are made by GetLobbyActivitySecret, as "<lobby id>:<secret>"
+		const FString SecretString = UTF8_TO_TCHAR(ActivitySecret);
+		FString LobbyIDString, Secret;
+
+		FScopeLock ScopeLock(&Mock->Lock);
+		FLobby* Lobby = SecretString.Split(TEXT(":"), &LobbyIDString, &Secret) ? Mock->Lobbies.Find(FCString::Atoi64(*LobbyIDString)) : nullptr;
+		if (Lobby && Secret == UTF8_TO_TCHAR(Lobby->Lobby.secret))
+		{
+			Mock->ConnectToLobby(*Lobby, CallbackData, Callback);
+			return;
+		}
+
+		Result = DiscordResult_InvalidLobbySecret;
+	}
+
+	Mock->ScheduleLobbyResult(Result, DiscordLobby{}, CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Lobby_DisconnectLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	EDiscordResult Result = Mock->BeginCall(TEXT("DisconnectLobby"));
+	if (Result == DiscordResult_Ok)
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		FLobby* Lobby = Mock->Lobbies.Find(LobbyID);
+		if (Lobby && Lobby->bConnected)
+		{
+			Lobby->bConnected = false;
+			Lobby->bNetworkConnected = false;
+			Lobby->NetworkChannels.Reset();
+			Lobby->Members.Remove(Mock->CurrentUser.id);
+		}
+		else
+		{
+			Result = DiscordResult_NotFound;
+		}
+	}
+
+	Mock->Schedule(Mock->GetLatency(), [CallbackData, Callback, Result]
+	{
+		Callback(CallbackData, Result);
+	});
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordLobby* OutLobby)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetLobby"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bConnected) return DiscordResult_NotFound;
+
+	*OutLobby = Lobby->Lobby;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetLobbyActivitySecret(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordLobbySecret* OutSecret)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetLobbyActivitySecret"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bConnected) return DiscordResult_NotFound;
+
+	FCStringAnsi::Snprintf(*OutSecret, sizeof(DiscordLobbySecret), "%lld:%s", static_cast<long long>(LobbyID), Lobby->Lobby.secret);
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetLobbyMetadataValue(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, char* Key, DiscordMetadataValue* OutValue)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetLobbyMetadataValue"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	const FString* Value = Lobby && Lobby->bConnected ? Lobby->Metadata.Find(UTF8_TO_TCHAR(Key)) : nullptr;
+	if (!Value) return DiscordResult_NotFound;
+
+	FCStringAnsi::Strncpy(*OutValue, TCHAR_TO_UTF8(**Value), sizeof(DiscordMetadataValue));
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetLobbyMetadataKey(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, int32_t Index, DiscordMetadataKey* OutKey)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetLobbyMetadataKey"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bConnected) return DiscordResult_NotFound;
+
+	for (auto It = Lobby->Metadata.CreateConstIterator(); It; ++It)
+	{
+		if (Index-- == 0)
+		{
+			FCStringAnsi::Strncpy(*OutKey, TCHAR_TO_UTF8(*It.Key()), sizeof(DiscordMetadataKey));
+			return DiscordResult_Ok;
+		}
+	}
+
+	return DiscordResult_NotFound;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_LobbyMetadataCount(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, int32_t* OutCount)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("LobbyMetadataCount"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bConnected) return DiscordResult_NotFound;
+
+	*OutCount = Lobby->Metadata.Num();
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_MemberCount(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, int32_t* OutCount)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("MemberCount"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bConnected) return DiscordResult_NotFound;
+
+	*OutCount = Lobby->Members.Num();
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetMemberUserId(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, int32_t Index, DiscordUserId* OutUserID)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetMemberUserId"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bConnected) return DiscordResult_NotFound;
+
+	for (auto It = Lobby->Members.CreateConstIterator(); It; ++It)
+	{
+		if (Index-- == 0)
+		{
+			*OutUserID = It.Key();
+			return DiscordResult_Ok;
+		}
+	}
+
+	return DiscordResult_NotFound;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetMemberUser(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, DiscordUser* OutUser)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetMemberUser"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	const FLobbyMember* Member = Lobby && Lobby->bConnected ? Lobby->Members.Find(UserID) : nullptr;
+	if (!Member) return DiscordResult_NotFound;
+
+	*OutUser = Member->User;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetMemberMetadataValue(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, char* Key, DiscordMetadataValue* OutValue)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetMemberMetadataValue"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	const FLobbyMember* Member = Lobby && Lobby->bConnected ? Lobby->Members.Find(UserID) : nullptr;
+	const FString* Value = Member ? Member->Metadata.Find(UTF8_TO_TCHAR(Key)) : nullptr;
+	if (!Value) return DiscordResult_NotFound;
+
+	FCStringAnsi::Strncpy(*OutValue, TCHAR_TO_UTF8(**Value), sizeof(DiscordMetadataValue));
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_GetMemberMetadataKey(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, int32_t Index, DiscordMetadataKey* OutKey)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetMemberMetadataKey"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	const FLobbyMember* Member = Lobby && Lobby->bConnected ? Lobby->Members.Find(UserID) : nullptr;
+	if (!Member) return DiscordResult_NotFound;
+
+	for (auto It = Member->Metadata.CreateConstIterator(); It; ++It)
+	{
+		if (Index-- == 0)
+		{
+			FCStringAnsi::Strncpy(*OutKey, TCHAR_TO_UTF8(*It.Key()), sizeof(DiscordMetadataKey));
+			return DiscordResult_Ok;
+		}
+	}
+
+	return DiscordResult_NotFound;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_MemberMetadataCount(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, int32_t* OutCount)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("MemberMetadataCount"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	const FLobbyMember* Member = Lobby && Lobby->bConnected ? Lobby->Members.Find(UserID) : nullptr;
+	if (!Member) return DiscordResult_NotFound;
+
+	*OutCount = Member->Metadata.Num();
+	return DiscordResult_Ok;
+}
+
+void FDiscordMockSdk::Lobby_UpdateMember(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, IDiscordLobbyMemberTransaction* Transaction, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+	const TUniquePtr<FMemberTransaction> Changes(reinterpret_cast<FMemberTransaction*>(Transaction));
+
+	EDiscordResult Result = Mock->BeginCall(TEXT("UpdateMember"));
+	if (Result == DiscordResult_Ok)
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		FLobby* Lobby = Mock->Lobbies.Find(LobbyID);
+		FLobbyMember* Member = Lobby && Lobby->bConnected ? Lobby->Members.Find(UserID) : nullptr;
+		if (Member)
+		{
+			ApplyMetadataChanges(Changes->Metadata, Member->Metadata);
+		}
+		else
+		{
+			Result = DiscordResult_NotFound;
+		}
+	}
+
+	Mock->Schedule(Mock->GetLatency(), [Mock, LobbyID, UserID, CallbackData, Callback, Result]
+	{
+		Callback(CallbackData, Result);
+
+		if (Result == DiscordResult_Ok && Mock->LobbyEvents && Mock->LobbyEvents->on_member_update) Mock->LobbyEvents->on_member_update(Mock->EventData, LobbyID, UserID);
+	});
+}
+
+// Lobby networking
+
+EDiscordResult FDiscordMockSdk::Lobby_ConnectNetwork(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("ConnectNetwork"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bConnected) return DiscordResult_NotFound;
+
+	Lobby->bNetworkConnected = true;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_DisconnectNetwork(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("DisconnectNetwork"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bNetworkConnected) return DiscordResult_NotFound;
+
+	Lobby->bNetworkConnected = false;
+	Lobby->NetworkChannels.Reset();
+	Get()->LoopbackMessages.RemoveAll([LobbyID](const FNetworkMessage& Message) { return Message.LobbyID == LobbyID; });
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_FlushNetwork(IDiscordLobbyManager* Manager)
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("FlushNetwork"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	TArray<FNetworkMessage> Messages;
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		if (Mock->LoopbackMessages.Num() == 0) return DiscordResult_Ok;
+
+		Messages = MoveTemp(Mock->LoopbackMessages);
+	}
+
+	Mock->Schedule(Mock->GetLatency(), [Mock, Messages = MoveTemp(Messages)]() mutable
+	{
+		for (FNetworkMessage& Message : Messages)
+		{
+			if (Mock->LobbyEvents && Mock->LobbyEvents->on_network_message) Mock->LobbyEvents->on_network_message(Mock->EventData, Message.LobbyID, Mock->CurrentUser.id, Message.ChannelID, Message.Data.GetData(), Message.Data.Num());
+		}
+	});
+
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_OpenNetworkChannel(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, uint8_t ChannelID, bool bReliable)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("OpenNetworkChannel"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	FLobby* Lobby = Get()->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->bNetworkConnected) return DiscordResult_NotFound;
+
+	Lobby->NetworkChannels.Add(ChannelID);
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Lobby_SendNetworkMessage(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, uint8_t ChannelID, uint8_t* Data, uint32_t DataLength)
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("SendNetworkMessage"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Mock->Lock);
+	const FLobby* Lobby = Mock->Lobbies.Find(LobbyID);
+	if (!Lobby || !Lobby->NetworkChannels.Contains(ChannelID)) return DiscordResult_InvalidChannel;
+	if (!Lobby->Members.Contains(UserID)) return DiscordResult_NotFound;
+
+	Mock->NetworkBytesSent += DataLength;
+
+	// Messages to other members have nowhere to go
+	if (UserID == Mock->CurrentUser.id)
+	{
+		Mock->LoopbackMessages.Add({LobbyID, ChannelID, TArray<uint8>(Data, DataLength)});
+	}
+
+	return DiscordResult_Ok;
+}
+
+// Networking
+
+void FDiscordMockSdk::Network_GetPeerId(IDiscordNetworkManager* Manager, DiscordNetworkPeerId* OutPeerID)
+{
+	Get()->BeginCall(TEXT("GetPeerId"));
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*OutPeerID = Get()->LocalPeerID;
+}
+
+EDiscordResult FDiscordMockSdk::Network_Flush(IDiscordNetworkManager* Manager)
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("Flush"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	TArray<FPeerMessage> Messages;
+	{
+		FScopeLock ScopeLock(&Mock->Lock);
+		if (Mock->PeerLoopbackMessages.Num() == 0) return DiscordResult_Ok;
+
+		Messages = MoveTemp(Mock->PeerLoopbackMessages);
+	}
+
+	Mock->Schedule(Mock->GetLatency(), [Mock, Messages = MoveTemp(Messages)]() mutable
+	{
+		for (FPeerMessage& Message : Messages)
+		{
+			if (Mock->NetworkEvents && Mock->NetworkEvents->on_message) Mock->NetworkEvents->on_message(Mock->EventData, Message.PeerID, Message.ChannelID, Message.Data.GetData(), Message.Data.Num());
+		}
+	});
+
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Network_OpenPeer(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, const char* RouteData)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("OpenPeer"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	Get()->Peers.FindOrAdd(PeerID).Route = UTF8_TO_TCHAR(RouteData);
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Network_UpdatePeer(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, const char* RouteData)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("UpdatePeer"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	FNetworkPeer* Peer = Get()->Peers.Find(PeerID);
+	if (!Peer) return DiscordResult_NotFound;
+
+	Peer->Route = UTF8_TO_TCHAR(RouteData);
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Network_ClosePeer(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("ClosePeer"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	if (Get()->Peers.Remove(PeerID) == 0) return DiscordResult_NotFound;
+
+	Get()->PeerLoopbackMessages.RemoveAll([PeerID](const FPeerMessage& Message) { return Message.PeerID == PeerID; });
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Network_OpenChannel(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, DiscordNetworkChannelId ChannelID, bool bReliable)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("OpenChannel"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	FNetworkPeer* Peer = Get()->Peers.Find(PeerID);
+	if (!Peer) return DiscordResult_NotFound;
+
+	Peer->Channels.Add(ChannelID);
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Network_CloseChannel(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, DiscordNetworkChannelId ChannelID)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("CloseChannel"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	FNetworkPeer* Peer = Get()->Peers.Find(PeerID);
+	if (!Peer || Peer->Channels.Remove(ChannelID) == 0) return DiscordResult_InvalidChannel;
+
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Network_SendMessage(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, DiscordNetworkChannelId ChannelID, uint8_t* Data, uint32_t DataLength)
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("SendMessage"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Mock->Lock);
+	const FNetworkPeer* Peer = Mock->Peers.Find(PeerID);
+	if (!Peer || !Peer->Channels.Contains(ChannelID)) return DiscordResult_InvalidChannel;
+
+	Mock->NetworkBytesSent += DataLength;
+
+	// Messages to other peers have nowhere to go
+	if (PeerID == Mock->LocalPeerID)
+	{
+		Mock->PeerLoopbackMessages.Add({PeerID, ChannelID, TArray<uint8>(Data, DataLength)});
+	}
+
+	return DiscordResult_Ok;
+}
+
+// Lobby transactions
+
+EDiscordResult FDiscordMockSdk::LobbyTransaction_SetType(IDiscordLobbyTransaction* Transaction, EDiscordLobbyType Type)
+{
+	reinterpret_cast<FLobbyTransaction*>(Transaction)->Type = Type;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::LobbyTransaction_SetOwner(IDiscordLobbyTransaction* Transaction, DiscordUserId OwnerID)
+{
+	reinterpret_cast<FLobbyTransaction*>(Transaction)->OwnerID = OwnerID;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::LobbyTransaction_SetCapacity(IDiscordLobbyTransaction* Transaction, uint32_t Capacity)
+{
+	reinterpret_cast<FLobbyTransaction*>(Transaction)->Capacity = Capacity;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::LobbyTransaction_SetMetadata(IDiscordLobbyTransaction* Transaction, char* Key, char* Value)
+{
+	reinterpret_cast<FLobbyTransaction*>(Transaction)->Metadata.Add(UTF8_TO_TCHAR(Key), FString(UTF8_TO_TCHAR(Value)));
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::LobbyTransaction_DeleteMetadata(IDiscordLobbyTransaction* Transaction, char* Key)
+{
+	reinterpret_cast<FLobbyTransaction*>(Transaction)->Metadata.Add(UTF8_TO_TCHAR(Key), NullOpt);
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::LobbyTransaction_SetLocked(IDiscordLobbyTransaction* Transaction, bool bLocked)
+{
+	reinterpret_cast<FLobbyTransaction*>(Transaction)->bLocked = bLocked;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::MemberTransaction_SetMetadata(IDiscordLobbyMemberTransaction* Transaction, char* Key, char* Value)
+{
+	reinterpret_cast<FMemberTransaction*>(Transaction)->Metadata.Add(UTF8_TO_TCHAR(Key), FString(UTF8_TO_TCHAR(Value)));
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::MemberTransaction_DeleteMetadata(IDiscordLobbyMemberTransaction* Transaction, char* Key)
+{
+	reinterpret_cast<FMemberTransaction*>(Transaction)->Metadata.Add(UTF8_TO_TCHAR(Key), NullOpt);
+	return DiscordResult_Ok;
+}
+
+// Storage
+
+void FDiscordMockSdk::ScheduleFileRead(const FName Operation, const char* Name, const uint64 Offset, const uint64 Length, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, uint8_t*, uint32_t))
+{
+	EDiscordResult Result = BeginCall(Operation);
+	TArray<uint8> Data;
+	if (Result == DiscordResult_Ok)
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (const FStoredFile* File = Files.Find(UTF8_TO_TCHAR(Name)))
+		{
+			// Reading past the end returns what's left, like the SDK does
+			const uint64 Start = FMath::Min<uint64>(Offset, File->Data.Num());
+			Data.Append(File->Data.GetData() + Start, FMath::Min<uint64>(Length, File->Data.Num() - Start));
+		}
+		else
+		{
+			Result = DiscordResult_NotFound;
+		}
+	}
+
+	Schedule(GetLatency(), [CallbackData, Callback, Result, Data = MoveTemp(Data)]() mutable
+	{
+		Callback(CallbackData, Result, Data.GetData(), Data.Num());
+	});
+}
+
+void FDiscordMockSdk::FillFileStat(const FString& Name, const FStoredFile& File, DiscordFileStat& OutStat)
+{
+	FCStringAnsi::Strncpy(OutStat.filename, TCHAR_TO_UTF8(*Name), sizeof(OutStat.filename));
+	OutStat.size = File.Data.Num();
+	OutStat.last_modified = File.LastModified;
+}
+
+EDiscordResult FDiscordMockSdk::Storage_Read(IDiscordStorageManager* Manager, const char* Name, uint8_t* Data, uint32_t DataLength, uint32_t* OutRead)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("Read"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FStoredFile* File = Get()->Files.Find(UTF8_TO_TCHAR(Name));
+	if (!File) return DiscordResult_NotFound;
+
+	*OutRead = FMath::Min<uint32>(DataLength, File->Data.Num());
+	FMemory::Memcpy(Data, File->Data.GetData(), *OutRead);
+	return DiscordResult_Ok;
+}
+
+void FDiscordMockSdk::Storage_ReadAsync(IDiscordStorageManager* Manager, const char* Name, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, uint8_t*, uint32_t))
+{
+	Get()->ScheduleFileRead(TEXT("ReadAsync"), Name, 0, MAX_uint64, CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Storage_ReadAsyncPartial(IDiscordStorageManager* Manager, const char* Name, uint64_t Offset, uint64_t Length, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, uint8_t*, uint32_t))
+{
+	Get()->ScheduleFileRead(TEXT("ReadAsyncPartial"), Name, Offset, Length, CallbackData, Callback);
+}
+
+EDiscordResult FDiscordMockSdk::Storage_Write(IDiscordStorageManager* Manager, const char* Name, uint8_t* Data, uint32_t DataLength)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("Write"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	Get()->SetFile(UTF8_TO_TCHAR(Name), TArray<uint8>(Data, DataLength));
+	return DiscordResult_Ok;
+}
+
+void FDiscordMockSdk::Storage_WriteAsync(IDiscordStorageManager* Manager, const char* Name, uint8_t* Data, uint32_t DataLength, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	// Written right away, since the data is only borrowed until the callback
+	const EDiscordResult Result = Mock->BeginCall(TEXT("WriteAsync"));
+	if (Result == DiscordResult_Ok)
+	{
+		Mock->SetFile(UTF8_TO_TCHAR(Name), TArray<uint8>(Data, DataLength));
+	}
+
+	Mock->Schedule(Mock->GetLatency(), [CallbackData, Callback, Result]
+	{
+		Callback(CallbackData, Result);
+	});
+}
+
+EDiscordResult FDiscordMockSdk::Storage_Delete(IDiscordStorageManager* Manager, const char* Name)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("Delete"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	return Get()->Files.Remove(UTF8_TO_TCHAR(Name)) > 0 ? DiscordResult_Ok : DiscordResult_NotFound;
+}
+
+EDiscordResult FDiscordMockSdk::Storage_Exists(IDiscordStorageManager* Manager, const char* Name, bool* bOutExists)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("Exists"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*bOutExists = Get()->Files.Contains(UTF8_TO_TCHAR(Name));
+	return DiscordResult_Ok;
+}
+
+void FDiscordMockSdk::Storage_Count(IDiscordStorageManager* Manager, int32_t* OutCount)
+{
+	Get()->BeginCall(TEXT("Count"));
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*OutCount = Get()->Files.Num();
+}
+
+EDiscordResult FDiscordMockSdk::Storage_Stat(IDiscordStorageManager* Manager, const char* Name, DiscordFileStat* OutStat)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("Stat"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const FString FileName = UTF8_TO_TCHAR(Name);
+	const FStoredFile* File = Get()->Files.Find(FileName);
+	if (!File) return DiscordResult_NotFound;
+
+	FillFileStat(FileName, *File, *OutStat);
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Storage_StatAt(IDiscordStorageManager* Manager, int32_t Index, DiscordFileStat* OutStat)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("StatAt"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	for (const TPair<FString, FStoredFile>& File : Get()->Files)
+	{
+		if (Index-- == 0)
+		{
+			FillFileStat(File.Key, File.Value, *OutStat);
+			return DiscordResult_Ok;
+		}
+	}
+
+	return DiscordResult_NotFound;
+}
+
+EDiscordResult FDiscordMockSdk::Storage_GetPath(IDiscordStorageManager* Manager, DiscordPath* OutPath)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetPath"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	// Nothing is on disk
+	FCStringAnsi::Strncpy(*OutPath, "mock://storage", sizeof(DiscordPath));
+	return DiscordResult_Ok;
+}
+
+// Images
+
+void FDiscordMockSdk::Image_Fetch(IDiscordImageManager* Manager, DiscordImageHandle Handle, bool bRefresh, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordImageHandle))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("Fetch"));
+	Mock->Schedule(Mock->GetLatency(), [Mock, Handle, CallbackData, Callback, Result]
+	{
+		if (Result == DiscordResult_Ok)
+		{
+			FScopeLock ScopeLock(&Mock->Lock);
+			Mock->FetchedImages.Add(MakeTuple(Handle.id, Handle.size));
+		}
+
+		Callback(CallbackData, Result, Handle);
+	});
+}
+
+EDiscordResult FDiscordMockSdk::Image_GetDimensions(IDiscordImageManager* Manager, DiscordImageHandle Handle, DiscordImageDimensions* OutDimensions)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetDimensions"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	if (!Get()->FetchedImages.Contains(MakeTuple(Handle.id, Handle.size))) return DiscordResult_NotFetched;
+
+	OutDimensions->width = Handle.size;
+	OutDimensions->height = Handle.size;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Image_GetData(IDiscordImageManager* Manager, DiscordImageHandle Handle, uint8_t* Data, uint32_t DataLength)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetData"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	if (!Get()->FetchedImages.Contains(MakeTuple(Handle.id, Handle.size))) return DiscordResult_NotFetched;
+	if (DataLength < Handle.size * Handle.size * 4) return DiscordResult_InsufficientBuffer;
+
+	// A flat color per user, so that avatars can be told apart
+	const uint32 Color = GetTypeHash(Handle.id) | 0xFF000000;
+	for (uint32 Pixel = 0; Pixel < Handle.size * Handle.size; Pixel++)
+	{
+		FMemory::Memcpy(Data + Pixel * 4, &Color, 4);
+	}
+	return DiscordResult_Ok;
+}
+
+// Achievements
+
+void FDiscordMockSdk::Achievement_SetUserAchievement(IDiscordAchievementManager* Manager, DiscordSnowflake AchievementID, uint8_t PercentComplete, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("SetUserAchievement"));
+	Mock->Schedule(Mock->GetLatency(), [Mock, AchievementID, PercentComplete, CallbackData, Callback, Result]
+	{
+		DiscordUserAchievement UserAchievement{};
+		if (Result == DiscordResult_Ok)
+		{
+			FScopeLock ScopeLock(&Mock->Lock);
+			DiscordUserAchievement& Stored = Mock->UserAchievements.FindOrAdd(AchievementID);
+			Stored.user_id = Mock->CurrentUser.id;
+			Stored.achievement_id = AchievementID;
+			Stored.percent_complete = PercentComplete;
+			if (PercentComplete >= 100 && Stored.unlocked_at[0] == '\0')
+			{
+				FCStringAnsi::Strncpy(Stored.unlocked_at, TCHAR_TO_UTF8(*FDateTime::UtcNow().ToIso8601()), sizeof(Stored.unlocked_at));
+			}
+			UserAchievement = Stored;
+		}
+
+		Callback(CallbackData, Result);
+
+		if (Result == DiscordResult_Ok && Mock->AchievementEvents && Mock->AchievementEvents->on_user_achievement_update)
+		{
+			Mock->AchievementEvents->on_user_achievement_update(Mock->EventData, &UserAchievement);
+		}
+	});
+}
+
+void FDiscordMockSdk::Achievement_FetchUserAchievements(IDiscordAchievementManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("FetchUserAchievements"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Achievement_CountUserAchievements(IDiscordAchievementManager* Manager, int32_t* OutCount)
+{
+	Get()->BeginCall(TEXT("CountUserAchievements"));
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*OutCount = Get()->UserAchievements.Num();
+}
+
+EDiscordResult FDiscordMockSdk::Achievement_GetUserAchievement(IDiscordAchievementManager* Manager, DiscordSnowflake UserAchievementID, DiscordUserAchievement* OutUserAchievement)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetUserAchievement"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const DiscordUserAchievement* UserAchievement = Get()->UserAchievements.Find(UserAchievementID);
+	if (!UserAchievement) return DiscordResult_NotFound;
+
+	*OutUserAchievement = *UserAchievement;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Achievement_GetUserAchievementAt(IDiscordAchievementManager* Manager, int32_t Index, DiscordUserAchievement* OutUserAchievement)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetUserAchievementAt"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	for (const TPair<DiscordSnowflake, DiscordUserAchievement>& UserAchievement : Get()->UserAchievements)
+	{
+		if (Index-- == 0)
+		{
+			*OutUserAchievement = UserAchievement.Value;
+			return DiscordResult_Ok;
+		}
+	}
+
+	return DiscordResult_NotFound;
+}
+
+// Store
+
+void FDiscordMockSdk::Store_FetchSkus(IDiscordStoreManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("FetchSkus"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Store_CountSkus(IDiscordStoreManager* Manager, int32_t* OutCount)
+{
+	Get()->BeginCall(TEXT("CountSkus"));
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*OutCount = Get()->Skus.Num();
+}
+
+EDiscordResult FDiscordMockSdk::Store_GetSku(IDiscordStoreManager* Manager, DiscordSnowflake SkuID, DiscordSku* OutSku)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetSku"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const DiscordSku* Sku = Get()->Skus.Find(SkuID);
+	if (!Sku) return DiscordResult_NotFound;
+
+	*OutSku = *Sku;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Store_GetSkuAt(IDiscordStoreManager* Manager, int32_t Index, DiscordSku* OutSku)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetSkuAt"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	for (const TPair<DiscordSnowflake, DiscordSku>& Sku : Get()->Skus)
+	{
+		if (Index-- == 0)
+		{
+			*OutSku = Sku.Value;
+			return DiscordResult_Ok;
+		}
+	}
+
+	return DiscordResult_NotFound;
+}
+
+void FDiscordMockSdk::Store_FetchEntitlements(IDiscordStoreManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("FetchEntitlements"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Store_CountEntitlements(IDiscordStoreManager* Manager, int32_t* OutCount)
+{
+	Get()->BeginCall(TEXT("CountEntitlements"));
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*OutCount = Get()->Entitlements.Num();
+}
+
+EDiscordResult FDiscordMockSdk::Store_GetEntitlement(IDiscordStoreManager* Manager, DiscordSnowflake EntitlementID, DiscordEntitlement* OutEntitlement)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetEntitlement"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	const DiscordEntitlement* Entitlement = Get()->Entitlements.Find(EntitlementID);
+	if (!Entitlement) return DiscordResult_NotFound;
+
+	*OutEntitlement = *Entitlement;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Store_GetEntitlementAt(IDiscordStoreManager* Manager, int32_t Index, DiscordEntitlement* OutEntitlement)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetEntitlementAt"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	for (const TPair<DiscordSnowflake, DiscordEntitlement>& Entitlement : Get()->Entitlements)
+	{
+		if (Index-- == 0)
+		{
+			*OutEntitlement = Entitlement.Value;
+			return DiscordResult_Ok;
+		}
+	}
+
+	return DiscordResult_NotFound;
+}
+
+EDiscordResult FDiscordMockSdk::Store_HasSkuEntitlement(IDiscordStoreManager* Manager, DiscordSnowflake SkuID, bool* bHasEntitlement)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("HasSkuEntitlement"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*bHasEntitlement = false;
+	for (const TPair<DiscordSnowflake, DiscordEntitlement>& Entitlement : Get()->Entitlements)
+	{
+		if (Entitlement.Value.sku_id == SkuID)
+		{
+			*bHasEntitlement = true;
+			break;
+		}
+	}
+
+	return DiscordResult_Ok;
+}
+
+void FDiscordMockSdk::Store_StartPurchase(IDiscordStoreManager* Manager, DiscordSnowflake SkuID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("StartPurchase"));
+	Mock->Schedule(Mock->GetLatency(), [Mock, SkuID, CallbackData, Callback, Result]
+	{
+		EDiscordResult PurchaseResult = Result;
+		DiscordEntitlement Entitlement{};
+		if (PurchaseResult == DiscordResult_Ok)
+		{
+			FScopeLock ScopeLock(&Mock->Lock);
+			if (Mock->Skus.Contains(SkuID))
+			{
+				Entitlement.id = Mock->NextEntitlementID++;
+				Entitlement.type = DiscordEntitlementType_Purchase;
+				Entitlement.sku_id = SkuID;
+				Mock->Entitlements.Add(Entitlement.id, Entitlement);
+			}
+			else
+			{
+				PurchaseResult = DiscordResult_NotFound;
+			}
+		}
+
+		Callback(CallbackData, PurchaseResult);
+
+		if (PurchaseResult == DiscordResult_Ok && Mock->StoreEvents && Mock->StoreEvents->on_entitlement_create)
+		{
+			Mock->StoreEvents->on_entitlement_create(Mock->EventData, &Entitlement);
+		}
+	});
+}
+
+// Voice
+
+EDiscordResult FDiscordMockSdk::Voice_GetInputMode(IDiscordVoiceManager* Manager, DiscordInputMode* OutInputMode)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetInputMode"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*OutInputMode = Get()->InputMode;
+	return DiscordResult_Ok;
+}
+
+void FDiscordMockSdk::Voice_SetInputMode(IDiscordVoiceManager* Manager, DiscordInputMode InputMode, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("SetInputMode"));
+	Mock->Schedule(Mock->GetLatency(), [Mock, InputMode, CallbackData, Callback, Result]
+	{
+		if (Result == DiscordResult_Ok)
+		{
+			FScopeLock ScopeLock(&Mock->Lock);
+			Mock->InputMode = InputMode;
+		}
+
+		Callback(CallbackData, Result);
+
+		if (Result == DiscordResult_Ok) Mock->ScheduleVoiceSettingsUpdate();
+	});
+}
+
+EDiscordResult FDiscordMockSdk::Voice_IsSelfMute(IDiscordVoiceManager* Manager, bool* bMute)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("IsSelfMute"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*bMute = Get()->bSelfMute;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Voice_SetSelfMute(IDiscordVoiceManager* Manager, bool bMute)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("SetSelfMute"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	{
+		FScopeLock ScopeLock(&Get()->Lock);
+		Get()->bSelfMute = bMute;
+	}
+
+	Get()->ScheduleVoiceSettingsUpdate();
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Voice_IsSelfDeaf(IDiscordVoiceManager* Manager, bool* bDeaf)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("IsSelfDeaf"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*bDeaf = Get()->bSelfDeaf;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Voice_SetSelfDeaf(IDiscordVoiceManager* Manager, bool bDeaf)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("SetSelfDeaf"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	{
+		FScopeLock ScopeLock(&Get()->Lock);
+		Get()->bSelfDeaf = bDeaf;
+	}
+
+	Get()->ScheduleVoiceSettingsUpdate();
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Voice_IsLocalMute(IDiscordVoiceManager* Manager, DiscordSnowflake UserID, bool* bMute)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("IsLocalMute"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*bMute = Get()->LocalVoiceSettings.FindRef(UserID).bMute;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Voice_SetLocalMute(IDiscordVoiceManager* Manager, DiscordSnowflake UserID, bool bMute)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("SetLocalMute"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	{
+		FScopeLock ScopeLock(&Get()->Lock);
+		Get()->LocalVoiceSettings.FindOrAdd(UserID).bMute = bMute;
+	}
+
+	Get()->ScheduleVoiceSettingsUpdate();
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Voice_GetLocalVolume(IDiscordVoiceManager* Manager, DiscordSnowflake UserID, uint8_t* OutVolume)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("GetLocalVolume"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*OutVolume = Get()->LocalVoiceSettings.FindRef(UserID).Volume;
+	return DiscordResult_Ok;
+}
+
+EDiscordResult FDiscordMockSdk::Voice_SetLocalVolume(IDiscordVoiceManager* Manager, DiscordSnowflake UserID, uint8_t Volume)
+{
+	const EDiscordResult Result = Get()->BeginCall(TEXT("SetLocalVolume"));
+	if (Result != DiscordResult_Ok) return Result;
+
+	{
+		FScopeLock ScopeLock(&Get()->Lock);
+		Get()->LocalVoiceSettings.FindOrAdd(UserID).Volume = Volume;
+	}
+
+	Get()->ScheduleVoiceSettingsUpdate();
+	return DiscordResult_Ok;
+}
+
+// Overlay
+
+void FDiscordMockSdk::Overlay_IsEnabled(IDiscordOverlayManager* Manager, bool* bEnabled)
+{
+	Get()->BeginCall(TEXT("IsEnabled"));
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*bEnabled = Get()->bOverlayEnabled;
+}
+
+void FDiscordMockSdk::Overlay_IsLocked(IDiscordOverlayManager* Manager, bool* bLocked)
+{
+	Get()->BeginCall(TEXT("IsLocked"));
+
+	FScopeLock ScopeLock(&Get()->Lock);
+	*bLocked = Get()->bOverlayLocked;
+}
+
+void FDiscordMockSdk::Overlay_SetLocked(IDiscordOverlayManager* Manager, bool bLocked, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	FDiscordMockSdk* Mock = Get();
+
+	const EDiscordResult Result = Mock->BeginCall(TEXT("SetLocked"));
+	Mock->Schedule(Mock->GetLatency(), [Mock, bLocked, CallbackData, Callback, Result]
+	{
+		bool bToggled = false;
+		if (Result == DiscordResult_Ok)
+		{
+			FScopeLock ScopeLock(&Mock->Lock);
+			bToggled = Mock->bOverlayLocked != bLocked;
+			Mock->bOverlayLocked = bLocked;
+		}
+
+		Callback(CallbackData, Result);
+
+		if (bToggled && Mock->OverlayEvents && Mock->OverlayEvents->on_toggle) Mock->OverlayEvents->on_toggle(Mock->EventData, bLocked);
+	});
+}
+
+void FDiscordMockSdk::Overlay_OpenActivityInvite(IDiscordOverlayManager* Manager, EDiscordActivityActionType Type, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("OpenActivityInvite"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Overlay_OpenGuildInvite(IDiscordOverlayManager* Manager, const char* Code, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("OpenGuildInvite"), CallbackData, Callback);
+}
+
+void FDiscordMockSdk::Overlay_OpenVoiceSettings(IDiscordOverlayManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult))
+{
+	Get()->ScheduleResult(TEXT("OpenVoiceSettings"), CallbackData, Callback);
+}
+
+#endif
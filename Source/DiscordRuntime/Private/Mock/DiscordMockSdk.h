@@ -0,0 +1,483 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DISCORD_MOCK_SDK
+
+#include "Discord/ffi.h"
+
+
+/**
+ * In-process stand-in for the Discord Game SDK, for running the plugin without a Discord client, e.g. in automation
+ * tests and benchmarks on CI. Select it by launching with `-DiscordMockSdk`.
+ *
+ * Implements the core, user, activity, relationship, lobby (including its networking), network, overlay, storage,
+ * image, achievement, store and voice vtables from `ffi.h`, with the storage kept in memory and avatars filled with a
+ * color picked from the user ID.
+ * Asynchronous calls answer on the pumping thread after a configurable latency, can be made to fail, and events can be
+ * fired at will. Network messages sent to the current user, or to the local peer, are looped back on the next flush.
+ * The other managers are not mocked, and their getters return nullptr. Everything is thread-safe.
+ */
+class FDiscordMockSdk final
+{
+public:
+	/**
+	 * Drop-in replacement for `DiscordCreate`.
+	 */
+	static EDiscordResult DISCORD_API Create(DiscordVersion Version, DiscordCreateParams* Params, IDiscordCore** OutCore);
+
+	/**
+	 * Returns the mock that is currently running, if any.
+	 */
+	static FDiscordMockSdk* Get();
+
+	/**
+	 * Delays the answers to asynchronous calls by Latency, plus a random amount of up to Jitter.
+	 */
+	void SetLatency(const double LatencySeconds, const double JitterSeconds = 0.0);
+
+	/**
+	 * Makes every call of an operation, such as `UpdateActivity`, return this result until cleared.
+	 */
+	void SetResult(const FName Operation, const EDiscordResult Result);
+
+	void ClearResult(const FName Operation);
+
+	/**
+	 * Makes a random share of the calls, from 0 to 1, fail with `InternalError`.
+	 */
+	void SetFailureRate(const float Rate);
+
+	void SetCurrentUser(const DiscordUser& User);
+
+	/**
+	 * Adds a user for `GetUser` to find.
+	 */
+	void AddUser(const DiscordUser& User);
+
+	/**
+	 * Adds or replaces the relationship with a user. Fires `OnRelationshipUpdate` on the next pump.
+	 */
+	void SetRelationship(const DiscordRelationship& Relationship);
+
+	/**
+	 * Adds a user to a lobby, as if they connected from another client. Fires `OnMemberConnect` on the next pump.
+	 */
+	void AddLobbyMember(const DiscordLobbyId LobbyID, const DiscordUser& User);
+
+	/**
+	 * Removes a user from a lobby. Fires `OnMemberDisconnect` on the next pump.
+	 */
+	void RemoveLobbyMember(const DiscordLobbyId LobbyID, const DiscordUserId UserID);
+
+	/**
+	 * Sets a member's metadata as if they updated it from another client. Fires `OnMemberUpdate` on the next pump.
+	 */
+	void SetLobbyMemberMetadata(const DiscordLobbyId LobbyID, const DiscordUserId UserID, const FString& Key, const FString& Value);
+
+	/**
+	 * Returns how many bytes were handed to `SendNetworkMessage` and to the network manager's `SendMessage`, including
+	 * the messages looped back.
+	 */
+	int64 GetNetworkBytesSent() const;
+
+	void SetOverlayEnabled(const bool bEnabled);
+
+	/**
+	 * Adds or replaces a file in the storage.
+	 */
+	void SetFile(const FString& Name, const TArray<uint8>& Data);
+
+	/**
+	 * Finds a file in the storage. Returns whether it was found.
+	 */
+	bool GetFile(const FString& Name, TArray<uint8>& OutData) const;
+
+	/**
+	 * Adds or replaces the current user's progress on an achievement. Fires `OnUserAchievementUpdate` on the next pump.
+	 */
+	void SetUserAchievement(const DiscordUserAchievement& UserAchievement);
+
+	/**
+	 * Adds or replaces a SKU for `FetchSkus` to find and `StartPurchase` to buy.
+	 */
+	void AddSku(const DiscordSku& Sku);
+
+	/**
+	 * Grants the current user an entitlement. Fires `OnEntitlementCreate` on the next pump.
+	 */
+	void AddEntitlement(const DiscordEntitlement& Entitlement);
+
+	/**
+	 * Takes an entitlement away from the current user, as if it was refunded. Fires `OnEntitlementDelete` on the next
+	 * pump.
+	 */
+	void RemoveEntitlement(const DiscordSnowflake EntitlementID);
+
+	/**
+	 * Mutes or deafens the current user, as if they did it from Discord. Fires `OnSettingsUpdate` on the next pump.
+	 */
+	void SetSelfVoiceSettings(const bool bMute, const bool bDeaf);
+
+	/**
+	 * Mutes another user or changes their volume, as if the current user did it from Discord. Fires `OnSettingsUpdate`
+	 * on the next pump.
+	 */
+	void SetLocalVoiceSettings(const DiscordUserId UserID, const bool bMute, const uint8 Volume);
+
+	/**
+	 * Returns how many times an operation was called.
+	 */
+	int32 GetNumCalls(const FName Operation) const;
+
+	/**
+	 * Returns the activity last set through `UpdateActivity`.
+	 */
+	DiscordActivity GetCurrentActivity() const;
+
+	// Events, delivered on the next pump like the real SDK does
+	void FireCurrentUserUpdate();
+	void FireActivityJoin(const char* Secret);
+	void FireActivityJoinRequest(const DiscordUser& User);
+	void FireActivityInvite(const EDiscordActivityActionType Type, const DiscordUser& User, const DiscordActivity& Activity);
+	void FireRelationshipRefresh();
+	void FireNetworkMessage(const DiscordLobbyId LobbyID, const DiscordUserId UserID, const uint8 ChannelID, const TArray<uint8>& Data);
+	void FirePeerMessage(const DiscordNetworkPeerId PeerID, const uint8 ChannelID, const TArray<uint8>& Data);
+	void FireRouteUpdate(const FString& Route);
+	void FireOverlayToggle(const bool bLocked);
+
+private:
+	explicit FDiscordMockSdk(const DiscordCreateParams& Params);
+
+	/**
+	 * Counts the call and picks its result.
+	 */
+	EDiscordResult BeginCall(const FName Operation);
+
+	/**
+	 * Queues an answer or an event for the pump, after the given delay.
+	 */
+	void Schedule(const double DelaySeconds, TUniqueFunction<void()>&& Callback);
+
+	/**
+	 * Counts the call, and answers it with its result after the configured latency.
+	 */
+	void ScheduleResult(const FName Operation, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+
+	double GetLatency() const;
+
+	void Log(const EDiscordLogLevel Level, const FString& Message) const;
+
+	EDiscordResult RunCallbacks();
+
+	// Vtables
+	static void DISCORD_API Core_Destroy(IDiscordCore* Core);
+	static EDiscordResult DISCORD_API Core_RunCallbacks(IDiscordCore* Core);
+	static void DISCORD_API Core_SetLogHook(IDiscordCore* Core, EDiscordLogLevel MinLevel, void* HookData, void (DISCORD_API *Hook)(void*, EDiscordLogLevel, const char*));
+	static IDiscordUserManager* DISCORD_API Core_GetUserManager(IDiscordCore* Core);
+	static IDiscordActivityManager* DISCORD_API Core_GetActivityManager(IDiscordCore* Core);
+	static IDiscordRelationshipManager* DISCORD_API Core_GetRelationshipManager(IDiscordCore* Core);
+	static IDiscordLobbyManager* DISCORD_API Core_GetLobbyManager(IDiscordCore* Core);
+	static IDiscordNetworkManager* DISCORD_API Core_GetNetworkManager(IDiscordCore* Core);
+	static IDiscordOverlayManager* DISCORD_API Core_GetOverlayManager(IDiscordCore* Core);
+	static IDiscordStorageManager* DISCORD_API Core_GetStorageManager(IDiscordCore* Core);
+	static IDiscordImageManager* DISCORD_API Core_GetImageManager(IDiscordCore* Core);
+	static IDiscordAchievementManager* DISCORD_API Core_GetAchievementManager(IDiscordCore* Core);
+	static IDiscordStoreManager* DISCORD_API Core_GetStoreManager(IDiscordCore* Core);
+	static IDiscordVoiceManager* DISCORD_API Core_GetVoiceManager(IDiscordCore* Core);
+
+	static EDiscordResult DISCORD_API User_GetCurrentUser(IDiscordUserManager* Manager, DiscordUser* CurrentUser);
+	static void DISCORD_API User_GetUser(IDiscordUserManager* Manager, DiscordUserId UserID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordUser*));
+	static EDiscordResult DISCORD_API User_GetCurrentUserPremiumType(IDiscordUserManager* Manager, EDiscordPremiumType* PremiumType);
+	static EDiscordResult DISCORD_API User_CurrentUserHasFlag(IDiscordUserManager* Manager, EDiscordUserFlag Flag, bool* bHasFlag);
+
+	static EDiscordResult DISCORD_API Activity_RegisterCommand(IDiscordActivityManager* Manager, const char* Command);
+	static EDiscordResult DISCORD_API Activity_RegisterSteam(IDiscordActivityManager* Manager, uint32_t SteamID);
+	static void DISCORD_API Activity_UpdateActivity(IDiscordActivityManager* Manager, DiscordActivity* Activity, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Activity_ClearActivity(IDiscordActivityManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Activity_SendRequestReply(IDiscordActivityManager* Manager, DiscordUserId UserID, EDiscordActivityJoinRequestReply Reply, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Activity_SendInvite(IDiscordActivityManager* Manager, DiscordUserId UserID, EDiscordActivityActionType Type, const char* Content, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Activity_AcceptInvite(IDiscordActivityManager* Manager, DiscordUserId UserID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+
+	static void DISCORD_API Relationship_Filter(IDiscordRelationshipManager* Manager, void* FilterData, bool (DISCORD_API *Filter)(void*, DiscordRelationship*));
+	static EDiscordResult DISCORD_API Relationship_Count(IDiscordRelationshipManager* Manager, int32_t* Count);
+	static EDiscordResult DISCORD_API Relationship_Get(IDiscordRelationshipManager* Manager, DiscordUserId UserID, DiscordRelationship* OutRelationship);
+	static EDiscordResult DISCORD_API Relationship_GetAt(IDiscordRelationshipManager* Manager, uint32_t Index, DiscordRelationship* OutRelationship);
+
+	static EDiscordResult DISCORD_API Lobby_GetLobbyCreateTransaction(IDiscordLobbyManager* Manager, IDiscordLobbyTransaction** OutTransaction);
+	static EDiscordResult DISCORD_API Lobby_GetLobbyUpdateTransaction(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, IDiscordLobbyTransaction** OutTransaction);
+	static EDiscordResult DISCORD_API Lobby_GetMemberUpdateTransaction(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, IDiscordLobbyMemberTransaction** OutTransaction);
+	static void DISCORD_API Lobby_CreateLobby(IDiscordLobbyManager* Manager, IDiscordLobbyTransaction* Transaction, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*));
+	static void DISCORD_API Lobby_UpdateLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, IDiscordLobbyTransaction* Transaction, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Lobby_DeleteLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Lobby_ConnectLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, char* Secret, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*));
+	static void DISCORD_API Lobby_ConnectLobbyWithActivitySecret(IDiscordLobbyManager* Manager, char* ActivitySecret, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*));
+	static void DISCORD_API Lobby_DisconnectLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static EDiscordResult DISCORD_API Lobby_GetLobby(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordLobby* OutLobby);
+	static EDiscordResult DISCORD_API Lobby_GetLobbyActivitySecret(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordLobbySecret* OutSecret);
+	static EDiscordResult DISCORD_API Lobby_GetLobbyMetadataValue(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, char* Key, DiscordMetadataValue* OutValue);
+	static EDiscordResult DISCORD_API Lobby_GetLobbyMetadataKey(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, int32_t Index, DiscordMetadataKey* OutKey);
+	static EDiscordResult DISCORD_API Lobby_LobbyMetadataCount(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, int32_t* OutCount);
+	static EDiscordResult DISCORD_API Lobby_MemberCount(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, int32_t* OutCount);
+	static EDiscordResult DISCORD_API Lobby_GetMemberUserId(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, int32_t Index, DiscordUserId* OutUserID);
+	static EDiscordResult DISCORD_API Lobby_GetMemberUser(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, DiscordUser* OutUser);
+	static EDiscordResult DISCORD_API Lobby_GetMemberMetadataValue(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, char* Key, DiscordMetadataValue* OutValue);
+	static EDiscordResult DISCORD_API Lobby_GetMemberMetadataKey(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, int32_t Index, DiscordMetadataKey* OutKey);
+	static EDiscordResult DISCORD_API Lobby_MemberMetadataCount(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, int32_t* OutCount);
+	static void DISCORD_API Lobby_UpdateMember(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, IDiscordLobbyMemberTransaction* Transaction, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+
+	static EDiscordResult DISCORD_API Lobby_ConnectNetwork(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID);
+	static EDiscordResult DISCORD_API Lobby_DisconnectNetwork(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID);
+	static EDiscordResult DISCORD_API Lobby_FlushNetwork(IDiscordLobbyManager* Manager);
+	static EDiscordResult DISCORD_API Lobby_OpenNetworkChannel(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, uint8_t ChannelID, bool bReliable);
+	static EDiscordResult DISCORD_API Lobby_SendNetworkMessage(IDiscordLobbyManager* Manager, DiscordLobbyId LobbyID, DiscordUserId UserID, uint8_t ChannelID, uint8_t* Data, uint32_t DataLength);
+
+	static void DISCORD_API Network_GetPeerId(IDiscordNetworkManager* Manager, DiscordNetworkPeerId* OutPeerID);
+	static EDiscordResult DISCORD_API Network_Flush(IDiscordNetworkManager* Manager);
+	static EDiscordResult DISCORD_API Network_OpenPeer(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, const char* RouteData);
+	static EDiscordResult DISCORD_API Network_UpdatePeer(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, const char* RouteData);
+	static EDiscordResult DISCORD_API Network_ClosePeer(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID);
+	static EDiscordResult DISCORD_API Network_OpenChannel(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, DiscordNetworkChannelId ChannelID, bool bReliable);
+	static EDiscordResult DISCORD_API Network_CloseChannel(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, DiscordNetworkChannelId ChannelID);
+	static EDiscordResult DISCORD_API Network_SendMessage(IDiscordNetworkManager* Manager, DiscordNetworkPeerId PeerID, DiscordNetworkChannelId ChannelID, uint8_t* Data, uint32_t DataLength);
+
+	static EDiscordResult DISCORD_API LobbyTransaction_SetType(IDiscordLobbyTransaction* Transaction, EDiscordLobbyType Type);
+	static EDiscordResult DISCORD_API LobbyTransaction_SetOwner(IDiscordLobbyTransaction* Transaction, DiscordUserId OwnerID);
+	static EDiscordResult DISCORD_API LobbyTransaction_SetCapacity(IDiscordLobbyTransaction* Transaction, uint32_t Capacity);
+	static EDiscordResult DISCORD_API LobbyTransaction_SetMetadata(IDiscordLobbyTransaction* Transaction, char* Key, char* Value);
+	static EDiscordResult DISCORD_API LobbyTransaction_DeleteMetadata(IDiscordLobbyTransaction* Transaction, char* Key);
+	static EDiscordResult DISCORD_API LobbyTransaction_SetLocked(IDiscordLobbyTransaction* Transaction, bool bLocked);
+	static EDiscordResult DISCORD_API MemberTransaction_SetMetadata(IDiscordLobbyMemberTransaction* Transaction, char* Key, char* Value);
+	static EDiscordResult DISCORD_API MemberTransaction_DeleteMetadata(IDiscordLobbyMemberTransaction* Transaction, char* Key);
+
+	static EDiscordResult DISCORD_API Storage_Read(IDiscordStorageManager* Manager, const char* Name, uint8_t* Data, uint32_t DataLength, uint32_t* OutRead);
+	static void DISCORD_API Storage_ReadAsync(IDiscordStorageManager* Manager, const char* Name, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, uint8_t*, uint32_t));
+	static void DISCORD_API Storage_ReadAsyncPartial(IDiscordStorageManager* Manager, const char* Name, uint64_t Offset, uint64_t Length, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, uint8_t*, uint32_t));
+	static EDiscordResult DISCORD_API Storage_Write(IDiscordStorageManager* Manager, const char* Name, uint8_t* Data, uint32_t DataLength);
+	static void DISCORD_API Storage_WriteAsync(IDiscordStorageManager* Manager, const char* Name, uint8_t* Data, uint32_t DataLength, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static EDiscordResult DISCORD_API Storage_Delete(IDiscordStorageManager* Manager, const char* Name);
+	static EDiscordResult DISCORD_API Storage_Exists(IDiscordStorageManager* Manager, const char* Name, bool* bOutExists);
+	static void DISCORD_API Storage_Count(IDiscordStorageManager* Manager, int32_t* OutCount);
+	static EDiscordResult DISCORD_API Storage_Stat(IDiscordStorageManager* Manager, const char* Name, DiscordFileStat* OutStat);
+	static EDiscordResult DISCORD_API Storage_StatAt(IDiscordStorageManager* Manager, int32_t Index, DiscordFileStat* OutStat);
+	static EDiscordResult DISCORD_API Storage_GetPath(IDiscordStorageManager* Manager, DiscordPath* OutPath);
+
+	static void DISCORD_API Image_Fetch(IDiscordImageManager* Manager, DiscordImageHandle Handle, bool bRefresh, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordImageHandle));
+	static EDiscordResult DISCORD_API Image_GetDimensions(IDiscordImageManager* Manager, DiscordImageHandle Handle, DiscordImageDimensions* OutDimensions);
+	static EDiscordResult DISCORD_API Image_GetData(IDiscordImageManager* Manager, DiscordImageHandle Handle, uint8_t* Data, uint32_t DataLength);
+
+	static void DISCORD_API Achievement_SetUserAchievement(IDiscordAchievementManager* Manager, DiscordSnowflake AchievementID, uint8_t PercentComplete, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Achievement_FetchUserAchievements(IDiscordAchievementManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Achievement_CountUserAchievements(IDiscordAchievementManager* Manager, int32_t* OutCount);
+	static EDiscordResult DISCORD_API Achievement_GetUserAchievement(IDiscordAchievementManager* Manager, DiscordSnowflake UserAchievementID, DiscordUserAchievement* OutUserAchievement);
+	static EDiscordResult DISCORD_API Achievement_GetUserAchievementAt(IDiscordAchievementManager* Manager, int32_t Index, DiscordUserAchievement* OutUserAchievement);
+
+	static void DISCORD_API Store_FetchSkus(IDiscordStoreManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Store_CountSkus(IDiscordStoreManager* Manager, int32_t* OutCount);
+	static EDiscordResult DISCORD_API Store_GetSku(IDiscordStoreManager* Manager, DiscordSnowflake SkuID, DiscordSku* OutSku);
+	static EDiscordResult DISCORD_API Store_GetSkuAt(IDiscordStoreManager* Manager, int32_t Index, DiscordSku* OutSku);
+	static void DISCORD_API Store_FetchEntitlements(IDiscordStoreManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Store_CountEntitlements(IDiscordStoreManager* Manager, int32_t* OutCount);
+	static EDiscordResult DISCORD_API Store_GetEntitlement(IDiscordStoreManager* Manager, DiscordSnowflake EntitlementID, DiscordEntitlement* OutEntitlement);
+	static EDiscordResult DISCORD_API Store_GetEntitlementAt(IDiscordStoreManager* Manager, int32_t Index, DiscordEntitlement* OutEntitlement);
+	static EDiscordResult DISCORD_API Store_HasSkuEntitlement(IDiscordStoreManager* Manager, DiscordSnowflake SkuID, bool* bHasEntitlement);
+	static void DISCORD_API Store_StartPurchase(IDiscordStoreManager* Manager, DiscordSnowflake SkuID, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+
+	static EDiscordResult DISCORD_API Voice_GetInputMode(IDiscordVoiceManager* Manager, DiscordInputMode* OutInputMode);
+	static void DISCORD_API Voice_SetInputMode(IDiscordVoiceManager* Manager, DiscordInputMode InputMode, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static EDiscordResult DISCORD_API Voice_IsSelfMute(IDiscordVoiceManager* Manager, bool* bMute);
+	static EDiscordResult DISCORD_API Voice_SetSelfMute(IDiscordVoiceManager* Manager, bool bMute);
+	static EDiscordResult DISCORD_API Voice_IsSelfDeaf(IDiscordVoiceManager* Manager, bool* bDeaf);
+	static EDiscordResult DISCORD_API Voice_SetSelfDeaf(IDiscordVoiceManager* Manager, bool bDeaf);
+	static EDiscordResult DISCORD_API Voice_IsLocalMute(IDiscordVoiceManager* Manager, DiscordSnowflake UserID, bool* bMute);
+	static EDiscordResult DISCORD_API Voice_SetLocalMute(IDiscordVoiceManager* Manager, DiscordSnowflake UserID, bool bMute);
+	static EDiscordResult DISCORD_API Voice_GetLocalVolume(IDiscordVoiceManager* Manager, DiscordSnowflake UserID, uint8_t* OutVolume);
+	static EDiscordResult DISCORD_API Voice_SetLocalVolume(IDiscordVoiceManager* Manager, DiscordSnowflake UserID, uint8_t Volume);
+
+	static void DISCORD_API Overlay_IsEnabled(IDiscordOverlayManager* Manager, bool* bEnabled);
+	static void DISCORD_API Overlay_IsLocked(IDiscordOverlayManager* Manager, bool* bLocked);
+	static void DISCORD_API Overlay_SetLocked(IDiscordOverlayManager* Manager, bool bLocked, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Overlay_OpenActivityInvite(IDiscordOverlayManager* Manager, EDiscordActivityActionType Type, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Overlay_OpenGuildInvite(IDiscordOverlayManager* Manager, const char* Code, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+	static void DISCORD_API Overlay_OpenVoiceSettings(IDiscordOverlayManager* Manager, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult));
+
+private:
+	// Metadata entries are set, or deleted when unset
+	using FMetadataChanges = TMap<FString, TOptional<FString>>;
+
+	struct FLobbyTransaction
+	{
+		// Must come first, since the SDK only hands back a pointer to it
+		IDiscordLobbyTransaction Vtable{};
+		TOptional<EDiscordLobbyType> Type;
+		TOptional<DiscordUserId> OwnerID;
+		TOptional<uint32> Capacity;
+		TOptional<bool> bLocked;
+		FMetadataChanges Metadata;
+	};
+
+	struct FMemberTransaction
+	{
+		IDiscordLobbyMemberTransaction Vtable{};
+		FMetadataChanges Metadata;
+	};
+
+	struct FLobbyMember
+	{
+		DiscordUser User{};
+		TMap<FString, FString> Metadata;
+	};
+
+	struct FLobby
+	{
+		DiscordLobby Lobby{};
+		TMap<FString, FString> Metadata;
+		TMap<DiscordUserId, FLobbyMember> Members;
+		bool bConnected = false;
+		bool bNetworkConnected = false;
+		TSet<uint8> NetworkChannels;
+	};
+
+	/** A message sent to the current user, delivered back by the next `FlushNetwork`. */
+	struct FNetworkMessage
+	{
+		DiscordLobbyId LobbyID;
+		uint8 ChannelID;
+		TArray<uint8> Data;
+	};
+
+	/** A peer opened with its route, and the channels opened to it. */
+	struct FNetworkPeer
+	{
+		FString Route;
+		TSet<uint8> Channels;
+	};
+
+	/** A message sent to the local peer, delivered back by the next `Flush`. */
+	struct FPeerMessage
+	{
+		DiscordNetworkPeerId PeerID;
+		uint8 ChannelID;
+		TArray<uint8> Data;
+	};
+
+	struct FStoredFile
+	{
+		TArray<uint8> Data;
+		uint64 LastModified = 0;
+	};
+
+	/**
+	 * Fills the stat of a stored file. Must be called with the lock held.
+	 */
+	static void FillFileStat(const FString& Name, const FStoredFile& File, DiscordFileStat& OutStat);
+
+	/**
+	 * Answers a read of part of a stored file, after the configured latency.
+	 */
+	void ScheduleFileRead(const FName Operation, const char* Name, const uint64 Offset, const uint64 Length, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, uint8_t*, uint32_t));
+
+	/** The voice settings the current user picked for another user. */
+	struct FLocalVoiceSettings
+	{
+		bool bMute = false;
+		uint8 Volume = 100;
+	};
+
+	/**
+	 * Fires `OnSettingsUpdate` on the next pump, like Discord does after any voice setting changed.
+	 */
+	void ScheduleVoiceSettingsUpdate();
+
+	/**
+	 * Transactions are freed by the call they're passed to, like in the real SDK.
+	 */
+	static IDiscordLobbyTransaction* CreateLobbyTransaction();
+
+	static void ApplyMetadataChanges(const FMetadataChanges& Changes, TMap<FString, FString>& Metadata);
+
+	/**
+	 * Answers a call that hands a lobby back, after the configured latency.
+	 */
+	void ScheduleLobbyResult(EDiscordResult Result, const DiscordLobby& Lobby, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*));
+
+	/**
+	 * Connects the current user to a lobby and answers the call. Must be called with the lock held.
+	 */
+	void ConnectToLobby(FLobby& Lobby, void* CallbackData, void (DISCORD_API *Callback)(void*, EDiscordResult, DiscordLobby*));
+
+	struct FScheduledCallback
+	{
+		double DueTime;
+		uint64 Sequence;
+		TUniqueFunction<void()> Callback;
+	};
+
+	IDiscordCore CoreVtable{};
+	IDiscordUserManager UserVtable{};
+	IDiscordActivityManager ActivityVtable{};
+	IDiscordRelationshipManager RelationshipVtable{};
+	IDiscordLobbyManager LobbyVtable{};
+	IDiscordNetworkManager NetworkVtable{};
+	IDiscordOverlayManager OverlayVtable{};
+	IDiscordStorageManager StorageVtable{};
+	IDiscordImageManager ImageVtable{};
+	IDiscordAchievementManager AchievementVtable{};
+	IDiscordStoreManager StoreVtable{};
+	IDiscordVoiceManager VoiceVtable{};
+
+	void* EventData;
+	IDiscordUserEvents* UserEvents;
+	IDiscordActivityEvents* ActivityEvents;
+	IDiscordRelationshipEvents* RelationshipEvents;
+	IDiscordLobbyEvents* LobbyEvents;
+	IDiscordNetworkEvents* NetworkEvents;
+	IDiscordOverlayEvents* OverlayEvents;
+	IDiscordAchievementEvents* AchievementEvents;
+	IDiscordStoreEvents* StoreEvents;
+	IDiscordVoiceEvents* VoiceEvents;
+
+	void* LogHookData = nullptr;
+	void (DISCORD_API *LogHook)(void*, EDiscordLogLevel, const char*) = nullptr;
+	EDiscordLogLevel LogMinLevel = DiscordLogLevel_Error;
+
+	mutable FCriticalSection Lock;
+
+	TArray<FScheduledCallback> ScheduledCallbacks;
+	uint64 NextSequence = 0;
+
+	double Latency = 0.0;
+	double Jitter = 0.0;
+	float FailureRate = 0.f;
+	TMap<FName, EDiscordResult> ForcedResults;
+	TMap<FName, int32> NumCalls;
+
+	DiscordUser CurrentUser{};
+	TMap<DiscordUserId, DiscordUser> Users;
+	DiscordActivity CurrentActivity{};
+	TMap<DiscordUserId, DiscordRelationship> Relationships;
+	TArray<DiscordRelationship> FilteredRelationships;
+	TMap<DiscordLobbyId, FLobby> Lobbies;
+	DiscordLobbyId NextLobbyID = 1000;
+	TArray<FNetworkMessage> LoopbackMessages;
+	int64 NetworkBytesSent = 0;
+	DiscordNetworkPeerId LocalPeerID = 0x1000;
+	TMap<DiscordNetworkPeerId, FNetworkPeer> Peers;
+	TArray<FPeerMessage> PeerLoopbackMessages;
+	bool bOverlayEnabled = true;
+	bool bOverlayLocked = true;
+	TMap<FString, FStoredFile> Files;
+	TSet<TPair<DiscordUserId, uint32>> FetchedImages;
+	TMap<DiscordSnowflake, DiscordUserAchievement> UserAchievements;
+	TMap<DiscordSnowflake, DiscordSku> Skus;
+	TMap<DiscordSnowflake, DiscordEntitlement> Entitlements;
+	DiscordSnowflake NextEntitlementID = 5000;
+	bool bSelfMute = false;
+	bool bSelfDeaf = false;
+	DiscordInputMode InputMode{};
+	TMap<DiscordUserId, FLocalVoiceSettings> LocalVoiceSettings;
+};
+
+#endif
@@ -0,0 +1,36 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordInternetAddr.h"
+
+
+const FName FDiscordInternetAddr::ProtocolType(TEXT("Discord"));
+
+uint64 FDiscordInternetAddr::ParsePeerID(const FString& String)
+{
+	return String.StartsWith(TEXT("-")) ? static_cast<uint64>(FCString::Atoi64(*String)) : FCString::Strtoui64(*String, nullptr, 10);
+}
+
+void FDiscordInternetAddr::SetIp(const TCHAR* InAddr, bool& bIsValid)
+{
+	PeerID = ParsePeerID(InAddr);
+	bIsValid = PeerID != 0;
+}
+
+void FDiscordInternetAddr::SetRawIp(const TArray<uint8>& RawAddr)
+{
+	PeerID = 0;
+	if (RawAddr.Num() == sizeof(PeerID))
+	{
+		FMemory::Memcpy(&PeerID, RawAddr.GetData(), sizeof(PeerID));
+	}
+}
+
+TArray<uint8> FDiscordInternetAddr::GetRawIp() const
+{
+	return TArray<uint8>(reinterpret_cast<const uint8*>(&PeerID), sizeof(PeerID));
+}
+
+bool FDiscordInternetAddr::operator==(const FInternetAddr& Other) const
+{
+	return Other.GetProtocolType() == ProtocolType && static_cast<const FDiscordInternetAddr&>(Other).PeerID == PeerID;
+}
@@ -0,0 +1,49 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "IPAddress.h"
+
+
+/**
+ * Address of a Discord peer, so that the engine can tell connections apart by peer ID. There is no IP or port behind
+ * it, everything goes through Discord's relays.
+ */
+class FDiscordInternetAddr final : public FInternetAddr
+{
+public:
+	static const FName ProtocolType;
+
+	explicit FDiscordInternetAddr(const uint64 InPeerID = 0) : PeerID(InPeerID) {}
+
+	uint64 GetPeerID() const { return PeerID; }
+
+	void SetPeerID(const uint64 InPeerID) { PeerID = InPeerID; }
+
+	/**
+	 * Reads a peer ID as written by `ToString`, or as a signed integer like Blueprints hand it out.
+	 */
+	static uint64 ParsePeerID(const FString& String);
+
+	// Begin FInternetAddr interface
+	virtual void SetIp(uint32 InAddr) override {}
+	virtual void SetIp(const TCHAR* InAddr, bool& bIsValid) override;
+	virtual void GetIp(uint32& OutAddr) const override { OutAddr = 0; }
+	virtual void SetPort(int32 InPort) override {}
+	virtual int32 GetPort() const override { return 0; }
+	virtual void SetRawIp(const TArray<uint8>& RawAddr) override;
+	virtual TArray<uint8> GetRawIp() const override;
+	virtual void SetAnyAddress() override { PeerID = 0; }
+	virtual void SetBroadcastAddress() override { PeerID = 0; }
+	virtual void SetLoopbackAddress() override { PeerID = 0; }
+	virtual FString ToString(bool bAppendPort) const override { return FString::Printf(TEXT("%llu"), PeerID); }
+	virtual bool operator==(const FInternetAddr& Other) const override;
+	virtual uint32 GetTypeHash() const override { return ::GetTypeHash(PeerID); }
+	virtual bool IsValid() const override { return PeerID != 0; }
+	virtual TSharedRef<FInternetAddr> Clone() const override { return MakeShared<FDiscordInternetAddr>(PeerID); }
+	virtual FName GetProtocolType() const override { return ProtocolType; }
+	// End FInternetAddr interface
+
+private:
+	uint64 PeerID;
+};
@@ -0,0 +1,81 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Networking/DiscordNetConnection.h"
+
+#include "DiscordInternetAddr.h"
+#include "Net/DataChannel.h"
+#include "Networking/DiscordNetDriver.h"
+#include "PacketHandler.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordNetConnection)
+
+
+void UDiscordNetConnection::InitBase(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, EConnectionState InState, int32 InMaxPacket, int32 InPacketOverhead)
+{
+	// Packets are batched into messages, so they can't be larger than one
+	const UDiscordNetDriver* DiscordDriver = CastChecked<UDiscordNetDriver>(InDriver);
+	Super::InitBase(InDriver, InSocket, InURL, InState,
+		InMaxPacket == 0 ? DiscordDriver->GetMaxPacketSize() : InMaxPacket,
+		InPacketOverhead == 0 ? UDiscordNetDriver::PacketHeaderSize : InPacketOverhead);
+
+	InitSendBuffer();
+}
+
+void UDiscordNetConnection::InitRemoteConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, const FInternetAddr& InRemoteAddr, EConnectionState InState, int32 InMaxPacket, int32 InPacketOverhead)
+{
+	InitBase(InDriver, InSocket, InURL, InState, InMaxPacket, InPacketOverhead);
+
+	check(InRemoteAddr.GetProtocolType() == FDiscordInternetAddr::ProtocolType);
+	PeerID = static_cast<const FDiscordInternetAddr&>(InRemoteAddr).GetPeerID();
+	RemoteAddr = InRemoteAddr.Clone();
+	URL.Host = RemoteAddr->ToString(false);
+
+	// The client speaks first
+	SetClientLoginState(EClientLoginState::LoggingIn);
+	SetExpectedClientLoginMsgType(NMT_Hello);
+}
+
+void UDiscordNetConnection::InitLocalConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, EConnectionState InState, int32 InMaxPacket, int32 InPacketOverhead)
+{
+	InitBase(InDriver, InSocket, InURL, InState, InMaxPacket, InPacketOverhead);
+
+	PeerID = FDiscordInternetAddr::ParsePeerID(InURL.Host);
+	RemoteAddr = MakeShared<FDiscordInternetAddr>(PeerID);
+}
+
+void UDiscordNetConnection::LowLevelSend(void* Data, int32 CountBits, FOutPacketTraits& Traits)
+{
+	uint8* DataToSend = static_cast<uint8*>(Data);
+	if (Handler.IsValid() && !Handler->GetRawSend())
+	{
+		const ProcessedPacket ProcessedData = Handler->Outgoing(DataToSend, CountBits, Traits);
+		if (ProcessedData.bError) return;
+
+		DataToSend = ProcessedData.Data;
+		CountBits = ProcessedData.CountBits;
+	}
+
+	if (UDiscordNetDriver* DiscordDriver = Cast<UDiscordNetDriver>(Driver))
+	{
+		DiscordDriver->QueuePacket(PeerID, DataToSend, FMath::DivideAndRoundUp(CountBits, 8));
+	}
+}
+
+FString UDiscordNetConnection::LowLevelGetRemoteAddress(bool bAppendPort)
+{
+	return FString::Printf(TEXT("%llu"), PeerID);
+}
+
+FString UDiscordNetConnection::LowLevelDescribe()
+{
+	const TCHAR* StateName = TEXT("Invalid");
+	switch (GetConnectionState())
+	{
+	case USOCK_Pending: StateName = TEXT("Pending"); break;
+	case USOCK_Open: StateName = TEXT("Open"); break;
+	case USOCK_Closed: StateName = TEXT("Closed"); break;
+	default: break;
+	}
+
+	return FString::Printf(TEXT("peer=%llu state: %s"), PeerID, StateName);
+}
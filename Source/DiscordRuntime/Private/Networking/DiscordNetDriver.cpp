@@ -0,0 +1,359 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Networking/DiscordNetDriver.h"
+
+#include "DiscordBufferPool.h"
+#include "DiscordInternetAddr.h"
+#include "DiscordLogChannel.h"
+#include "DiscordNetReceiveBuffer.h"
+#include "DiscordRuntime.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "PacketHandler.h"
+#include "PacketHandlers/StatelessConnectHandlerComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordNetDriver)
+
+
+/** Message buffers kept for reuse between net ticks. */
+static constexpr int32 MaxPooledMessages = 64;
+
+
+UDiscordNetDriver::UDiscordNetDriver(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	NetConnectionClassName = TEXT("/Script/DiscordRuntime.DiscordNetConnection");
+}
+
+bool UDiscordNetDriver::IsAvailable() const
+{
+	return FDiscordRuntimeModule::Get().IsSdkAvailable();
+}
+
+bool UDiscordNetDriver::InitBase(bool bInitAsClient, FNetworkNotify* InNotify, const FURL& URL, bool bReuseAddressAndPort, FString& Error)
+{
+	if (!Super::InitBase(bInitAsClient, InNotify, URL, bReuseAddressAndPort, Error)) return false;
+
+	UDiscordSubsystem* DiscordSubsystem = FindDiscordSubsystem();
+	if (!DiscordSubsystem || !DiscordSubsystem->IsActive())
+	{
+		Error = TEXT("Discord isn't running");
+		return false;
+	}
+
+	NetworkManager = DiscordSubsystem->GetNetworkManager();
+	LocalPeerID = static_cast<uint64>(NetworkManager->GetPeerID());
+
+	ReceiveBuffer = MakeShared<FDiscordNetReceiveBuffer, ESPMode::ThreadSafe>(ReceiveBufferSize);
+	BufferPool = MakeShared<FDiscordBufferPool, ESPMode::ThreadSafe>(MaxPooledMessages, MaxMessageSize);
+	LookupAddress = MakeShared<FDiscordInternetAddr>();
+
+	// Runs on the pumping thread, which only copies the message in for the next TickDispatch
+	MessageHandle = NetworkManager->AddMessageHandler(FOnDiscordNetworkMessageNative::FDelegate::CreateLambda(
+		[Buffer = ReceiveBuffer, ChannelID = DiscordChannelID](const uint64 PeerID, const uint8 MessageChannelID, const TArrayView<const uint8> Data)
+	{
+		if (MessageChannelID == ChannelID) Buffer->Push(PeerID, Data);
+	}));
+
+	return true;
+}
+
+bool UDiscordNetDriver::InitConnect(FNetworkNotify* InNotify, const FURL& ConnectURL, FString& Error)
+{
+	if (!InitBase(true, InNotify, ConnectURL, false, Error)) return false;
+
+	ServerPeerID = FDiscordInternetAddr::ParsePeerID(ConnectURL.Host);
+	if (ServerPeerID == 0)
+	{
+		Error = FString::Printf(TEXT("%s isn't a Discord peer ID"), *ConnectURL.Host);
+		return false;
+	}
+
+	if (!OpenChannelTo(ServerPeerID))
+	{
+		Error = FString::Printf(TEXT("Couldn't open a channel to peer %llu. It must be opened with its route first"), ServerPeerID);
+		return false;
+	}
+
+	ServerConnection = NewObject<UNetConnection>(GetTransientPackage(), NetConnectionClass);
+	ServerConnection->InitLocalConnection(this, nullptr, ConnectURL, USOCK_Pending);
+	CreateInitialClientChannels();
+
+	LOG_DISCORD(Log, "Connecting to peer {ServerPeerID} as peer {PeerID}", ServerPeerID, LocalPeerID);
+	return true;
+}
+
+bool UDiscordNetDriver::InitListen(FNetworkNotify* InNotify, FURL& ListenURL, bool bReuseAddressAndPort, FString& Error)
+{
+	if (!InitBase(false, InNotify, ListenURL, bReuseAddressAndPort, Error)) return false;
+
+	InitConnectionlessHandler();
+
+	LOG_DISCORD(Log, "Listening as peer {PeerID}", LocalPeerID);
+	return true;
+}
+
+void UDiscordNetDriver::TickDispatch(float DeltaTime)
+{
+	Super::TickDispatch(DeltaTime);
+
+	if (!ReceiveBuffer) return;
+
+	DISCORD_SCOPE_CYCLE_COUNTER(NetDriver_TickDispatch);
+
+	uint64 PeerID = 0;
+	while (ReceiveBuffer->Pop(PeerID, ReceivedMessage))
+	{
+		ReceiveMessage(PeerID, ReceivedMessage);
+	}
+
+	const int32 NumDropped = ReceiveBuffer->GetNumDropped();
+	if (NumDropped != LastNumDropped)
+	{
+		LOG_DISCORD(Warning, "Dropped {NumDropped} received messages because the receive buffer was full. Consider raising ReceiveBufferSize", NumDropped - LastNumDropped);
+		LastNumDropped = NumDropped;
+	}
+}
+
+void UDiscordNetDriver::TickFlush(float DeltaSeconds)
+{
+	Super::TickFlush(DeltaSeconds);
+
+	SendQueuedMessages();
+}
+
+void UDiscordNetDriver::LowLevelSend(TSharedPtr<const FInternetAddr> Address, void* Data, int32 CountBits, FOutPacketTraits& Traits)
+{
+	if (!Address.IsValid() || Address->GetProtocolType() != FDiscordInternetAddr::ProtocolType) return;
+
+	uint8* DataToSend = static_cast<uint8*>(Data);
+	if (ConnectionlessHandler.IsValid())
+	{
+		const ProcessedPacket ProcessedData = ConnectionlessHandler->OutgoingConnectionless(Address, DataToSend, CountBits, Traits);
+		if (ProcessedData.bError) return;
+
+		DataToSend = ProcessedData.Data;
+		CountBits = ProcessedData.CountBits;
+	}
+
+	QueuePacket(static_cast<const FDiscordInternetAddr&>(*Address).GetPeerID(), DataToSend, FMath::DivideAndRoundUp(CountBits, 8));
+}
+
+FString UDiscordNetDriver::LowLevelGetNetworkNumber()
+{
+	return FString::Printf(TEXT("%llu"), LocalPeerID);
+}
+
+void UDiscordNetDriver::LowLevelDestroy()
+{
+	// What the connections sent while closing still goes out, before the channels are closed
+	SendQueuedMessages();
+
+	if (NetworkManager.IsValid())
+	{
+		NetworkManager->RemoveMessageHandler(MessageHandle);
+
+		for (const uint64 PeerID : OpenChannels)
+		{
+			NetworkManager->CloseChannelAfterSends(PeerID, DiscordChannelID);
+		}
+	}
+
+	MessageHandle.Reset();
+	OpenChannels.Reset();
+
+	Super::LowLevelDestroy();
+}
+
+bool UDiscordNetDriver::IsNetResourceValid()
+{
+	return NetworkManager.IsValid() && MessageHandle.IsValid();
+}
+
+void UDiscordNetDriver::QueuePacket(const uint64 PeerID, const uint8* Data, const int32 Count)
+{
+	if (Count <= 0) return;
+
+	if (Count > MAX_uint16)
+	{
+		LOG_DISCORD(Error, "Can't send a packet of {Count} bytes to peer {PeerID}, it's too large", Count, PeerID);
+		return;
+	}
+
+	if (!OpenChannelTo(PeerID)) return;
+
+	TArray<uint8>& Message = OpenMessages.FindOrAdd(PeerID);
+
+	// The packets batched so far go out as they are when this one doesn't fit with them
+	if (Message.Num() > 0 && Message.Num() + PacketHeaderSize + Count > MaxMessageSize)
+	{
+		QueuedMessages.Add(FDiscordNetworkMessage{PeerID, DiscordChannelID, MoveTemp(Message)});
+	}
+
+	if (Message.Max() == 0)
+	{
+		Message = BufferPool->Acquire(MaxMessageSize);
+	}
+
+	Message.Add(static_cast<uint8>(Count & 0xFF));
+	Message.Add(static_cast<uint8>(Count >> 8));
+	Message.Append(Data, Count);
+}
+
+int32 UDiscordNetDriver::GetMaxPacketSize() const
+{
+	return FMath::Max(MaxMessageSize - PacketHeaderSize, 1);
+}
+
+UDiscordSubsystem* UDiscordNetDriver::FindDiscordSubsystem() const
+{
+	const UGameInstance* GameInstance = nullptr;
+	if (const UWorld* NetWorld = GetWorld())
+	{
+		GameInstance = NetWorld->GetGameInstance();
+	}
+	else if (const FWorldContext* Context = GEngine ? GEngine->GetWorldContextFromPendingNetGameNetDriver(this) : nullptr)
+	{
+		// Clients only get a world once connected
+		GameInstance = Context->OwningGameInstance;
+	}
+
+	return GameInstance ? GameInstance->GetSubsystem<UDiscordSubsystem>() : nullptr;
+}
+
+bool UDiscordNetDriver::OpenChannelTo(const uint64 PeerID)
+{
+	if (OpenChannels.Contains(PeerID)) return true;
+
+	// Unreliable, since the engine already resends what needs to be
+	if (!NetworkManager.IsValid() || !NetworkManager->OpenChannel(static_cast<int64>(PeerID), DiscordChannelID, false)) return false;
+
+	OpenChannels.Add(PeerID);
+	return true;
+}
+
+void UDiscordNetDriver::ReceiveMessage(const uint64 PeerID, TArray<uint8>& Message)
+{
+	int32 Offset = 0;
+	while (Offset + PacketHeaderSize <= Message.Num())
+	{
+		const int32 Count = Message[Offset] | (Message[Offset + 1] << 8);
+		Offset += PacketHeaderSize;
+
+		if (Offset + Count > Message.Num())
+		{
+			LOG_DISCORD(Warning, "Received a malformed message from peer {PeerID}", PeerID);
+			return;
+		}
+
+		ReceivePacket(PeerID, Message.GetData() + Offset, Count);
+		Offset += Count;
+	}
+}
+
+void UDiscordNetDriver::ReceivePacket(const uint64 PeerID, uint8* Data, int32 Count)
+{
+	UNetConnection* Connection = nullptr;
+	if (ServerConnection)
+	{
+		// Clients only listen to their server
+		if (PeerID != ServerPeerID) return;
+
+		Connection = ServerConnection;
+	}
+	else
+	{
+		LookupAddress->SetPeerID(PeerID);
+		if (const auto* MappedConnection = MappedClientConnections.Find(LookupAddress.ToSharedRef()))
+		{
+			// Recently disconnected peers are kept without a connection, so that their last packets are ignored
+			Connection = *MappedConnection;
+			if (!Connection) return;
+		}
+		else
+		{
+			Connection = ProcessConnectionlessPacket(PeerID, Data, Count);
+		}
+	}
+
+	if (Connection && Count > 0)
+	{
+		Connection->ReceivedRawPacket(Data, Count);
+	}
+}
+
+UNetConnection* UDiscordNetDriver::ProcessConnectionlessPacket(const uint64 PeerID, uint8*& Data, int32& Count)
+{
+	if (!Notify || Notify->NotifyAcceptingConnection() != EAcceptConnection::Accept) return nullptr;
+	if (!ConnectionlessHandler.IsValid() || !StatelessConnectComponent.IsValid()) return nullptr;
+
+	const TSharedPtr<StatelessConnectHandlerComponent> StatelessConnect = StatelessConnectComponent.Pin();
+
+	FReceivedPacketView PacketView;
+	PacketView.DataView = FPacketDataView(Data, Count, ECountUnits::Bytes);
+	PacketView.Address = LookupAddress->Clone();
+
+	if (ConnectionlessHandler->IncomingConnectionless(PacketView) != EIncomingResult::Success) return nullptr;
+
+	// Until then, the handshake replies go out through LowLevelSend
+	bool bRestartedHandshake = false;
+	if (!StatelessConnect->HasPassedChallenge(PacketView.Address, bRestartedHandshake)) return nullptr;
+
+	// Peer IDs never change, so a restarted handshake comes from a peer whose connection is already mapped, and never
+	// ends up here
+	if (bRestartedHandshake)
+	{
+		StatelessConnect->ResetChallengeData();
+		return nullptr;
+	}
+
+	UNetConnection* Connection = NewObject<UNetConnection>(GetTransientPackage(), NetConnectionClass);
+	Connection->InitRemoteConnection(this, nullptr, World ? World->URL : FURL(), *PacketView.Address, USOCK_Open);
+
+	int32 ServerSequence = 0;
+	int32 ClientSequence = 0;
+	StatelessConnect->GetChallengeSequence(ServerSequence, ClientSequence);
+	Connection->InitSequence(ClientSequence, ServerSequence);
+
+	if (Connection->Handler.IsValid())
+	{
+		Connection->Handler->BeginHandshaking();
+	}
+
+	Notify->NotifyAcceptedConnection(Connection);
+	AddClientConnection(Connection);
+	StatelessConnect->ResetChallengeData();
+
+	LOG_DISCORD(Log, "Accepted a connection from peer {PeerID}", PeerID);
+
+	// Whatever follows the handshake in the packet is for the new connection
+	Data = const_cast<uint8*>(PacketView.DataView.GetData());
+	Count = PacketView.DataView.NumBytes();
+	return Connection;
+}
+
+void UDiscordNetDriver::SendQueuedMessages()
+{
+	for (TPair<uint64, TArray<uint8>>& Message : OpenMessages)
+	{
+		if (Message.Value.Num() > 0)
+		{
+			QueuedMessages.Add(FDiscordNetworkMessage{Message.Key, DiscordChannelID, MoveTemp(Message.Value)});
+		}
+	}
+
+	OpenMessages.Reset();
+
+	if (QueuedMessages.Num() > 0 && NetworkManager.IsValid())
+	{
+		DISCORD_SCOPE_CYCLE_COUNTER(NetDriver_SendQueuedMessages);
+
+		NetworkManager->SendMessages(MoveTemp(QueuedMessages), BufferPool);
+	}
+
+	QueuedMessages.Reset();
+}
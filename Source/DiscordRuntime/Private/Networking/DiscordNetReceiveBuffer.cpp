@@ -0,0 +1,65 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "DiscordNetReceiveBuffer.h"
+
+
+FDiscordNetReceiveBuffer::FDiscordNetReceiveBuffer(const int32 InCapacity)
+{
+	const uint32 Capacity = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(InCapacity, 4096)));
+	Storage.SetNumUninitialized(Capacity);
+	Mask = Capacity - 1;
+}
+
+bool FDiscordNetReceiveBuffer::Push(const uint64 PeerID, const TArrayView<const uint8> Data)
+{
+	const uint64 Size = HeaderSize + Data.Num();
+	const uint64 Position = WritePosition.load(std::memory_order_relaxed);
+
+	if (Position + Size - ReadPosition.load(std::memory_order_acquire) > static_cast<uint64>(Storage.Num()))
+	{
+		NumDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	const uint32 DataSize = Data.Num();
+	Write(Position, &PeerID, sizeof(PeerID));
+	Write(Position + sizeof(PeerID), &DataSize, sizeof(DataSize));
+	Write(Position + HeaderSize, Data.GetData(), DataSize);
+
+	WritePosition.store(Position + Size, std::memory_order_release);
+	return true;
+}
+
+bool FDiscordNetReceiveBuffer::Pop(uint64& OutPeerID, TArray<uint8>& OutData)
+{
+	const uint64 Position = ReadPosition.load(std::memory_order_relaxed);
+	if (Position == WritePosition.load(std::memory_order_acquire)) return false;
+
+	uint32 DataSize = 0;
+	Read(Position, &OutPeerID, sizeof(OutPeerID));
+	Read(Position + sizeof(OutPeerID), &DataSize, sizeof(DataSize));
+
+	OutData.SetNumUninitialized(DataSize, EAllowShrinking::No);
+	Read(Position + HeaderSize, OutData.GetData(), DataSize);
+
+	ReadPosition.store(Position + HeaderSize + DataSize, std::memory_order_release);
+	return true;
+}
+
+void FDiscordNetReceiveBuffer::Write(const uint64 Position, const void* Data, const uint64 Size)
+{
+	const uint64 Offset = Position & Mask;
+	const uint64 FirstSize = FMath::Min(Size, Storage.Num() - Offset);
+
+	FMemory::Memcpy(Storage.GetData() + Offset, Data, FirstSize);
+	FMemory::Memcpy(Storage.GetData(), static_cast<const uint8*>(Data) + FirstSize, Size - FirstSize);
+}
+
+void FDiscordNetReceiveBuffer::Read(const uint64 Position, void* OutData, const uint64 Size) const
+{
+	const uint64 Offset = Position & Mask;
+	const uint64 FirstSize = FMath::Min(Size, Storage.Num() - Offset);
+
+	FMemory::Memcpy(OutData, Storage.GetData() + Offset, FirstSize);
+	FMemory::Memcpy(static_cast<uint8*>(OutData) + FirstSize, Storage.GetData(), Size - FirstSize);
+}
@@ -0,0 +1,54 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+
+/**
+ * Lock-free ring buffer handing received messages from the thread that pumps the callbacks over to the game thread.
+ * Messages are copied in once, back to back, so receiving doesn't allocate. Only one thread may push, and only one
+ * may pop.
+ */
+class FDiscordNetReceiveBuffer final
+{
+public:
+	/**
+	 * The capacity is rounded up to a power of two.
+	 */
+	explicit FDiscordNetReceiveBuffer(const int32 InCapacity);
+
+	/**
+	 * Copies a message in. Returns false, dropping it, if there isn't enough room left.
+	 */
+	bool Push(const uint64 PeerID, const TArrayView<const uint8> Data);
+
+	/**
+	 * Copies the oldest message out, reusing the memory of OutData. Returns false if the buffer is empty.
+	 */
+	bool Pop(uint64& OutPeerID, TArray<uint8>& OutData);
+
+	/**
+	 * Returns how many messages were dropped so far because the buffer was full.
+	 */
+	int32 GetNumDropped() const { return NumDropped.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr uint64 HeaderSize = sizeof(uint64) + sizeof(uint32);
+
+	void Write(const uint64 Position, const void* Data, const uint64 Size);
+	void Read(const uint64 Position, void* OutData, const uint64 Size) const;
+
+	TArray<uint8> Storage;
+
+	uint64 Mask;
+
+	// Only advanced by the pushing thread
+	std::atomic<uint64> WritePosition = 0;
+
+	// Only advanced by the popping thread
+	std::atomic<uint64> ReadPosition = 0;
+
+	std::atomic<int32> NumDropped = 0;
+};
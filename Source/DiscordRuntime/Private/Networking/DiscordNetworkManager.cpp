@@ -0,0 +1,204 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Networking/DiscordNetworkManager.h"
+
+#include "DiscordBufferPool.h"
+#include "DiscordCallbackPump.h"
+#include "DiscordLogChannel.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Discord/network_manager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordNetworkManager)
+
+
+UDiscordNetworkManager::UDiscordNetworkManager()
+{
+	const auto Outer = GetOuter();
+	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
+	{
+		DiscordSubsystem = Cast<UDiscordSubsystem>(GetOuter());
+	}
+}
+
+void UDiscordNetworkManager::Initialize(discord::NetworkManager* NetworkManager)
+{
+	Internal_NetworkManager = NetworkManager;
+
+	discord::NetworkPeerId SdkPeerID = 0;
+	Internal_NetworkManager->GetPeerId(&SdkPeerID);
+	LocalPeerID = SdkPeerID;
+
+	// Messages are handed to the handlers right away, on the pumping thread, since they decide what to copy and where
+	Internal_OnMessageCallback = Internal_NetworkManager->OnMessage.Connect([this](const discord::NetworkPeerId PeerID, const discord::NetworkChannelId ChannelID, uint8* Data, const uint32 DataLength)
+	{
+		MessageHandlers.Broadcast(PeerID, ChannelID, TArrayView<const uint8>(Data, DataLength));
+	});
+
+	Internal_OnRouteUpdateCallback = Internal_NetworkManager->OnRouteUpdate.Connect([this](const char* RouteData)
+	{
+		DiscordSubsystem->RunOnGameThread([this, Route = FString(UTF8_TO_TCHAR(RouteData))]() mutable
+		{
+			CurrentRoute = MoveTemp(Route);
+			OnRouteUpdatedNative.Broadcast(CurrentRoute);
+			OnRouteUpdated.Broadcast(CurrentRoute);
+		});
+	});
+}
+
+void UDiscordNetworkManager::BeginDestroy()
+{
+	if (Internal_NetworkManager)
+	{
+		Internal_NetworkManager->OnMessage.Disconnect(Internal_OnMessageCallback);
+		Internal_NetworkManager->OnRouteUpdate.Disconnect(Internal_OnRouteUpdateCallback);
+	}
+	
+	UObject::BeginDestroy();
+}
+
+bool UDiscordNetworkManager::OpenPeer(const int64 PeerID, const FString& Route)
+{
+	DISCORD_SCOPE_CALL(NetworkManager_OpenPeer);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	const auto Result = Internal_NetworkManager->OpenPeer(static_cast<uint64>(PeerID), TCHAR_TO_UTF8(*Route));
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return true;
+}
+
+bool UDiscordNetworkManager::UpdatePeer(const int64 PeerID, const FString& Route)
+{
+	DISCORD_SCOPE_CALL(NetworkManager_UpdatePeer);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	const auto Result = Internal_NetworkManager->UpdatePeer(static_cast<uint64>(PeerID), TCHAR_TO_UTF8(*Route));
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return true;
+}
+
+bool UDiscordNetworkManager::ClosePeer(const int64 PeerID)
+{
+	DISCORD_SCOPE_CALL(NetworkManager_ClosePeer);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	const auto Result = Internal_NetworkManager->ClosePeer(static_cast<uint64>(PeerID));
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return true;
+}
+
+bool UDiscordNetworkManager::OpenChannel(const int64 PeerID, const uint8 ChannelID, const bool bReliable)
+{
+	DISCORD_SCOPE_CALL(NetworkManager_OpenChannel);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	const auto Result = Internal_NetworkManager->OpenChannel(static_cast<uint64>(PeerID), ChannelID, bReliable);
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return true;
+}
+
+bool UDiscordNetworkManager::CloseChannel(const int64 PeerID, const uint8 ChannelID)
+{
+	DISCORD_SCOPE_CALL(NetworkManager_CloseChannel);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	const auto Result = Internal_NetworkManager->CloseChannel(static_cast<uint64>(PeerID), ChannelID);
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return true;
+}
+
+void UDiscordNetworkManager::SendMessages(TArray<FDiscordNetworkMessage>&& Messages, const TSharedPtr<FDiscordBufferPool, ESPMode::ThreadSafe>& BufferPool)
+{
+	DISCORD_SCOPE_CALL(NetworkManager_SendMessages);
+
+	if (!DiscordSubsystem->IsActive() || Messages.Num() == 0) return;
+
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_NetworkManager, Messages = MoveTemp(Messages), BufferPool]() mutable
+	{
+		for (FDiscordNetworkMessage& Message : Messages)
+		{
+			const auto Result = Manager->SendMessage(Message.PeerID, Message.ChannelID, Message.Data.GetData(), Message.Data.Num());
+			if (Result != discord::Result::Ok)
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+
+			if (BufferPool) BufferPool->Release(MoveTemp(Message.Data));
+		}
+
+		const auto Result = Manager->Flush();
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+		}
+	});
+}
+
+void UDiscordNetworkManager::CloseChannelAfterSends(const uint64 PeerID, const uint8 ChannelID)
+{
+	DISCORD_SCOPE_CALL(NetworkManager_CloseChannelAfterSends);
+
+	if (!DiscordSubsystem->IsActive()) return;
+
+	// Commands run in order, so this runs after the sends queued before it
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_NetworkManager, PeerID, ChannelID]
+	{
+		const auto Result = Manager->CloseChannel(PeerID, ChannelID);
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+		}
+	});
+}
+
+FDelegateHandle UDiscordNetworkManager::AddMessageHandler(FOnDiscordNetworkMessageNative::FDelegate&& Handler)
+{
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	return MessageHandlers.Add(MoveTemp(Handler));
+}
+
+void UDiscordNetworkManager::RemoveMessageHandler(const FDelegateHandle Handle)
+{
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	MessageHandlers.Remove(Handle);
+}
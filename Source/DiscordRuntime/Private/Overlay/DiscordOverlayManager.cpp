@@ -2,9 +2,12 @@
 
 #include "Overlay/DiscordOverlayManager.h"
 
+#include "DiscordCallbackPump.h"
 #include "DiscordLatentAction.h"
 #include "DiscordLogChannel.h"
+#include "DiscordStats.h"
 #include "DiscordSubsystem.h"
+#include "Users/DiscordUserManager.h"
 #include "Discord/overlay_manager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordOverlayManager)
@@ -23,9 +26,27 @@ void UDiscordOverlayManager::Initialize(discord::OverlayManager* OverlayManager)
 {
 	Internal_OverlayManager = OverlayManager;
 
-	Internal_OnToggleCallback = Internal_OverlayManager->OnToggle.Connect([&](const bool bLocked)
+	// Called before the callbacks are pumped anywhere, so the SDK can be read right away. These are only its defaults
+	// until the client is connected, when they're read again.
+	Internal_OverlayManager->IsEnabled(&bOverlayEnabled);
+	Internal_OverlayManager->IsLocked(&bOverlayLocked);
+
+	DiscordSubsystem->GetUserManager()->OnCurrentUserUpdatedNative.AddUObject(this, &UDiscordOverlayManager::OnCurrentUserUpdated);
+
+	Internal_OnToggleCallback = Internal_OverlayManager->OnToggle.Connect([this](const bool bNewLocked)
 	{
-		OnToggled.Broadcast(bLocked);
+		// Runs on whichever thread pumps the callbacks, so it's free to read the SDK
+		bool bNewEnabled = false;
+		Internal_OverlayManager->IsEnabled(&bNewEnabled);
+
+		DiscordSubsystem->RunOnGameThread([this, bNewLocked, bNewEnabled]
+		{
+			bOverlayLocked = bNewLocked;
+			bOverlayEnabled = bNewEnabled;
+
+			OnToggledNative.Broadcast(bOverlayLocked);
+			OnToggled.Broadcast(bOverlayLocked);
+		});
 	});
 }
 
@@ -39,82 +60,120 @@ void UDiscordOverlayManager::BeginDestroy()
 	UObject::BeginDestroy();
 }
 
-bool UDiscordOverlayManager::IsEnabled() const
+void UDiscordOverlayManager::OnCurrentUserUpdated(const FDiscordUtf8User& User)
 {
-	if (!DiscordSubsystem->IsActive()) return false;
-	
-	bool bReturnValue;
-	Internal_OverlayManager->IsEnabled(&bReturnValue);
-	return bReturnValue;
-}
+	bool bNewEnabled = false;
+	bool bNewLocked = true;
+	{
+		FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+		Internal_OverlayManager->IsEnabled(&bNewEnabled);
+		Internal_OverlayManager->IsLocked(&bNewLocked);
+	}
 
-bool UDiscordOverlayManager::IsLocked() const
-{
-	if (!DiscordSubsystem->IsActive()) return false;
-	
-	bool bReturnValue;
-	Internal_OverlayManager->IsLocked(&bReturnValue);
-	return bReturnValue;
+	bOverlayEnabled = bNewEnabled;
+	if (bNewLocked == bOverlayLocked) return;
+
+	bOverlayLocked = bNewLocked;
+	OnToggledNative.Broadcast(bOverlayLocked);
+	OnToggled.Broadcast(bOverlayLocked);
 }
 
 void UDiscordOverlayManager::SetLocked(const UObject* WorldContext, const FLatentActionInfo LatentInfo,
 	const bool bLocked, EDiscordOutputPins& OutputPins)
 {
-	FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins, [this, bLocked](auto* Action) mutable
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = SetLocked(bLocked, [Action](discord::Result Result)
 	{
-		SetLocked(bLocked, [Action](discord::Result Result) mutable
-		{
-			Action->FinishOperation(Result == discord::Result::Ok);
-		});
+		Action->FinishOperation(Result == discord::Result::Ok);
 	});
+	Action->SetOperation(DiscordSubsystem, Handle);
 }
 
-void UDiscordOverlayManager::SetLocked(const bool bLocked, TFunction<void(discord::Result)> Callback)
+FDiscordOperationHandle UDiscordOverlayManager::SetLocked(const bool bLocked, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
 {
+	DISCORD_SCOPE_CALL(OverlayManager_SetLocked);
+	
 	if (!DiscordSubsystem->IsActive()) {
 		Callback(discord::Result::InternalError);
-		return;
+		return {};
 	}
 	
-	Internal_OverlayManager->SetLocked(bLocked, Callback);
+	// Applied before the callback fires, in case it reads `IsLocked`. `OnToggled` fires separately, if it changed.
+	TFunction<void(discord::Result)> ApplyLocked = [this, bLocked, Callback = MoveTemp(Callback)](discord::Result Result)
+	{
+		if (Result == discord::Result::Ok)
+		{
+			bOverlayLocked = bLocked;
+		}
+
+		if (Callback) Callback(Result);
+	};
+	
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(ApplyLocked), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_OverlayManager, bLocked, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Manager->SetLocked(bLocked, WrappedCallback);
+	});
+
+	return Handle;
 }
 
 void UDiscordOverlayManager::OpenActivityInvite()
 {
-	Internal_OverlayManager->OpenActivityInvite(discord::ActivityActionType::Join, [](discord::Result Result)
+	DISCORD_SCOPE_CALL(OverlayManager_OpenActivityInvite);
+	
+	if (!DiscordSubsystem->IsActive()) return;
+	
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_OverlayManager]
 	{
-		// This callback apparently never fires
-		if (Result != discord::Result::Ok)
+		Manager->OpenActivityInvite(discord::ActivityActionType::Join, [](discord::Result Result)
 		{
-			LOG_DISCORD_ERROR(Result);
-		}
+			// This callback apparently never fires
+			if (Result != discord::Result::Ok)
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+		});
 	});
 }
 
 void UDiscordOverlayManager::OpenGuildInvite(const FString InviteCode)
 {
+	DISCORD_SCOPE_CALL(OverlayManager_OpenGuildInvite);
+	
 	if (!DiscordSubsystem->IsActive()) return;
 	
-	Internal_OverlayManager->OpenGuildInvite(TCHAR_TO_UTF8(*InviteCode), [](discord::Result Result)
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_OverlayManager, InviteCode]
 	{
-		// This callback apparently never fires
-		if (Result != discord::Result::Ok)
+		Manager->OpenGuildInvite(TCHAR_TO_UTF8(*InviteCode), [](discord::Result Result)
 		{
-			LOG_DISCORD_ERROR(Result);
-		}
+			// This callback apparently never fires
+			if (Result != discord::Result::Ok)
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+		});
 	});
 }
 
 void UDiscordOverlayManager::OpenVoiceSettings()
 {
+	DISCORD_SCOPE_CALL(OverlayManager_OpenVoiceSettings);
+	
 	if (!DiscordSubsystem->IsActive()) return;
 	
-	Internal_OverlayManager->OpenVoiceSettings([](discord::Result Result)
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_OverlayManager]
 	{
-		// This callback apparently never fires
-		if (Result != discord::Result::Ok)
+		Manager->OpenVoiceSettings([](discord::Result Result)
 		{
-			LOG_DISCORD_ERROR(Result);
-		}
+			// This callback apparently never fires
+			if (Result != discord::Result::Ok)
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+		});
 	});
 }
@@ -0,0 +1,19 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Relationships/DiscordRelationship.h"
+
+#include "DiscordStats.h"
+#include "Discord/types.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordRelationship)
+
+
+FDiscordRelationship::FDiscordRelationship(discord::Relationship const& Relationship)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordRelationship_FromDiscordType);
+
+	Type = static_cast<EDiscordRelationshipTypes::Type>(Relationship.GetType());
+	User = FDiscordUser(Relationship.GetUser());
+	Status = static_cast<EDiscordStatusTypes::Type>(Relationship.GetPresence().GetStatus());
+	Activity = FDiscordActivity(Relationship.GetPresence().GetActivity());
+}
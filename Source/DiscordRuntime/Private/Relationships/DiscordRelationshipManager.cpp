@@ -0,0 +1,270 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Relationships/DiscordRelationshipManager.h"
+
+#include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Discord/relationship_manager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordRelationshipManager)
+
+
+UDiscordRelationshipManager::UDiscordRelationshipManager()
+{
+	const auto Outer = GetOuter();
+	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
+	{
+		DiscordSubsystem = Cast<UDiscordSubsystem>(GetOuter());
+	}
+}
+
+void UDiscordRelationshipManager::Initialize(discord::RelationshipManager* RelationshipManager)
+{
+	Internal_RelationshipManager = RelationshipManager;
+
+	Internal_OnRefreshCallback = Internal_RelationshipManager->OnRefresh.Connect([this]
+	{
+		DISCORD_SCOPE_CYCLE_COUNTER(RelationshipManager_Refresh);
+
+		// Runs on whichever thread pumps the callbacks, so read everything right away and only hand the rows over
+		Internal_RelationshipManager->Filter([](discord::Relationship const&) { return true; });
+
+		int32 Count = 0;
+		const auto Result = Internal_RelationshipManager->Count(&Count);
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+			return;
+		}
+
+		TArray<FRow> Rows;
+		Rows.Reserve(Count);
+
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			discord::Relationship Relationship;
+			if (Internal_RelationshipManager->GetAt(Index, &Relationship) == discord::Result::Ok)
+			{
+				Rows.Add(MakeRow(Relationship));
+			}
+		}
+
+		DiscordSubsystem->RunOnGameThread([this, Rows = MoveTemp(Rows)]() mutable
+		{
+			ApplyRefresh(MoveTemp(Rows));
+		});
+	});
+
+	Internal_OnRelationshipUpdateCallback = Internal_RelationshipManager->OnRelationshipUpdate.Connect([this](discord::Relationship const& Relationship)
+	{
+		DiscordSubsystem->RunOnGameThread([this, Row = MakeRow(Relationship)]() mutable
+		{
+			ApplyUpdate(MoveTemp(Row));
+		});
+	});
+}
+
+void UDiscordRelationshipManager::BeginDestroy()
+{
+	if (Internal_RelationshipManager)
+	{
+		Internal_RelationshipManager->OnRefresh.Disconnect(Internal_OnRefreshCallback);
+		Internal_RelationshipManager->OnRelationshipUpdate.Disconnect(Internal_OnRelationshipUpdateCallback);
+	}
+	
+	UObject::BeginDestroy();
+}
+
+void UDiscordRelationshipManager::FlushNotifications()
+{
+	if (bRefreshed)
+	{
+		bRefreshed = false;
+		ChangedUserIDs.Reset();
+
+		OnRefreshedNative.Broadcast();
+		OnRefreshed.Broadcast();
+		return;
+	}
+
+	if (ChangedUserIDs.Num() == 0) return;
+
+	// Moved out first, so that listeners can change relationships again without touching the set being broadcast
+	const TSet<int64> UpdatedUserIDs = MoveTemp(ChangedUserIDs);
+	ChangedUserIDs.Reset();
+
+	OnRelationshipsUpdatedNative.Broadcast(UpdatedUserIDs);
+	if (OnRelationshipsUpdated.IsBound()) OnRelationshipsUpdated.Broadcast(UpdatedUserIDs.Array());
+}
+
+UDiscordRelationshipManager::FRow UDiscordRelationshipManager::MakeRow(discord::Relationship const& Relationship)
+{
+	FRow Row;
+	Row.UserID = Relationship.GetUser().GetId();
+	Row.Type = static_cast<EDiscordRelationshipTypes::Type>(Relationship.GetType());
+	Row.Status = static_cast<EDiscordStatusTypes::Type>(Relationship.GetPresence().GetStatus());
+	Row.User = FDiscordUtf8User(Relationship.GetUser());
+	Row.Activity = FDiscordUtf8Activity(Relationship.GetPresence().GetActivity());
+	return Row;
+}
+
+void UDiscordRelationshipManager::ApplyRefresh(TArray<FRow>&& Rows)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(RelationshipManager_ApplyRefresh);
+
+	UserIDs.Reset(Rows.Num());
+	Types.Reset(Rows.Num());
+	Statuses.Reset(Rows.Num());
+	Users.Reset(Rows.Num());
+	Activities.Reset(Rows.Num());
+	RowByUserID.Reset();
+	Friends.Reset();
+	OnlineFriends.Reset();
+	InGameFriends.Reset();
+	SameApplicationFriends.Reset();
+
+	for (FRow& Row : Rows)
+	{
+		ApplyUpdate(MoveTemp(Row));
+	}
+
+	bRefreshed = true;
+	LOG_DISCORD(Verbose, "Refreshed {Count} relationships", UserIDs.Num());
+}
+
+void UDiscordRelationshipManager::ApplyUpdate(FRow&& Row)
+{
+	ChangedUserIDs.Add(Row.UserID);
+
+	const int32* ExistingIndex = RowByUserID.Find(Row.UserID);
+
+	// A relationship that went away, e.g. an unfriended user
+	if (Row.Type == EDiscordRelationshipTypes::None)
+	{
+		if (ExistingIndex) RemoveRow(*ExistingIndex);
+		return;
+	}
+
+	if (ExistingIndex)
+	{
+		SetRow(*ExistingIndex, MoveTemp(Row));
+		return;
+	}
+
+	const int32 Index = UserIDs.AddUninitialized();
+	Types.AddUninitialized();
+	Statuses.AddUninitialized();
+	Users.AddDefaulted();
+	Activities.AddDefaulted();
+	Friends.Add(false);
+	OnlineFriends.Add(false);
+	InGameFriends.Add(false);
+	SameApplicationFriends.Add(false);
+
+	RowByUserID.Add(Row.UserID, Index);
+	SetRow(Index, MoveTemp(Row));
+}
+
+void UDiscordRelationshipManager::SetRow(const int32 Index, FRow&& Row)
+{
+	const bool bFriend = Row.Type == EDiscordRelationshipTypes::Friend;
+	const bool bInGame = Row.Activity.ApplicationID > 0 || !Row.Activity.Name.IsEmpty();
+	const bool bSameApplication = Row.Activity.ApplicationID > 0 && Row.Activity.ApplicationID == GetDefault<UDiscordSettings>()->ClientID;
+
+	Friends[Index] = bFriend;
+	OnlineFriends[Index] = bFriend && Row.Status != EDiscordStatusTypes::Offline;
+	InGameFriends[Index] = bFriend && bInGame;
+	SameApplicationFriends[Index] = bFriend && bSameApplication;
+
+	UserIDs[Index] = Row.UserID;
+	Types[Index] = Row.Type;
+	Statuses[Index] = Row.Status;
+	Users[Index] = MoveTemp(Row.User);
+	Activities[Index] = MoveTemp(Row.Activity);
+}
+
+void UDiscordRelationshipManager::RemoveRow(const int32 Index)
+{
+	const int32 LastIndex = UserIDs.Num() - 1;
+
+	RowByUserID.Remove(UserIDs[Index]);
+	if (Index != LastIndex)
+	{
+		// The last row takes the place of the removed one
+		RowByUserID[UserIDs[LastIndex]] = Index;
+
+		Friends[Index] = Friends[LastIndex];
+		OnlineFriends[Index] = OnlineFriends[LastIndex];
+		InGameFriends[Index] = InGameFriends[LastIndex];
+		SameApplicationFriends[Index] = SameApplicationFriends[LastIndex];
+	}
+
+	UserIDs.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Types.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Statuses.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Users.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Activities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Friends.RemoveAt(LastIndex);
+	OnlineFriends.RemoveAt(LastIndex);
+	InGameFriends.RemoveAt(LastIndex);
+	SameApplicationFriends.RemoveAt(LastIndex);
+}
+
+const TBitArray<>& UDiscordRelationshipManager::GetFriendIndex(const EDiscordFriendFilters::Type Filter) const
+{
+	switch (Filter)
+	{
+	case EDiscordFriendFilters::Online:
+		return OnlineFriends;
+	case EDiscordFriendFilters::InGame:
+		return InGameFriends;
+	case EDiscordFriendFilters::SameApplication:
+		return SameApplicationFriends;
+	default:
+		return Friends;
+	}
+}
+
+bool UDiscordRelationshipManager::GetRelationship(const int64 UserID, FDiscordRelationship& Relationship) const
+{
+	DISCORD_SCOPE_CALL(RelationshipManager_GetRelationship);
+
+	const int32* Index = RowByUserID.Find(UserID);
+	if (!Index) return false;
+
+	Relationship.Type = Types[*Index];
+	Relationship.User = FDiscordUser(Users[*Index]);
+	Relationship.Status = Statuses[*Index];
+	Relationship.Activity = FDiscordActivity(Activities[*Index]);
+	return true;
+}
+
+TArray<int64> UDiscordRelationshipManager::GetFriendIDs(const EDiscordFriendFilters::Type Filter) const
+{
+	DISCORD_SCOPE_CALL(RelationshipManager_GetFriendIDs);
+
+	TArray<int64> FriendIDs;
+	FriendIDs.Reserve(GetFriendCount(Filter));
+
+	ForEachFriend(Filter, [&FriendIDs](const int64 UserID)
+	{
+		FriendIDs.Add(UserID);
+	});
+
+	return FriendIDs;
+}
+
+int32 UDiscordRelationshipManager::GetFriendCount(const EDiscordFriendFilters::Type Filter) const
+{
+	return GetFriendIndex(Filter).CountSetBits();
+}
+
+void UDiscordRelationshipManager::ForEachFriend(const EDiscordFriendFilters::Type Filter, TFunctionRef<void(int64 UserID)> Function) const
+{
+	for (TConstSetBitIterator<> It(GetFriendIndex(Filter)); It; ++It)
+	{
+		Function(UserIDs[It.GetIndex()]);
+	}
+}
@@ -0,0 +1,806 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Storage/DiscordStorageManager.h"
+
+#include "DiscordBufferPool.h"
+#include "DiscordCallbackPump.h"
+#include "DiscordLatentAction.h"
+#include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "DiscordUtf8String.h"
+#include "Discord/storage_manager.h"
+#include "Hash/CityHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#include <atomic>
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordStorageManager)
+
+
+/** Sized like `DiscordFileStat::filename`. */
+using FDiscordFilename = TDiscordUtf8String<260>;
+
+/** Chunks kept for reuse between reads. */
+static constexpr int32 MaxPooledChunks = 8;
+
+/** Identifies a save file manifest, "DSVF". */
+static constexpr uint32 SaveFileMagic = 0x46565344;
+
+static constexpr uint32 SaveFileVersion = 1;
+
+/** Magic, version, region size, region count and size, followed by a hash per region. */
+static constexpr int32 SaveFileHeaderSize = 3 * sizeof(uint32) + sizeof(uint32) + sizeof(uint64);
+
+/** Larger manifests can't belong to a save file, and aren't read. */
+static constexpr uint64 MaxManifestSize = 16 * 1024 * 1024;
+
+static FDiscordFilename ToFilename(const FString& Name)
+{
+	FDiscordFilename Filename;
+	Filename.CopyFromString(TCHAR_TO_UTF8(*Name));
+	return Filename;
+}
+
+static FDiscordFilename GetRegionFilename(const FString& Name, const int32 Index)
+{
+	return ToFilename(FString::Printf(TEXT("%s.%d"), *Name, Index));
+}
+
+static uint64 GetChunkSize()
+{
+	return FMath::Max(GetDefault<UDiscordSettings>()->StorageChunkSize, 4096);
+}
+
+static uint64 HashRegion(const uint8* Data, const uint64 Length)
+{
+	return CityHash64(reinterpret_cast<const char*>(Data), static_cast<uint32>(Length));
+}
+
+
+/**
+ * A read in progress, shared between the thread that pumps the callbacks, which requests the chunks, and the game
+ * thread, which consumes them.
+ */
+struct UDiscordStorageManager::FRead
+{
+	/** A file read as part of the result, at an offset. */
+	struct FPart
+	{
+		FDiscordFilename Filename;
+		uint64 Size;
+		uint64 Offset;
+	};
+
+	explicit FRead(const FString& InName, const uint64 InChunkSize)
+		: Name(InName), ChunkSize(InChunkSize)
+	{
+	}
+
+	void AddPart(FDiscordFilename&& Filename, const uint64 PartSize)
+	{
+		Parts.Add({MoveTemp(Filename), PartSize, Size});
+		Size += PartSize;
+	}
+
+	const FString Name;
+
+	uint64 ChunkSize;
+
+	// Set on the pumping thread before the first chunk is requested
+	TArray<FPart> Parts;
+	TArray<uint64> PartHashes;
+	uint64 Size = 0;
+
+	// Only touched on the pumping thread
+	int32 NextPart = 0;
+	uint64 NextPartOffset = 0;
+
+	// Only touched on the game thread
+	FDiscordOperationHandle Handle;
+	float ChunkTimeoutSeconds = 0.f;
+	uint64 BytesRead = 0;
+	TArray<uint8> Data;
+	TFunction<void(TArrayView<const uint8>, uint64)> ChunkHandler;
+
+	/** Ends the operation. Can be called from any thread, and only the first call counts. */
+	TFunction<void(discord::Result)> Finish;
+
+	/** Set once the read finished, failed, timed out or was cancelled, to stop requesting and consuming chunks. */
+	std::atomic<bool> bStopped = false;
+};
+
+/**
+ * A save file write in progress. Only touched on the thread that pumps the callbacks.
+ */
+struct UDiscordStorageManager::FSaveFileWrite
+{
+	FString Name;
+	TArray<uint8> Data;
+	FSaveFileManifest Manifest;
+	TArray<uint8> ManifestData;
+	int32 NumOldRegions = 0;
+	int32 NumPending = 0;
+	discord::Result Result = discord::Result::Ok;
+	TFunction<void(discord::Result)> Callback;
+};
+
+
+UDiscordStorageManager::UDiscordStorageManager()
+{
+	const auto Outer = GetOuter();
+	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
+	{
+		DiscordSubsystem = Cast<UDiscordSubsystem>(GetOuter());
+	}
+}
+
+void UDiscordStorageManager::Initialize(discord::StorageManager* StorageManager)
+{
+	Internal_StorageManager = StorageManager;
+
+	const auto* DiscordSettings = GetDefault<UDiscordSettings>();
+	ChunkPool = new FDiscordBufferPool(MaxPooledChunks, FMath::Max(DiscordSettings->StorageChunkSize, DiscordSettings->SaveFileRegionSize));
+}
+
+void UDiscordStorageManager::BeginDestroy()
+{
+	delete ChunkPool;
+	ChunkPool = nullptr;
+	
+	UObject::BeginDestroy();
+}
+
+discord::Result UDiscordStorageManager::ReadManifest(const FString& Name, FSaveFileManifest& OutManifest) const
+{
+	const FDiscordFilename Filename = ToFilename(Name);
+
+	discord::FileStat Stat{};
+	auto Result = Internal_StorageManager->Stat(Filename.Get(), &Stat);
+	if (Result != discord::Result::Ok) return Result;
+
+	if (Stat.GetSize() < SaveFileHeaderSize || Stat.GetSize() > MaxManifestSize) return discord::Result::InternalError;
+
+	TArray<uint8> ManifestData;
+	ManifestData.SetNumUninitialized(static_cast<int32>(Stat.GetSize()));
+
+	uint32 NumRead = 0;
+	Result = Internal_StorageManager->Read(Filename.Get(), ManifestData.GetData(), ManifestData.Num(), &NumRead);
+	if (Result != discord::Result::Ok) return Result;
+
+	FMemoryReader Reader(ManifestData);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint32 NumRegions = 0;
+	Reader << Magic << Version << OutManifest.RegionSize << NumRegions << OutManifest.Size;
+
+	if (Magic != SaveFileMagic || Version != SaveFileVersion || OutManifest.RegionSize == 0
+		|| NumRegions != FMath::DivideAndRoundUp<uint64>(OutManifest.Size, OutManifest.RegionSize)
+		|| NumRead != SaveFileHeaderSize + NumRegions * sizeof(uint64))
+	{
+		LOG_DISCORD(Warning, "{Name} isn't a save file, or it is corrupt", Name);
+		return discord::Result::InternalError;
+	}
+
+	OutManifest.RegionHashes.SetNumUninitialized(NumRegions);
+	Reader.Serialize(OutManifest.RegionHashes.GetData(), NumRegions * sizeof(uint64));
+	return discord::Result::Ok;
+}
+
+void UDiscordStorageManager::BeginRead(const TSharedRef<FRead, ESPMode::ThreadSafe>& Read)
+{
+	if (Read->Size == 0)
+	{
+		Read->Finish(discord::Result::Ok);
+		return;
+	}
+
+	if (!Read->ChunkHandler)
+	{
+		if (Read->Size > MAX_int32)
+		{
+			LOG_DISCORD(Error, "{Name} is too large to be read at once, it must be streamed", Read->Name);
+			Read->Finish(discord::Result::InternalError);
+			return;
+		}
+
+		// Allocated once, so the chunks are copied straight to their place
+		Read->Data.SetNumUninitialized(static_cast<int32>(Read->Size));
+	}
+
+	ReadNextChunk(Read);
+}
+
+void UDiscordStorageManager::ReadNextChunk(const TSharedRef<FRead, ESPMode::ThreadSafe>& Read)
+{
+	const int32 PartIndex = Read->NextPart;
+	const FRead::FPart& Part = Read->Parts[PartIndex];
+	const uint64 PartOffset = Read->NextPartOffset;
+	const uint64 Length = FMath::Min(Read->ChunkSize, Part.Size - PartOffset);
+
+	Read->NextPartOffset += Length;
+	if (Read->NextPartOffset >= Part.Size)
+	{
+		Read->NextPart++;
+		Read->NextPartOffset = 0;
+	}
+
+	Internal_StorageManager->ReadAsyncPartial(Part.Filename.Get(), PartOffset, Length,
+		[this, Read, PartIndex, Offset = Part.Offset + PartOffset, Length](discord::Result Result, uint8* Data, const uint32 DataLength)
+	{
+		OnChunkRead(Read, Result, PartIndex, Offset, Length, TArrayView<const uint8>(Data, DataLength));
+	});
+}
+
+void UDiscordStorageManager::OnChunkRead(const TSharedRef<FRead, ESPMode::ThreadSafe>& Read, discord::Result Result, const int32 PartIndex, const uint64 Offset, const uint64 Length, const TArrayView<const uint8> Chunk)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(StorageManager_OnChunkRead);
+
+	if (Read->bStopped) return;
+
+	if (Result == discord::Result::Ok && static_cast<uint64>(Chunk.Num()) != Length)
+	{
+		LOG_DISCORD(Warning, "{Name} changed while it was read", Read->Name);
+		Result = discord::Result::InternalError;
+	}
+
+	// Each region of a save file is read as a single chunk, so that it can be checked right away
+	if (Result == discord::Result::Ok && Read->PartHashes.Num() > 0 && HashRegion(Chunk.GetData(), Chunk.Num()) != Read->PartHashes[PartIndex])
+	{
+		LOG_DISCORD(Warning, "Region {Index} of save file {Name} doesn't match its manifest, the save file is corrupt", PartIndex, Read->Name);
+		SaveFileManifests.Remove(Read->Name);
+		Result = discord::Result::InternalError;
+	}
+
+	if (Result != discord::Result::Ok)
+	{
+		Read->bStopped = true;
+		Read->Finish(Result);
+		return;
+	}
+
+	// Requested before this one is consumed, so that the SDK reads it in the meantime
+	if (Read->NextPart < Read->Parts.Num())
+	{
+		ReadNextChunk(Read);
+	}
+
+	if (DiscordSubsystem->IsPumpingOnWorkerThread())
+	{
+		// The SDK buffer only lives for the duration of its callback
+		TArray<uint8> PooledChunk = ChunkPool->Acquire(Chunk.Num());
+		PooledChunk.Append(Chunk.GetData(), Chunk.Num());
+
+		DiscordSubsystem->RunOnGameThread([this, Read, Offset, PooledChunk = MoveTemp(PooledChunk)]() mutable
+		{
+			ConsumeChunk(*Read, Offset, PooledChunk);
+			ChunkPool->Release(MoveTemp(PooledChunk));
+		});
+	}
+	else
+	{
+		ConsumeChunk(*Read, Offset, Chunk);
+	}
+}
+
+void UDiscordStorageManager::ConsumeChunk(FRead& Read, const uint64 Offset, const TArrayView<const uint8> Chunk)
+{
+	if (Read.bStopped) return;
+
+	// A cancelled read never finishes, so it's noticed here, and stops requesting chunks from the next one on. The
+	// timeout covers one chunk at a time, since the whole read takes longer the larger the file is.
+	if (!DiscordSubsystem->RestartOperationTimeout(Read.Handle, Read.ChunkTimeoutSeconds))
+	{
+		Read.bStopped = true;
+		return;
+	}
+
+	if (Read.ChunkHandler)
+	{
+		Read.ChunkHandler(Chunk, Offset);
+	}
+	else
+	{
+		FMemory::Memcpy(Read.Data.GetData() + Offset, Chunk.GetData(), Chunk.Num());
+	}
+
+	Read.BytesRead += Chunk.Num();
+	OnReadProgressNative.Broadcast(Read.Name, Read.BytesRead, Read.Size);
+	OnReadProgress.Broadcast(Read.Name, Read.BytesRead, Read.Size);
+
+	if (Read.BytesRead == Read.Size)
+	{
+		Read.Finish(discord::Result::Ok);
+	}
+}
+
+void UDiscordStorageManager::ReadFile(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& Name,
+	TArray<uint8>& Data, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = ReadFile(Name, [&Data, Action](discord::Result Result, TArray<uint8>& ResultData)
+	{
+		if (Result == discord::Result::Ok) Data = MoveTemp(ResultData);
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordStorageManager::ReadFile(const FString& Name, TFunction<void(discord::Result, TArray<uint8>&)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(StorageManager_ReadFile);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		TArray<uint8> NoData;
+		Callback(discord::Result::InternalError, NoData);
+		return {};
+	}
+
+	const TSharedRef<FRead, ESPMode::ThreadSafe> Read = MakeShared<FRead, ESPMode::ThreadSafe>(Name, GetChunkSize());
+
+	// The result is handed over from the read itself, so it's never copied on its way to the game thread
+	FDiscordOperationHandle Handle;
+	Read->Finish = DiscordSubsystem->WrapCallback(TFunction<void(discord::Result)>([Read, Callback = MoveTemp(Callback)](discord::Result Result)
+	{
+		Read->bStopped = true;
+
+		TArray<uint8> NoData;
+		Callback(Result, Result == discord::Result::Ok ? Read->Data : NoData);
+	}), TimeoutSeconds, Handle);
+	Read->Handle = Handle;
+	Read->ChunkTimeoutSeconds = TimeoutSeconds;
+
+	DiscordSubsystem->RunOnSdkThread([this, Read]
+	{
+		FDiscordFilename Filename = ToFilename(Read->Name);
+
+		discord::FileStat Stat{};
+		const auto Result = Internal_StorageManager->Stat(Filename.Get(), &Stat);
+		if (Result != discord::Result::Ok)
+		{
+			Read->Finish(Result);
+			return;
+		}
+
+		Read->AddPart(MoveTemp(Filename), Stat.GetSize());
+		BeginRead(Read);
+	});
+
+	return Handle;
+}
+
+FDiscordOperationHandle UDiscordStorageManager::StreamFile(const FString& Name, TFunction<void(TArrayView<const uint8>, uint64)> ChunkHandler,
+	TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(StorageManager_StreamFile);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	const TSharedRef<FRead, ESPMode::ThreadSafe> Read = MakeShared<FRead, ESPMode::ThreadSafe>(Name, GetChunkSize());
+	Read->ChunkHandler = MoveTemp(ChunkHandler);
+
+	FDiscordOperationHandle Handle;
+	Read->Finish = DiscordSubsystem->WrapCallback(TFunction<void(discord::Result)>([Read, Callback = MoveTemp(Callback)](discord::Result Result)
+	{
+		Read->bStopped = true;
+		Callback(Result);
+	}), TimeoutSeconds, Handle);
+	Read->Handle = Handle;
+	Read->ChunkTimeoutSeconds = TimeoutSeconds;
+
+	DiscordSubsystem->RunOnSdkThread([this, Read]
+	{
+		FDiscordFilename Filename = ToFilename(Read->Name);
+
+		discord::FileStat Stat{};
+		const auto Result = Internal_StorageManager->Stat(Filename.Get(), &Stat);
+		if (Result != discord::Result::Ok)
+		{
+			Read->Finish(Result);
+			return;
+		}
+
+		Read->AddPart(MoveTemp(Filename), Stat.GetSize());
+		BeginRead(Read);
+	});
+
+	return Handle;
+}
+
+void UDiscordStorageManager::WriteFile(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& Name,
+	const TArray<uint8>& Data, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = WriteFile(Name, Data, [Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordStorageManager::WriteFile(const FString& Name, TArray<uint8> Data, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(StorageManager_WriteFile);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, Manager = Internal_StorageManager, Name, Data = MoveTemp(Data), WrappedCallback = MoveTemp(WrappedCallback)]() mutable
+	{
+		SaveFileManifests.Remove(Name);
+
+		// Moving an array keeps its allocation, so the SDK can borrow it while the callback keeps it alive
+		uint8* DataPtr = Data.GetData();
+		const uint32 DataLength = Data.Num();
+		Manager->WriteAsync(ToFilename(Name).Get(), DataPtr, DataLength, [Data = MoveTemp(Data), WrappedCallback](discord::Result Result)
+		{
+			WrappedCallback(Result);
+		});
+	});
+
+	return Handle;
+}
+
+void UDiscordStorageManager::ReadSaveFile(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& Name,
+	TArray<uint8>& Data, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = ReadSaveFile(Name, [&Data, Action](discord::Result Result, TArray<uint8>& ResultData)
+	{
+		if (Result == discord::Result::Ok) Data = MoveTemp(ResultData);
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordStorageManager::ReadSaveFile(const FString& Name, TFunction<void(discord::Result, TArray<uint8>&)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(StorageManager_ReadSaveFile);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		TArray<uint8> NoData;
+		Callback(discord::Result::InternalError, NoData);
+		return {};
+	}
+
+	const TSharedRef<FRead, ESPMode::ThreadSafe> Read = MakeShared<FRead, ESPMode::ThreadSafe>(Name, GetChunkSize());
+
+	FDiscordOperationHandle Handle;
+	Read->Finish = DiscordSubsystem->WrapCallback(TFunction<void(discord::Result)>([Read, Callback = MoveTemp(Callback)](discord::Result Result)
+	{
+		Read->bStopped = true;
+
+		TArray<uint8> NoData;
+		Callback(Result, Result == discord::Result::Ok ? Read->Data : NoData);
+	}), TimeoutSeconds, Handle);
+	Read->Handle = Handle;
+	Read->ChunkTimeoutSeconds = TimeoutSeconds;
+
+	DiscordSubsystem->RunOnSdkThread([this, Read]
+	{
+		FSaveFileManifest Manifest;
+		const auto Result = ReadManifest(Read->Name, Manifest);
+		if (Result != discord::Result::Ok)
+		{
+			Read->Finish(Result);
+			return;
+		}
+
+		for (int32 Index = 0; Index < Manifest.RegionHashes.Num(); Index++)
+		{
+			const uint64 RegionOffset = static_cast<uint64>(Index) * Manifest.RegionSize;
+			Read->AddPart(GetRegionFilename(Read->Name, Index), FMath::Min<uint64>(Manifest.RegionSize, Manifest.Size - RegionOffset));
+		}
+
+		Read->PartHashes = Manifest.RegionHashes;
+		Read->ChunkSize = FMath::Max<uint64>(Read->ChunkSize, Manifest.RegionSize);
+
+		// Known from now on, so the next write only writes the regions that differ from it
+		SaveFileManifests.Add(Read->Name, MoveTemp(Manifest));
+
+		BeginRead(Read);
+	});
+
+	return Handle;
+}
+
+void UDiscordStorageManager::WriteSaveFile(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& Name,
+	const TArray<uint8>& Data, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = WriteSaveFile(Name, Data, [Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordStorageManager::WriteSaveFile(const FString& Name, TArray<uint8> Data, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(StorageManager_WriteSaveFile);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	const uint32 RegionSize = FMath::Max(GetDefault<UDiscordSettings>()->SaveFileRegionSize, 4096);
+
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, Name, Data = MoveTemp(Data), RegionSize, WrappedCallback = MoveTemp(WrappedCallback)]() mutable
+	{
+		WriteSaveFileRegions(Name, MoveTemp(Data), RegionSize, MoveTemp(WrappedCallback));
+	});
+
+	return Handle;
+}
+
+void UDiscordStorageManager::WriteSaveFileRegions(const FString& Name, TArray<uint8>&& Data, const uint32 RegionSize, TFunction<void(discord::Result)>&& Callback)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(StorageManager_WriteSaveFileRegions);
+
+	// Unknown until the save file is read or written once, in which case it's read from its manifest
+	FSaveFileManifest OldManifest;
+	if (const FSaveFileManifest* KnownManifest = SaveFileManifests.Find(Name))
+	{
+		OldManifest = *KnownManifest;
+	}
+	else
+	{
+		ReadManifest(Name, OldManifest);
+	}
+
+	const TSharedRef<FSaveFileWrite, ESPMode::ThreadSafe> Write = MakeShared<FSaveFileWrite, ESPMode::ThreadSafe>();
+	Write->Name = Name;
+	Write->Data = MoveTemp(Data);
+	Write->Callback = MoveTemp(Callback);
+	Write->Manifest.RegionSize = RegionSize;
+	Write->Manifest.Size = Write->Data.Num();
+	Write->NumOldRegions = OldManifest.RegionHashes.Num();
+
+	const int32 NumRegions = FMath::DivideAndRoundUp<int32>(Write->Data.Num(), RegionSize);
+	const bool bSameRegions = OldManifest.RegionSize == RegionSize;
+
+	TArray<int32> DirtyRegions;
+	Write->Manifest.RegionHashes.SetNumUninitialized(NumRegions);
+	for (int32 Index = 0; Index < NumRegions; Index++)
+	{
+		const int64 Offset = static_cast<int64>(Index) * RegionSize;
+		const uint64 Hash = HashRegion(Write->Data.GetData() + Offset, FMath::Min<int64>(RegionSize, Write->Data.Num() - Offset));
+		Write->Manifest.RegionHashes[Index] = Hash;
+
+		if (!bSameRegions || !OldManifest.RegionHashes.IsValidIndex(Index) || OldManifest.RegionHashes[Index] != Hash)
+		{
+			DirtyRegions.Add(Index);
+		}
+	}
+
+	if (DirtyRegions.Num() == 0 && bSameRegions && OldManifest.Size == Write->Manifest.Size)
+	{
+		LOG_DISCORD(Verbose, "Save file {Name} didn't change, nothing was written", Name);
+		Write->Callback(discord::Result::Ok);
+		return;
+	}
+
+	LOG_DISCORD(Verbose, "Writing {Dirty} of the {Total} regions of save file {Name}", DirtyRegions.Num(), NumRegions, Name);
+
+	// The regions on disk stop matching it as soon as the first one is written
+	SaveFileManifests.Remove(Name);
+
+	if (DirtyRegions.Num() == 0)
+	{
+		WriteManifest(Write);
+		return;
+	}
+
+	Write->NumPending = DirtyRegions.Num();
+	for (const int32 Index : DirtyRegions)
+	{
+		const int64 Offset = static_cast<int64>(Index) * RegionSize;
+		const uint32 Length = static_cast<uint32>(FMath::Min<int64>(RegionSize, Write->Data.Num() - Offset));
+
+		Internal_StorageManager->WriteAsync(GetRegionFilename(Name, Index).Get(), Write->Data.GetData() + Offset, Length, [this, Write](discord::Result Result)
+		{
+			if (Result != discord::Result::Ok) Write->Result = Result;
+			if (--Write->NumPending > 0) return;
+
+			// Written last, so the manifest never points to regions that weren't
+			if (Write->Result == discord::Result::Ok)
+			{
+				WriteManifest(Write);
+			}
+			else
+			{
+				Write->Callback(Write->Result);
+			}
+		});
+	}
+}
+
+void UDiscordStorageManager::WriteManifest(const TSharedRef<FSaveFileWrite, ESPMode::ThreadSafe>& Write)
+{
+	FSaveFileManifest& Manifest = Write->Manifest;
+
+	FMemoryWriter Writer(Write->ManifestData);
+	uint32 Magic = SaveFileMagic;
+	uint32 Version = SaveFileVersion;
+	uint32 NumRegions = Manifest.RegionHashes.Num();
+	Writer << Magic << Version << Manifest.RegionSize << NumRegions << Manifest.Size;
+	Writer.Serialize(Manifest.RegionHashes.GetData(), NumRegions * sizeof(uint64));
+
+	Internal_StorageManager->WriteAsync(ToFilename(Write->Name).Get(), Write->ManifestData.GetData(), Write->ManifestData.Num(), [this, Write](discord::Result Result)
+	{
+		if (Result == discord::Result::Ok)
+		{
+			// The regions past the end are left over from a larger save
+			for (int32 Index = Write->Manifest.RegionHashes.Num(); Index < Write->NumOldRegions; Index++)
+			{
+				Internal_StorageManager->Delete(GetRegionFilename(Write->Name, Index).Get());
+			}
+
+			SaveFileManifests.Add(Write->Name, MoveTemp(Write->Manifest));
+		}
+
+		Write->Callback(Result);
+	});
+}
+
+bool UDiscordStorageManager::RemoveFile(const FString& Name)
+{
+	DISCORD_SCOPE_CALL(StorageManager_RemoveFile);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	SaveFileManifests.Remove(Name);
+
+	const auto Result = Internal_StorageManager->Delete(ToFilename(Name).Get());
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return true;
+}
+
+bool UDiscordStorageManager::RemoveSaveFile(const FString& Name)
+{
+	DISCORD_SCOPE_CALL(StorageManager_RemoveSaveFile);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+
+	FSaveFileManifest Manifest;
+	if (!SaveFileManifests.RemoveAndCopyValue(Name, Manifest))
+	{
+		const auto Result = ReadManifest(Name, Manifest);
+		if (Result != discord::Result::Ok)
+		{
+			LOG_DISCORD_ERROR(Result);
+			return false;
+		}
+	}
+
+	// The manifest goes first, so that a save file is never left pointing to missing regions
+	const auto Result = Internal_StorageManager->Delete(ToFilename(Name).Get());
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Manifest.RegionHashes.Num(); Index++)
+	{
+		Internal_StorageManager->Delete(GetRegionFilename(Name, Index).Get());
+	}
+
+	return true;
+}
+
+bool UDiscordStorageManager::FileExists(const FString& Name) const
+{
+	DISCORD_SCOPE_CALL(StorageManager_FileExists);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	bool bExists = false;
+	const auto Result = Internal_StorageManager->Exists(ToFilename(Name).Get(), &bExists);
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return false;
+	}
+
+	return bExists;
+}
+
+static FDiscordFileStat ToFileStat(const discord::FileStat& Stat)
+{
+	FDiscordFileStat FileStat;
+	FileStat.Filename = UTF8_TO_TCHAR(Stat.GetFilename());
+	FileStat.Size = static_cast<int64>(Stat.GetSize());
+	FileStat.LastModified = FDateTime::FromUnixTimestamp(static_cast<int64>(Stat.GetLastModified()));
+	return FileStat;
+}
+
+bool UDiscordStorageManager::GetFileStat(const FString& Name, FDiscordFileStat& Stat) const
+{
+	DISCORD_SCOPE_CALL(StorageManager_GetFileStat);
+
+	if (!DiscordSubsystem->IsActive()) return false;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	discord::FileStat SdkStat{};
+	if (Internal_StorageManager->Stat(ToFilename(Name).Get(), &SdkStat) != discord::Result::Ok) return false;
+
+	Stat = ToFileStat(SdkStat);
+	return true;
+}
+
+TArray<FDiscordFileStat> UDiscordStorageManager::GetFileStats() const
+{
+	DISCORD_SCOPE_CALL(StorageManager_GetFileStats);
+
+	TArray<FDiscordFileStat> Stats;
+	if (!DiscordSubsystem->IsActive()) return Stats;
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	int32 Count = 0;
+	Internal_StorageManager->Count(&Count);
+
+	Stats.Reserve(Count);
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		discord::FileStat SdkStat{};
+		if (Internal_StorageManager->StatAt(Index, &SdkStat) == discord::Result::Ok)
+		{
+			Stats.Add(ToFileStat(SdkStat));
+		}
+	}
+
+	return Stats;
+}
+
+FString UDiscordStorageManager::GetPath() const
+{
+	DISCORD_SCOPE_CALL(StorageManager_GetPath);
+
+	if (!DiscordSubsystem->IsActive()) return FString();
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	char Path[4096];
+	const auto Result = Internal_StorageManager->GetPath(Path);
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return FString();
+	}
+
+	return UTF8_TO_TCHAR(Path);
+}
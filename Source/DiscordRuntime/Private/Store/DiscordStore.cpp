@@ -0,0 +1,29 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Store/DiscordStore.h"
+
+#include "DiscordStats.h"
+#include "Discord/types.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordStore)
+
+
+FDiscordSku::FDiscordSku(discord::Sku const& Sku)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordSku_FromDiscordType);
+
+	ID = Sku.GetId();
+	Type = static_cast<EDiscordSkuTypes::Type>(Sku.GetType());
+	Name = UTF8_TO_TCHAR(Sku.GetName());
+	PriceAmount = Sku.GetPrice().GetAmount();
+	PriceCurrency = UTF8_TO_TCHAR(Sku.GetPrice().GetCurrency());
+}
+
+FDiscordEntitlement::FDiscordEntitlement(discord::Entitlement const& Entitlement)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordEntitlement_FromDiscordType);
+
+	ID = Entitlement.GetId();
+	Type = static_cast<EDiscordEntitlementTypes::Type>(Entitlement.GetType());
+	SkuID = Entitlement.GetSkuId();
+}
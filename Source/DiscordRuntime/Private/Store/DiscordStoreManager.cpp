@@ -0,0 +1,288 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Store/DiscordStoreManager.h"
+
+#include "DiscordLatentAction.h"
+#include "DiscordLogChannel.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Discord/store_manager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordStoreManager)
+
+
+UDiscordStoreManager::UDiscordStoreManager()
+{
+	const auto Outer = GetOuter();
+	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
+	{
+		DiscordSubsystem = Cast<UDiscordSubsystem>(GetOuter());
+	}
+}
+
+void UDiscordStoreManager::Initialize(discord::StoreManager* StoreManager)
+{
+	Internal_StoreManager = StoreManager;
+
+	Internal_OnEntitlementCreateCallback = Internal_StoreManager->OnEntitlementCreate.Connect([this](discord::Entitlement const& Entitlement)
+	{
+		DiscordSubsystem->RunOnGameThread([this, Created = FDiscordEntitlement(Entitlement)]
+		{
+			AddEntitlement(Created);
+			OnEntitlementCreatedNative.Broadcast(Created);
+			OnEntitlementCreated.Broadcast(Created);
+		});
+	});
+
+	Internal_OnEntitlementDeleteCallback = Internal_StoreManager->OnEntitlementDelete.Connect([this](discord::Entitlement const& Entitlement)
+	{
+		DiscordSubsystem->RunOnGameThread([this, Deleted = FDiscordEntitlement(Entitlement)]
+		{
+			RemoveEntitlement(Deleted.ID);
+			OnEntitlementDeletedNative.Broadcast(Deleted);
+			OnEntitlementDeleted.Broadcast(Deleted);
+		});
+	});
+}
+
+void UDiscordStoreManager::BeginDestroy()
+{
+	if (Internal_StoreManager)
+	{
+		Internal_StoreManager->OnEntitlementCreate.Disconnect(Internal_OnEntitlementCreateCallback);
+		Internal_StoreManager->OnEntitlementDelete.Disconnect(Internal_OnEntitlementDeleteCallback);
+	}
+	
+	UObject::BeginDestroy();
+}
+
+void UDiscordStoreManager::AddEntitlement(const FDiscordEntitlement& Entitlement)
+{
+	// The same entitlement can be both fetched and announced
+	RemoveEntitlement(Entitlement.ID);
+
+	Entitlements.Add(Entitlement.ID, Entitlement);
+	OwnedSkus.FindOrAdd(Entitlement.SkuID)++;
+}
+
+bool UDiscordStoreManager::RemoveEntitlement(const int64 EntitlementID)
+{
+	FDiscordEntitlement Removed;
+	if (!Entitlements.RemoveAndCopyValue(EntitlementID, Removed)) return false;
+
+	int32& Count = OwnedSkus.FindChecked(Removed.SkuID);
+	if (--Count == 0)
+	{
+		OwnedSkus.Remove(Removed.SkuID);
+	}
+	return true;
+}
+
+void UDiscordStoreManager::FetchEntitlements(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = FetchEntitlements([Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordStoreManager::FetchEntitlements(TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(StoreManager_FetchEntitlements);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Internal_StoreManager->FetchEntitlements([this, WrappedCallback](discord::Result Result)
+		{
+			if (Result == discord::Result::Ok)
+			{
+				// Read right away on the pumping thread, and handed over before the callback fires. Entitlements
+				// created or deleted later are handed over after it, so they're applied on top.
+				int32 Count = 0;
+				Internal_StoreManager->CountEntitlements(&Count);
+
+				TArray<FDiscordEntitlement> Fetched;
+				Fetched.Reserve(Count);
+
+				for (int32 Index = 0; Index < Count; Index++)
+				{
+					discord::Entitlement Entitlement;
+					if (Internal_StoreManager->GetEntitlementAt(Index, &Entitlement) == discord::Result::Ok)
+					{
+						Fetched.Emplace(Entitlement);
+					}
+				}
+
+				DiscordSubsystem->RunOnGameThread([this, Fetched = MoveTemp(Fetched)]
+				{
+					Entitlements.Reset();
+					OwnedSkus.Reset();
+					for (const FDiscordEntitlement& Entitlement : Fetched)
+					{
+						AddEntitlement(Entitlement);
+					}
+					bEntitlementsFetched = true;
+				});
+			}
+			else
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+
+			WrappedCallback(Result);
+		});
+	});
+
+	return Handle;
+}
+
+void UDiscordStoreManager::FetchSkus(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = FetchSkus([Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordStoreManager::FetchSkus(TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(StoreManager_FetchSkus);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Internal_StoreManager->FetchSkus([this, WrappedCallback](discord::Result Result)
+		{
+			if (Result == discord::Result::Ok)
+			{
+				// Read right away on the pumping thread, and handed over before the callback fires
+				int32 Count = 0;
+				Internal_StoreManager->CountSkus(&Count);
+
+				TArray<FDiscordSku> Fetched;
+				Fetched.Reserve(Count);
+
+				for (int32 Index = 0; Index < Count; Index++)
+				{
+					discord::Sku Sku;
+					if (Internal_StoreManager->GetSkuAt(Index, &Sku) == discord::Result::Ok)
+					{
+						Fetched.Emplace(Sku);
+					}
+				}
+
+				DiscordSubsystem->RunOnGameThread([this, Fetched = MoveTemp(Fetched)]
+				{
+					Skus.Reset();
+					for (const FDiscordSku& Sku : Fetched)
+					{
+						Skus.Add(Sku.ID, Sku);
+					}
+				});
+			}
+			else
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+
+			WrappedCallback(Result);
+		});
+	});
+
+	return Handle;
+}
+
+bool UDiscordStoreManager::GetEntitlement(const int64 EntitlementID, FDiscordEntitlement& Entitlement) const
+{
+	const FDiscordEntitlement* Found = Entitlements.Find(EntitlementID);
+	if (!Found) return false;
+
+	Entitlement = *Found;
+	return true;
+}
+
+TArray<FDiscordEntitlement> UDiscordStoreManager::GetEntitlements() const
+{
+	TArray<FDiscordEntitlement> Result;
+	Entitlements.GenerateValueArray(Result);
+	return Result;
+}
+
+bool UDiscordStoreManager::GetSku(const int64 SkuID, FDiscordSku& Sku) const
+{
+	const FDiscordSku* Found = Skus.Find(SkuID);
+	if (!Found) return false;
+
+	Sku = *Found;
+	return true;
+}
+
+TArray<FDiscordSku> UDiscordStoreManager::GetSkus() const
+{
+	TArray<FDiscordSku> Result;
+	Skus.GenerateValueArray(Result);
+	return Result;
+}
+
+void UDiscordStoreManager::StartPurchase(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins, const int64 SkuID)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = StartPurchase(SkuID, [Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordStoreManager::StartPurchase(const int64 SkuID, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(StoreManager_StartPurchase);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([this, SkuID, WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Internal_StoreManager->StartPurchase(SkuID, [WrappedCallback](discord::Result Result)
+		{
+			if (Result != discord::Result::Ok)
+			{
+				LOG_DISCORD_ERROR(Result);
+			}
+
+			WrappedCallback(Result);
+		});
+	});
+
+	return Handle;
+}
@@ -0,0 +1,154 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Discord/event.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#include <functional>
+#include <vector>
+
+
+/**
+ * The std::function based discord::Event that shipped with the SDK, kept as the baseline of the benchmarks.
+ */
+template <typename... ArgTypes>
+class TDiscordLegacyEvent final
+{
+public:
+	using FToken = int;
+
+	TDiscordLegacyEvent() { Slots.reserve(4); }
+
+	template <typename HandlerType>
+	FToken Connect(HandlerType Handler)
+	{
+		Slots.emplace_back(FSlot{NextToken, MoveTemp(Handler)});
+		return NextToken++;
+	}
+
+	void Disconnect(const FToken Token)
+	{
+		for (FSlot& Slot : Slots)
+		{
+			if (Slot.Token == Token)
+			{
+				Slot = Slots.back();
+				Slots.pop_back();
+				break;
+			}
+		}
+	}
+
+	void operator()(ArgTypes... Args)
+	{
+		for (const FSlot& Slot : Slots)
+		{
+			Slot.Handler(Forward<ArgTypes>(Args)...);
+		}
+	}
+
+private:
+	struct FSlot
+	{
+		FToken Token;
+		std::function<void(ArgTypes...)> Handler;
+	};
+
+	FToken NextToken = 0;
+	std::vector<FSlot> Slots;
+};
+
+
+namespace DiscordEventBenchmark
+{
+	constexpr int32 NumDispatchHandlers = 16;
+	constexpr int32 NumDispatches = 100000;
+	constexpr int32 NumChurnHandlers = 1024;
+	constexpr int32 NumChurnRounds = 100;
+
+	/** Connects handlers like the managers do, capturing a pointer, then broadcasts to them. Returns ns per handler call. */
+	template <typename EventType>
+	double MeasureDispatch(int64& Sink)
+	{
+		EventType Event;
+		for (int32 Index = 0; Index < NumDispatchHandlers; Index++)
+		{
+			Event.Connect([&Sink](const int64 Value) { Sink += Value; });
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < NumDispatches; Index++)
+		{
+			Event(Index);
+		}
+		return (FPlatformTime::Seconds() - StartTime) * 1e9 / (NumDispatches * NumDispatchHandlers);
+	}
+
+	/** Connects handlers, then disconnects them in a random order. Returns ns per connect and disconnect pair. */
+	template <typename EventType>
+	double MeasureChurn(int64& Sink, const TArray<int32>& DisconnectOrder)
+	{
+		EventType Event;
+		TArray<int> Tokens;
+		Tokens.SetNumUninitialized(NumChurnHandlers);
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Round = 0; Round < NumChurnRounds; Round++)
+		{
+			for (int32 Index = 0; Index < NumChurnHandlers; Index++)
+			{
+				Tokens[Index] = Event.Connect([&Sink](const int64 Value) { Sink += Value; });
+			}
+
+			for (const int32 Index : DisconnectOrder)
+			{
+				Event.Disconnect(Tokens[Index]);
+			}
+		}
+		return (FPlatformTime::Seconds() - StartTime) * 1e9 / (NumChurnRounds * NumChurnHandlers);
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDiscordEventBenchmark, "Discord.Event.Benchmark",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FDiscordEventBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace DiscordEventBenchmark;
+
+	using FEvent = discord::Event<int64>;
+	using FLegacyEvent = TDiscordLegacyEvent<int64>;
+
+	TArray<int32> DisconnectOrder;
+	DisconnectOrder.SetNumUninitialized(NumChurnHandlers);
+	for (int32 Index = 0; Index < NumChurnHandlers; Index++)
+	{
+		DisconnectOrder[Index] = Index;
+	}
+
+	FRandomStream RandomStream(0x5eed);
+	for (int32 Index = NumChurnHandlers - 1; Index > 0; Index--)
+	{
+		DisconnectOrder.Swap(Index, RandomStream.RandRange(0, Index));
+	}
+
+	int64 Sink = 0;
+	const double LegacyDispatch = MeasureDispatch<FLegacyEvent>(Sink);
+	const double Dispatch = MeasureDispatch<FEvent>(Sink);
+	const double LegacyChurn = MeasureChurn<FLegacyEvent>(Sink, DisconnectOrder);
+	const double Churn = MeasureChurn<FEvent>(Sink, DisconnectOrder);
+
+	AddInfo(FString::Printf(TEXT("Dispatch: %.2f ns per handler, was %.2f ns"), Dispatch, LegacyDispatch));
+	AddInfo(FString::Printf(TEXT("Connect and disconnect: %.2f ns per handler, was %.2f ns"), Churn, LegacyChurn));
+
+	// Keeps the handlers from being optimized away
+	TestTrue(TEXT("Handlers ran"), Sink != 0);
+	return true;
+}
+
+#endif
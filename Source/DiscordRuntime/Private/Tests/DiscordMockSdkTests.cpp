@@ -0,0 +1,215 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_DISCORD_MOCK_SDK
+
+#include "DiscordRuntime.h"
+#include "DiscordSettings.h"
+#include "DiscordSubsystem.h"
+#include "Discord/lobby_manager.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Lobbies/DiscordLobbyManager.h"
+#include "Misc/AutomationTest.h"
+#include "Mock/DiscordMockSdk.h"
+#include "Relationships/DiscordRelationshipManager.h"
+#include "Users/DiscordUserManager.h"
+
+
+/**
+ * A standalone game instance whose Discord subsystem runs on the mock SDK, pumped on the game thread by `Pump`. The
+ * settings and the SDK selection are put back when it goes out of scope.
+ */
+class FDiscordMockSubsystemScope final
+{
+public:
+	FDiscordMockSubsystemScope()
+	{
+		UDiscordSettings* Settings = GetMutableDefault<UDiscordSettings>();
+		SavedClientID = Settings->ClientID;
+		bSavedRunCallbacksOnWorkerThread = Settings->bRunCallbacksOnWorkerThread;
+		SavedMaxPumpRate = Settings->MaxPumpRate;
+		SavedIdlePumpRate = Settings->IdlePumpRate;
+
+		// Every tick should pump, so that each step of a test sees the events of the previous one
+		Settings->ClientID = FMath::Max<int64>(Settings->ClientID, 1);
+		Settings->bRunCallbacksOnWorkerThread = false;
+		Settings->MaxPumpRate = 0.f;
+		Settings->IdlePumpRate = 0.f;
+
+		bWasUsingMockSdk = FDiscordRuntimeModule::Get().IsUsingMockSdk();
+		FDiscordRuntimeModule::Get().SetUsingMockSdk(true);
+
+		GameInstance = NewObject<UGameInstance>(GEngine);
+		GameInstance->AddToRoot();
+		GameInstance->InitializeStandalone();
+
+		Subsystem = GameInstance->GetSubsystem<UDiscordSubsystem>();
+		Mock = Subsystem && Subsystem->IsActive() ? FDiscordMockSdk::Get() : nullptr;
+		if (Mock) Mock->SetLatency(0.0);
+	}
+
+	~FDiscordMockSubsystemScope()
+	{
+		UWorld* World = GameInstance->GetWorld();
+		GameInstance->Shutdown();
+		GameInstance->RemoveFromRoot();
+
+		if (World)
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		FDiscordRuntimeModule::Get().SetUsingMockSdk(bWasUsingMockSdk);
+
+		UDiscordSettings* Settings = GetMutableDefault<UDiscordSettings>();
+		Settings->ClientID = SavedClientID;
+		Settings->bRunCallbacksOnWorkerThread = bSavedRunCallbacksOnWorkerThread;
+		Settings->MaxPumpRate = SavedMaxPumpRate;
+		Settings->IdlePumpRate = SavedIdlePumpRate;
+	}
+
+	/**
+	 * Whether the subsystem started on the mock. Only one mock can run at a time, so this fails if another one is.
+	 */
+	bool IsValid() const { return Mock != nullptr; }
+
+	/**
+	 * Runs one frame of the subsystem: fires the events that are due, then flushes the notifications and messages.
+	 */
+	void Pump() const { Subsystem->Tick(0.f); }
+
+	UDiscordSubsystem* Subsystem = nullptr;
+	FDiscordMockSdk* Mock = nullptr;
+
+private:
+	UGameInstance* GameInstance = nullptr;
+
+	int64 SavedClientID = -1;
+	bool bSavedRunCallbacksOnWorkerThread = false;
+	float SavedMaxPumpRate = 0.f;
+	float SavedIdlePumpRate = 0.f;
+	bool bWasUsingMockSdk = false;
+};
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDiscordMockRelationshipRefreshTest, "Discord.Mock.RelationshipRefresh", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+bool FDiscordMockRelationshipRefreshTest::RunTest(const FString& Parameters)
+{
+	if (FDiscordMockSdk::Get())
+	{
+		AddWarning(TEXT("Skipped, the mock SDK is already used by another subsystem"));
+		return true;
+	}
+
+	const FDiscordMockSubsystemScope Scope;
+	if (!TestTrue(TEXT("Subsystem runs on the mock SDK"), Scope.IsValid())) return false;
+
+	UDiscordRelationshipManager* RelationshipManager = Scope.Subsystem->GetRelationshipManager();
+
+	int32 NumRefreshes = 0;
+	TSet<int64> UpdatedUserIDs;
+	RelationshipManager->OnRefreshedNative.AddLambda([&NumRefreshes] { NumRefreshes++; });
+	RelationshipManager->OnRelationshipsUpdatedNative.AddLambda([&UpdatedUserIDs](const TSet<int64>& UserIDs) { UpdatedUserIDs.Append(UserIDs); });
+
+	DiscordRelationship Relationship = {};
+	Relationship.type = DiscordRelationshipType_Friend;
+	Relationship.user.id = 42;
+	FCStringAnsi::Strncpy(Relationship.user.username, "MockFriend", sizeof(Relationship.user.username));
+	Relationship.presence.status = DiscordStatus_Online;
+
+	Scope.Mock->SetRelationship(Relationship);
+	Scope.Mock->FireRelationshipRefresh();
+	Scope.Pump();
+
+	// The update and the refresh came in on the same pump, so only the refresh is broadcast
+	TestEqual(TEXT("Refreshes"), NumRefreshes, 1);
+	TestEqual(TEXT("Updates during the refresh"), UpdatedUserIDs.Num(), 0);
+	TestEqual(TEXT("Relationships"), RelationshipManager->GetRelationshipCount(), 1);
+	TestEqual(TEXT("Online friends"), RelationshipManager->GetFriendCount(EDiscordFriendFilters::Online), 1);
+
+	FDiscordRelationship Found;
+	if (TestTrue(TEXT("Relationship found"), RelationshipManager->GetRelationship(42, Found)))
+	{
+		TestTrue(TEXT("Type"), Found.Type == EDiscordRelationshipTypes::Friend);
+		TestEqual(TEXT("Username"), Found.User.Username, FString(TEXT("MockFriend")));
+	}
+
+	// A friend going offline only updates their row
+	Relationship.presence.status = DiscordStatus_Offline;
+	Scope.Mock->SetRelationship(Relationship);
+	Scope.Pump();
+
+	TestEqual(TEXT("Refreshes after the update"), NumRefreshes, 1);
+	TestTrue(TEXT("Update reported"), UpdatedUserIDs.Contains(42));
+	TestEqual(TEXT("Online friends after the update"), RelationshipManager->GetFriendCount(EDiscordFriendFilters::Online), 0);
+	TestEqual(TEXT("Friends after the update"), RelationshipManager->GetFriendCount(EDiscordFriendFilters::All), 1);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDiscordMockLobbyMessageTest, "Discord.Mock.LobbyMessageRoundTrip", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+bool FDiscordMockLobbyMessageTest::RunTest(const FString& Parameters)
+{
+	if (FDiscordMockSdk::Get())
+	{
+		AddWarning(TEXT("Skipped, the mock SDK is already used by another subsystem"));
+		return true;
+	}
+
+	const FDiscordMockSubsystemScope Scope;
+	if (!TestTrue(TEXT("Subsystem runs on the mock SDK"), Scope.IsValid())) return false;
+
+	UDiscordLobbyManager* LobbyManager = Scope.Subsystem->GetLobbyManager();
+
+	Scope.Mock->FireCurrentUserUpdate();
+	Scope.Pump();
+
+	const int64 CurrentUserID = Scope.Subsystem->GetUserManager()->GetCurrentUserID();
+	if (!TestNotEqual(TEXT("Current user known"), CurrentUserID, static_cast<int64>(-1))) return false;
+
+	int64 LobbyID = 0;
+	LobbyManager->CreateLobby(EDiscordLobbyTypes::Private, 4, false, {}, [&LobbyID](discord::Result Result, discord::Lobby const& Lobby)
+	{
+		if (Result == discord::Result::Ok) LobbyID = Lobby.GetId();
+	});
+	Scope.Pump();
+
+	if (!TestNotEqual(TEXT("Lobby created"), LobbyID, static_cast<int64>(0))) return false;
+	if (!TestTrue(TEXT("Network connected"), LobbyManager->ConnectNetwork(LobbyID))) return false;
+	if (!TestTrue(TEXT("Channel opened"), LobbyManager->OpenNetworkChannel(LobbyID, 0, true))) return false;
+
+	int32 NumReceived = 0;
+	int64 ReceivedUserID = 0;
+	TArray<uint8> Received;
+	LobbyManager->OnNetworkMessageNative.AddLambda([&](const int64 MessageLobbyID, const int64 UserID, const uint8 ChannelID, const TArrayView<const uint8> Data)
+	{
+		if (MessageLobbyID != LobbyID || ChannelID != 0) return;
+
+		NumReceived++;
+		ReceivedUserID = UserID;
+		Received = TArray<uint8>(Data);
+	});
+
+	// Messages to the current user loop back: queued this frame, flushed at its end, and received on the next pump
+	const TArray<uint8> Sent = {1, 2, 3, 4, 5};
+	TestTrue(TEXT("Message queued"), LobbyManager->SendNetworkMessage(LobbyID, CurrentUserID, 0, Sent));
+	Scope.Pump();
+	Scope.Pump();
+
+	TestEqual(TEXT("Messages received"), NumReceived, 1);
+	TestEqual(TEXT("Sender"), ReceivedUserID, CurrentUserID);
+	TestTrue(TEXT("Payload"), Received == Sent);
+	TestEqual(TEXT("Bytes handed to the SDK"), Scope.Mock->GetNetworkBytesSent(), static_cast<int64>(Sent.Num()));
+	TestEqual(TEXT("Messages counted by the stats"), LobbyManager->GetNetworkStats().MessagesReceived, 1);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,93 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DiscordLogChannel.h"
+#include "DiscordOperationTable.h"
+#include "Discord/types.h"
+#include "Misc/AutomationTest.h"
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDiscordOperationTableAllocationTest, "Discord.OperationTable.SteadyStateAllocations",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+bool FDiscordOperationTableAllocationTest::RunTest(const FString& Parameters)
+{
+	using FCallback = TFunction<void(discord::Result, const int64&)>;
+	using FOperation = TDiscordPendingOperation<discord::Result, const int64&>;
+
+	constexpr int32 NumOperations = 256;
+	constexpr double TimeoutSeconds = 1.0;
+
+	FDiscordOperationTable OperationTable(0.0);
+	double Now = 0.0;
+	int32 NumSucceeded = 0;
+	int32 NumTimedOut = 0;
+
+	// The callbacks are built up front, since a TFunction allocates its functor when it's created
+	const auto MakeCallbacks = [&]
+	{
+		TArray<FCallback> Callbacks;
+		Callbacks.Reserve(NumOperations);
+		for (int32 Index = 0; Index < NumOperations; Index++)
+		{
+			Callbacks.Add([&NumSucceeded, &NumTimedOut](const discord::Result Result, const int64&)
+			{
+				(Result == discord::Result::Ok ? NumSucceeded : NumTimedOut)++;
+			});
+		}
+		return Callbacks;
+	};
+
+	// Half of the requests are answered, the other half time out
+	TArray<FDiscordOperationHandle> Handles;
+	Handles.Reserve(NumOperations);
+	const auto RunRound = [&](TArray<FCallback>& Callbacks)
+	{
+		Handles.Reset();
+		for (FCallback& Callback : Callbacks)
+		{
+			Handles.Add(OperationTable.Add(TimeoutSeconds, MakeUnique<FOperation>(MoveTemp(Callback))));
+		}
+
+		for (int32 Index = 0; Index < NumOperations; Index += 2)
+		{
+			if (const TUniquePtr<FDiscordPendingOperation> Operation = OperationTable.Remove(Handles[Index]))
+			{
+				static_cast<FOperation*>(Operation.Get())->Callback(discord::Result::Ok, Index);
+			}
+		}
+
+		Now += TimeoutSeconds + 1.0;
+		OperationTable.Advance(Now);
+	};
+
+	TArray<FCallback> WarmUpCallbacks = MakeCallbacks();
+	TArray<FCallback> MeasuredCallbacks = MakeCallbacks();
+
+	// Timeouts are logged as warnings, which would fail the test
+	const ELogVerbosity::Type PreviousVerbosity = LogDiscord.GetVerbosity();
+	LogDiscord.SetVerbosity(ELogVerbosity::Error);
+
+	// The first round fills the pool and the tables. Counting every heap allocation would mean hooking GMalloc, which
+	// the other threads use too, so the test checks instead that the memory they hold doesn't grow after that, i.e.
+	// that the operations and their timeouts are only recycled.
+	RunRound(WarmUpCallbacks);
+	const uint64 WarmTableSize = OperationTable.GetAllocatedSize();
+	const uint64 WarmPoolSize = FDiscordOperationTable::GetOperationPoolSize();
+
+	RunRound(MeasuredCallbacks);
+
+	LogDiscord.SetVerbosity(PreviousVerbosity);
+
+	TestEqual(TEXT("Completed requests"), NumSucceeded, NumOperations);
+	TestEqual(TEXT("Timed out requests"), NumTimedOut, NumOperations);
+	TestEqual(TEXT("Pending requests"), OperationTable.Num(), 0);
+	TestEqual(TEXT("Table memory in steady state"), static_cast<uint64>(OperationTable.GetAllocatedSize()), WarmTableSize);
+	TestEqual(TEXT("Pool memory in steady state"), static_cast<uint64>(FDiscordOperationTable::GetOperationPoolSize()), WarmPoolSize);
+	return true;
+}
+
+#endif
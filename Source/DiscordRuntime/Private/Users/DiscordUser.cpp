@@ -2,6 +2,7 @@
 
 #include "Users/DiscordUser.h"
 
+#include "DiscordStats.h"
 #include "Discord/types.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordUser)
@@ -9,6 +10,8 @@
 
 FDiscordUser::FDiscordUser(discord::User const& User)
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordUser_FromDiscordType);
+	
 	ID = User.GetId();
 	Username = User.GetUsername();
 	DEPRECATED_Discriminator = User.GetDiscriminator();
@@ -16,8 +19,21 @@ FDiscordUser::FDiscordUser(discord::User const& User)
 	bIsBot = User.GetBot();
 }
 
+FDiscordUser::FDiscordUser(const FDiscordUtf8User& User)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordUser_FromUtf8);
+
+	ID = User.ID;
+	Username = User.Username.ToString();
+	DEPRECATED_Discriminator = User.Discriminator.ToString();
+	Avatar = User.Avatar.ToString();
+	bIsBot = User.bIsBot;
+}
+
 discord::User FDiscordUser::ToDiscordType() const
 {
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordUser_ToDiscordType);
+	
 	discord::User User;
 		
 	User.SetId(ID);
@@ -28,3 +44,30 @@ discord::User FDiscordUser::ToDiscordType() const
 		
 	return User;
 }
+
+// CopyFromBuffer copies the whole native buffer, so each string must be exactly as large as the field it mirrors
+static_assert(sizeof(FDiscordUtf8User::Username) == sizeof(DiscordUser::username), "FDiscordUtf8User::Username doesn't match DiscordUser::username");
+static_assert(sizeof(FDiscordUtf8User::Discriminator) == sizeof(DiscordUser::discriminator), "FDiscordUtf8User::Discriminator doesn't match DiscordUser::discriminator");
+static_assert(sizeof(FDiscordUtf8User::Avatar) == sizeof(DiscordUser::avatar), "FDiscordUtf8User::Avatar doesn't match DiscordUser::avatar");
+
+FDiscordUtf8User::FDiscordUtf8User(discord::User const& User)
+{
+	ID = User.GetId();
+	Username.CopyFromBuffer(User.GetUsername());
+	Discriminator.CopyFromBuffer(User.GetDiscriminator());
+	Avatar.CopyFromBuffer(User.GetAvatar());
+	bIsBot = User.GetBot();
+}
+
+discord::User FDiscordUtf8User::ToDiscordType() const
+{
+	discord::User User;
+
+	User.SetId(ID);
+	User.SetUsername(Username.Get());
+	User.SetDiscriminator(Discriminator.Get());
+	User.SetAvatar(Avatar.Get());
+	User.SetBot(bIsBot);
+
+	return User;
+}
@@ -2,14 +2,60 @@
 
 #include "Users/DiscordUserManager.h"
 
+#include "DiscordCallbackPump.h"
 #include "DiscordLatentAction.h"
 #include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+#include "DiscordStats.h"
 #include "DiscordSubsystem.h"
 #include "Discord/user_manager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordUserManager)
 
 
+static constexpr EDiscordUserFlags::Type AllUserFlags[] =
+{
+	EDiscordUserFlags::Partner,
+	EDiscordUserFlags::HypeSquadEvents,
+	EDiscordUserFlags::HypeSquadHouse1,
+	EDiscordUserFlags::HypeSquadHouse2,
+	EDiscordUserFlags::HypeSquadHouse3,
+};
+
+/**
+ * The users of a `GetUsers` call, gathered as they come.
+ */
+struct FDiscordUserBatch
+{
+	TArray<int64> UserIDs;
+
+	TMap<int64, FDiscordUtf8User> Found;
+
+	int32 NumPending = 0;
+
+	/** The first error, if any. */
+	discord::Result Result = discord::Result::Ok;
+
+	TFunction<void(discord::Result, const TArray<FDiscordUser>&)> Callback;
+
+	void Finish()
+	{
+		TArray<FDiscordUser> Users;
+		Users.Reserve(UserIDs.Num());
+
+		for (const int64 UserID : UserIDs)
+		{
+			if (const FDiscordUtf8User* User = Found.Find(UserID))
+			{
+				Users.Emplace(*User);
+			}
+		}
+
+		Callback(Result, Users);
+	}
+};
+
+
 UDiscordUserManager::UDiscordUserManager()
 {
 	const auto Outer = GetOuter();
@@ -23,13 +69,27 @@ void UDiscordUserManager::Initialize(discord::UserManager* UserManager)
 {
 	Internal_UserManager = UserManager;
 
-	Internal_OnCurrentUserUpdateCallback = Internal_UserManager->OnCurrentUserUpdate.Connect([&]
+	CachedUsers.Empty(FMath::Max(GetDefault<UDiscordSettings>()->UserCacheSize, 1));
+
+	Internal_OnCurrentUserUpdateCallback = Internal_UserManager->OnCurrentUserUpdate.Connect([this]
 	{
-		FDiscordUser UpdatedUser;
-		if (GetCurrentUser(UpdatedUser))
+		// Runs on whichever thread pumps the callbacks, so read the user right away and only hand the result over
+		FDiscordUtf8User UpdatedUser;
+		EDiscordPremiumTypes::Type PremiumType;
+		int32 Flags;
+		if (!ReadCurrentUser(UpdatedUser, PremiumType, Flags)) return;
+
+		DiscordSubsystem->RunOnGameThread([this, UpdatedUser = MoveTemp(UpdatedUser), PremiumType, Flags]
 		{
-			OnCurrentUserUpdated.Broadcast(UpdatedUser);
-		}
+			// Converted once here, instead of on every read
+			CurrentUser.Emplace();
+			CurrentUser->User = FDiscordUser(UpdatedUser);
+			CurrentUser->PremiumType = PremiumType;
+			CurrentUser->Flags = Flags;
+
+			OnCurrentUserUpdatedNative.Broadcast(UpdatedUser);
+			if (OnCurrentUserUpdated.IsBound()) OnCurrentUserUpdated.Broadcast(CurrentUser->User);
+		});
 	});
 }
 
@@ -43,10 +103,10 @@ void UDiscordUserManager::BeginDestroy()
 	UObject::BeginDestroy();
 }
 
-bool UDiscordUserManager::GetCurrentUser(FDiscordUser& User) const
+bool UDiscordUserManager::ReadCurrentUser(FDiscordUtf8User& OutUser, EDiscordPremiumTypes::Type& OutPremiumType, int32& OutFlags) const
 {
-	if (!DiscordSubsystem->IsActive()) return false;
-	
+	DISCORD_SCOPE_CYCLE_COUNTER(UserManager_ReadCurrentUser);
+
 	discord::User DiscordUser;
 	const auto Result = Internal_UserManager->GetCurrentUser(&DiscordUser);
 
@@ -56,62 +116,286 @@ bool UDiscordUserManager::GetCurrentUser(FDiscordUser& User) const
 		return false;
 	}
 
-	User = FDiscordUser(DiscordUser);
+	OutUser = FDiscordUtf8User(DiscordUser);
+
+	discord::PremiumType PremiumType = discord::PremiumType::None;
+	Internal_UserManager->GetCurrentUserPremiumType(&PremiumType);
+	OutPremiumType = static_cast<EDiscordPremiumTypes::Type>(PremiumType);
+
+	// There's no call for all the flags, so they're asked one by one, once per update
+	OutFlags = 0;
+	for (const EDiscordUserFlags::Type Flag : AllUserFlags)
+	{
+		bool bHasFlag = false;
+		Internal_UserManager->CurrentUserHasFlag(static_cast<discord::UserFlag>(Flag << 1), &bHasFlag);
+		if (bHasFlag) OutFlags |= Flag;
+	}
+
+	return true;
+}
+
+const UDiscordUserManager::FCurrentUserSnapshot* UDiscordUserManager::GetCurrentUserSnapshot() const
+{
+	if (CurrentUser.IsSet()) return CurrentUser.GetPtrOrNull();
+
+	if (!DiscordSubsystem->IsActive()) return nullptr;
+
+	// Only until the first `OnCurrentUserUpdate`, which usually fires right after connecting
+	FDiscordUtf8User User;
+	EDiscordPremiumTypes::Type PremiumType;
+	int32 Flags;
+	{
+		FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+		if (!ReadCurrentUser(User, PremiumType, Flags)) return nullptr;
+	}
+
+	CurrentUser.Emplace();
+	CurrentUser->User = FDiscordUser(User);
+	CurrentUser->PremiumType = PremiumType;
+	CurrentUser->Flags = Flags;
+	return CurrentUser.GetPtrOrNull();
+}
+
+bool UDiscordUserManager::GetCurrentUser(FDiscordUser& User) const
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(UserManager_GetCurrentUser);
+
+	const FCurrentUserSnapshot* Snapshot = GetCurrentUserSnapshot();
+	if (!Snapshot) return false;
+
+	User = Snapshot->User;
 	return true;
 }
 
+const FDiscordUser* UDiscordUserManager::FindCurrentUser() const
+{
+	const FCurrentUserSnapshot* Snapshot = GetCurrentUserSnapshot();
+	return Snapshot ? &Snapshot->User : nullptr;
+}
+
 void UDiscordUserManager::GetUser(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 UserID, FDiscordUser& User, EDiscordOutputPins& OutputPins) const
 {
-	FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins, [this, UserID, &User](auto* Action) mutable
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = GetUser(UserID, [&User, Action](discord::Result Result, discord::User const& ResultUser)
 	{
-		GetUser(UserID, [&User, Action](discord::Result Result, discord::User const& ResultUser) mutable
-		{
-			User = FDiscordUser(ResultUser);
-			Action->FinishOperation(Result == discord::Result::Ok);
-		});
+		User = FDiscordUser(ResultUser);
+		Action->FinishOperation(Result == discord::Result::Ok);
 	});
+	Action->SetOperation(DiscordSubsystem, Handle);
 }
 
-void UDiscordUserManager::GetUser(const int64 UserID, TFunction<void(discord::Result, discord::User const&)> Callback) const
+FDiscordOperationHandle UDiscordUserManager::GetUser(const int64 UserID, TFunction<void(discord::Result, discord::User const&)> Callback, const float TimeoutSeconds) const
 {
+	DISCORD_SCOPE_CALL(UserManager_GetUser);
+	
 	if (!DiscordSubsystem->IsActive())
 	{
 		Callback(discord::Result::InternalError, discord::User{});
-		return;
+		return {};
+	}
+
+	if (const FDiscordUtf8User* Cached = FindCachedUser(UserID))
+	{
+		Callback(discord::Result::Ok, Cached->ToDiscordType());
+		return {};
 	}
 	
-	Internal_UserManager->GetUser(UserID, Callback);
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	LookupUser(UserID, [WrappedCallback = MoveTemp(WrappedCallback)](discord::Result Result, const FDiscordUtf8User& User)
+	{
+		WrappedCallback(Result, User.ToDiscordType());
+	});
+
+	return Handle;
 }
 
-TEnumAsByte<EDiscordPremiumTypes::Type> UDiscordUserManager::GetCurrentUserPremiumType() const
+void UDiscordUserManager::GetUsers(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const TArray<int64>& UserIDs, TArray<FDiscordUser>& Users, EDiscordOutputPins& OutputPins) const
 {
-	if (!DiscordSubsystem->IsActive()) return EDiscordPremiumTypes::None;
-	
-	discord::PremiumType CurrentUserPremiumType;
-	const auto Result = Internal_UserManager->GetCurrentUserPremiumType(&CurrentUserPremiumType);
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
 
-	if (Result != discord::Result::Ok)
+	const FDiscordOperationHandle Handle = GetUsers(UserIDs, [&Users, Action](discord::Result Result, const TArray<FDiscordUser>& ResultUsers)
 	{
-		LOG_DISCORD_ERROR(Result);
+		Users = ResultUsers;
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordUserManager::GetUsers(const TArray<int64>& UserIDs, TFunction<void(discord::Result, const TArray<FDiscordUser>&)> Callback, const float TimeoutSeconds) const
+{
+	DISCORD_SCOPE_CALL(UserManager_GetUsers);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		TArray<FDiscordUser> NoUsers;
+		Callback(discord::Result::InternalError, NoUsers);
+		return {};
 	}
 
-	return static_cast<EDiscordPremiumTypes::Type>(CurrentUserPremiumType);
+	TSet<int64> UniqueUserIDs;
+	UniqueUserIDs.Append(UserIDs);
+
+	const TSharedRef<FDiscordUserBatch> Batch = MakeShared<FDiscordUserBatch>();
+	Batch->UserIDs = UserIDs;
+
+	// Answered right away when every user is cached, e.g. when a screen asks for the same users again
+	for (const int64 UserID : UniqueUserIDs)
+	{
+		const FDiscordUtf8User* Cached = FindCachedUser(UserID);
+		if (!Cached) break;
+
+		Batch->Found.Add(UserID, *Cached);
+	}
+
+	if (Batch->Found.Num() == UniqueUserIDs.Num())
+	{
+		Batch->Callback = MoveTemp(Callback);
+		Batch->Finish();
+		return {};
+	}
+
+	FDiscordOperationHandle Handle;
+	Batch->Callback = DiscordSubsystem->WrapCallback(MoveTemp(Callback), TimeoutSeconds, Handle);
+	Batch->NumPending = UniqueUserIDs.Num() - Batch->Found.Num();
+
+	for (const int64 UserID : UniqueUserIDs)
+	{
+		if (Batch->Found.Contains(UserID)) continue;
+
+		LookupUser(UserID, [Batch, UserID](discord::Result Result, const FDiscordUtf8User& User)
+		{
+			if (Result == discord::Result::Ok)
+			{
+				Batch->Found.Add(UserID, User);
+			}
+			else if (Batch->Result == discord::Result::Ok)
+			{
+				Batch->Result = Result;
+			}
+
+			if (--Batch->NumPending == 0)
+			{
+				Batch->Finish();
+			}
+		});
+	}
+
+	return Handle;
 }
 
-bool UDiscordUserManager::CurrentUserHasFlag(const EDiscordUserFlags::Type Flag) const
+const FDiscordUtf8User* UDiscordUserManager::FindCachedUser(const int64 UserID) const
 {
-	if (!DiscordSubsystem->IsActive()) return false;
-	
-	if (Flag == EDiscordUserFlags::None) return false;
+	const FCachedUser* Cached = CachedUsers.FindAndTouch(UserID);
+	if (!Cached) return nullptr;
+
+	if (FPlatformTime::Seconds() - Cached->FetchTime > GetDefault<UDiscordSettings>()->UserCacheLifetimeSeconds)
+	{
+		CachedUsers.Remove(UserID);
+		return nullptr;
+	}
 
-	bool bHasFlag = false;
-	const auto Result = Internal_UserManager->CurrentUserHasFlag(static_cast<discord::UserFlag>(Flag << 1), &bHasFlag);
+	return &Cached->User;
+}
 
-	if (Result != discord::Result::Ok)
+void UDiscordUserManager::LookupUser(const int64 UserID, TFunction<void(discord::Result, const FDiscordUtf8User&)>&& Callback) const
+{
+	if (const FDiscordUtf8User* Cached = FindCachedUser(UserID))
+	{
+		Callback(discord::Result::Ok, *Cached);
+		return;
+	}
+
+	// Already on its way, so the new caller only waits for it
+	if (TArray<TFunction<void(discord::Result, const FDiscordUtf8User&)>>* Callbacks = PendingLookups.Find(UserID))
+	{
+		Callbacks->Add(MoveTemp(Callback));
+		return;
+	}
+
+	PendingLookups.Add(UserID).Add(MoveTemp(Callback));
+
+	// Tracked like any other request, so that if the answer is lost the lookup times out, and the next caller fetches
+	// the user again instead of waiting on it forever
+	FDiscordOperationHandle Handle;
+	auto FinishCallback = DiscordSubsystem->WrapCallback(TFunction<void(discord::Result, const FDiscordUtf8User&)>([this, UserID](discord::Result Result, const FDiscordUtf8User& User)
+	{
+		FinishLookup(UserID, Result, User);
+	}), -1.f, Handle);
+
+	DiscordSubsystem->RunOnSdkThread([this, UserID, FinishCallback = MoveTemp(FinishCallback)]
+	{
+		Internal_UserManager->GetUser(UserID, [FinishCallback](discord::Result Result, discord::User const& User)
+		{
+			FinishCallback(Result, FDiscordUtf8User(User));
+		});
+	});
+}
+
+void UDiscordUserManager::FinishLookup(const int64 UserID, const discord::Result Result, const FDiscordUtf8User& User) const
+{
+	if (Result == discord::Result::Ok)
+	{
+		if (GetDefault<UDiscordSettings>()->UserCacheLifetimeSeconds > 0.f)
+		{
+			CachedUsers.Add(UserID, {User, FPlatformTime::Seconds()});
+		}
+	}
+	else
 	{
 		LOG_DISCORD_ERROR(Result);
 	}
 
-	return bHasFlag;
+	TArray<TFunction<void(discord::Result, const FDiscordUtf8User&)>> Callbacks;
+	if (!PendingLookups.RemoveAndCopyValue(UserID, Callbacks)) return;
+
+	for (const TFunction<void(discord::Result, const FDiscordUtf8User&)>& Callback : Callbacks)
+	{
+		Callback(Result, User);
+	}
 }
 
+int64 UDiscordUserManager::GetCurrentUserID() const
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(UserManager_GetCurrentUserID);
+
+	const FCurrentUserSnapshot* Snapshot = GetCurrentUserSnapshot();
+	return Snapshot ? Snapshot->User.ID : -1;
+}
+
+bool UDiscordUserManager::IsCurrentUserBot() const
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(UserManager_IsCurrentUserBot);
+
+	const FCurrentUserSnapshot* Snapshot = GetCurrentUserSnapshot();
+	return Snapshot && Snapshot->User.bIsBot;
+}
+
+TEnumAsByte<EDiscordPremiumTypes::Type> UDiscordUserManager::GetCurrentUserPremiumType() const
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(UserManager_GetCurrentUserPremiumType);
+
+	const FCurrentUserSnapshot* Snapshot = GetCurrentUserSnapshot();
+	return Snapshot ? Snapshot->PremiumType : TEnumAsByte<EDiscordPremiumTypes::Type>(EDiscordPremiumTypes::None);
+}
+
+bool UDiscordUserManager::CurrentUserHasFlag(const EDiscordUserFlags::Type Flag) const
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(UserManager_CurrentUserHasFlag);
+
+	if (Flag == EDiscordUserFlags::None) return false;
+
+	const FCurrentUserSnapshot* Snapshot = GetCurrentUserSnapshot();
+	return Snapshot && (Snapshot->Flags & Flag) != 0;
+}
+
+int32 UDiscordUserManager::GetCurrentUserFlags() const
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(UserManager_GetCurrentUserFlags);
+
+	const FCurrentUserSnapshot* Snapshot = GetCurrentUserSnapshot();
+	return Snapshot ? Snapshot->Flags : 0;
+}
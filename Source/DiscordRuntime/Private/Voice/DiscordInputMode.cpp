@@ -0,0 +1,29 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Voice/DiscordInputMode.h"
+
+#include "DiscordStats.h"
+#include "Discord/types.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordInputMode)
+
+
+FDiscordInputMode::FDiscordInputMode(discord::InputMode const& InputMode)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordInputMode_FromDiscordType);
+
+	Type = static_cast<EDiscordInputModeTypes::Type>(InputMode.GetType());
+	Shortcut = UTF8_TO_TCHAR(InputMode.GetShortcut());
+}
+
+discord::InputMode FDiscordInputMode::ToDiscordType() const
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(DiscordInputMode_ToDiscordType);
+
+	discord::InputMode InputMode;
+
+	InputMode.SetType(static_cast<discord::InputModeType>(Type.GetValue()));
+	InputMode.SetShortcut(TCHAR_TO_UTF8(*Shortcut));
+
+	return InputMode;
+}
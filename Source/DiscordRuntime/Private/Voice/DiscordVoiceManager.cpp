@@ -0,0 +1,354 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#include "Voice/DiscordVoiceManager.h"
+
+#include "DiscordCallbackPump.h"
+#include "DiscordLatentAction.h"
+#include "DiscordLogChannel.h"
+#include "DiscordSettings.h"
+#include "DiscordStats.h"
+#include "DiscordSubsystem.h"
+#include "Discord/voice_manager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DiscordVoiceManager)
+
+
+UDiscordVoiceManager::UDiscordVoiceManager()
+{
+	const auto Outer = GetOuter();
+	if (Outer->IsA(UDiscordSubsystem::StaticClass()))
+	{
+		DiscordSubsystem = Cast<UDiscordSubsystem>(GetOuter());
+	}
+}
+
+void UDiscordVoiceManager::Initialize(discord::VoiceManager* VoiceManager)
+{
+	Internal_VoiceManager = VoiceManager;
+
+	Internal_OnSettingsUpdateCallback = Internal_VoiceManager->OnSettingsUpdate.Connect([this]
+	{
+		// Discord doesn't say what changed, so everything is read again once per frame at most
+		DiscordSubsystem->RunOnGameThread([this]
+		{
+			bSettingsDirty = true;
+		});
+	});
+
+	RefreshSettings(false);
+}
+
+void UDiscordVoiceManager::BeginDestroy()
+{
+	if (Internal_VoiceManager)
+	{
+		Internal_VoiceManager->OnSettingsUpdate.Disconnect(Internal_OnSettingsUpdateCallback);
+	}
+	
+	UObject::BeginDestroy();
+}
+
+const UDiscordVoiceManager::FUserVoiceSettings& UDiscordVoiceManager::FindOrReadUser(const int64 UserID) const
+{
+	if (const FUserVoiceSettings* Found = Users.Find(UserID)) return *Found;
+
+	static const FUserVoiceSettings DefaultSettings;
+	if (!DiscordSubsystem->IsActive()) return DefaultSettings;
+
+	DISCORD_SCOPE_CALL(VoiceManager_ReadUser);
+
+	FUserVoiceSettings& Settings = Users.Add(UserID);
+
+	FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+	Internal_VoiceManager->IsLocalMute(UserID, &Settings.bMute);
+	Internal_VoiceManager->GetLocalVolume(UserID, &Settings.Volume);
+	return Settings;
+}
+
+void UDiscordVoiceManager::RefreshSettings(const bool bBroadcast)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(VoiceManager_RefreshSettings);
+
+	const bool bPreviousSelfMute = bSelfMute;
+	const bool bPreviousSelfDeaf = bSelfDeaf;
+	const FDiscordInputMode PreviousInputMode = InputMode;
+
+	TArray<TPair<int64, FUserVoiceSettings>> ChangedUsers;
+	{
+		FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+
+		Internal_VoiceManager->IsSelfMute(&bSelfMute);
+		Internal_VoiceManager->IsSelfDeaf(&bSelfDeaf);
+
+		discord::InputMode NewInputMode;
+		if (Internal_VoiceManager->GetInputMode(&NewInputMode) == discord::Result::Ok)
+		{
+			InputMode = FDiscordInputMode(NewInputMode);
+		}
+
+		for (TPair<int64, FUserVoiceSettings>& User : Users)
+		{
+			const FUserVoiceSettings Previous = User.Value;
+			Internal_VoiceManager->IsLocalMute(User.Key, &User.Value.bMute);
+
+			// Discord doesn't know about the volumes that weren't written yet
+			if (!PendingVolumes.Contains(User.Key))
+			{
+				Internal_VoiceManager->GetLocalVolume(User.Key, &User.Value.Volume);
+			}
+
+			if (User.Value.bMute != Previous.bMute || User.Value.Volume != Previous.Volume)
+			{
+				ChangedUsers.Emplace(User.Key, Previous);
+			}
+		}
+	}
+
+	if (!bBroadcast) return;
+
+	// Broadcast once everything is read, so that listeners see the new settings of every user
+	if (bSelfMute != bPreviousSelfMute)
+	{
+		OnSelfMuteChangedNative.Broadcast(bSelfMute);
+		OnSelfMuteChanged.Broadcast(bSelfMute);
+	}
+
+	if (bSelfDeaf != bPreviousSelfDeaf)
+	{
+		OnSelfDeafChangedNative.Broadcast(bSelfDeaf);
+		OnSelfDeafChanged.Broadcast(bSelfDeaf);
+	}
+
+	if (InputMode != PreviousInputMode)
+	{
+		OnInputModeChangedNative.Broadcast(InputMode);
+		OnInputModeChanged.Broadcast(InputMode);
+	}
+
+	for (const TPair<int64, FUserVoiceSettings>& Changed : ChangedUsers)
+	{
+		// A listener may have forgotten the user in the meantime
+		const FUserVoiceSettings* Current = Users.Find(Changed.Key);
+		if (!Current) continue;
+
+		const FUserVoiceSettings Settings = *Current;
+		if (Settings.bMute != Changed.Value.bMute)
+		{
+			OnLocalMuteChangedNative.Broadcast(Changed.Key, Settings.bMute);
+			OnLocalMuteChanged.Broadcast(Changed.Key, Settings.bMute);
+		}
+
+		if (Settings.Volume != Changed.Value.Volume)
+		{
+			OnLocalVolumeChangedNative.Broadcast(Changed.Key, Settings.Volume);
+			OnLocalVolumeChanged.Broadcast(Changed.Key, Settings.Volume);
+		}
+	}
+}
+
+void UDiscordVoiceManager::FlushPendingChanges(const double Now)
+{
+	if (PendingVolumes.Num() > 0 && Now - LastVolumeWriteTime >= GetDefault<UDiscordSettings>()->VoiceVolumeWriteIntervalSeconds)
+	{
+		WritePendingVolumes(Now);
+	}
+
+	if (bSettingsDirty)
+	{
+		bSettingsDirty = false;
+		RefreshSettings(true);
+	}
+}
+
+void UDiscordVoiceManager::WritePendingVolumes(const double Now)
+{
+	DISCORD_SCOPE_CYCLE_COUNTER(VoiceManager_WritePendingVolumes);
+
+	{
+		FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+		for (const TPair<int64, uint8>& Pending : PendingVolumes)
+		{
+			const discord::Result Result = Internal_VoiceManager->SetLocalVolume(Pending.Key, Pending.Value);
+			if (Result != discord::Result::Ok)
+			{
+				LOG_DISCORD_ERROR(Result);
+
+				// Read back, so that the cached volume doesn't lie
+				bSettingsDirty = true;
+			}
+		}
+	}
+
+	LOG_DISCORD(Verbose, "Wrote the local volume of {Num} users", PendingVolumes.Num());
+
+	PendingVolumes.Reset();
+	LastVolumeWriteTime = Now;
+}
+
+void UDiscordVoiceManager::SetSelfMute(const bool bMute)
+{
+	DISCORD_SCOPE_CALL(VoiceManager_SetSelfMute);
+
+	if (!DiscordSubsystem->IsActive()) return;
+
+	discord::Result Result;
+	{
+		FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+		Result = Internal_VoiceManager->SetSelfMute(bMute);
+	}
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return;
+	}
+
+	if (bSelfMute == bMute) return;
+
+	bSelfMute = bMute;
+	OnSelfMuteChangedNative.Broadcast(bSelfMute);
+	OnSelfMuteChanged.Broadcast(bSelfMute);
+}
+
+void UDiscordVoiceManager::SetSelfDeaf(const bool bDeaf)
+{
+	DISCORD_SCOPE_CALL(VoiceManager_SetSelfDeaf);
+
+	if (!DiscordSubsystem->IsActive()) return;
+
+	discord::Result Result;
+	{
+		FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+		Result = Internal_VoiceManager->SetSelfDeaf(bDeaf);
+	}
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return;
+	}
+
+	if (bSelfDeaf == bDeaf) return;
+
+	bSelfDeaf = bDeaf;
+	OnSelfDeafChangedNative.Broadcast(bSelfDeaf);
+	OnSelfDeafChanged.Broadcast(bSelfDeaf);
+}
+
+void UDiscordVoiceManager::SetInputMode(const UObject* WorldContext, const FLatentActionInfo LatentInfo,
+	const FDiscordInputMode& NewInputMode, EDiscordOutputPins& OutputPins)
+{
+	FDiscordLatentAction* Action = FDiscordLatentAction::CreateAndAdd(WorldContext, LatentInfo, OutputPins);
+	if (!Action) return;
+
+	const FDiscordOperationHandle Handle = SetInputMode(NewInputMode, [Action](discord::Result Result)
+	{
+		Action->FinishOperation(Result == discord::Result::Ok);
+	});
+	Action->SetOperation(DiscordSubsystem, Handle);
+}
+
+FDiscordOperationHandle UDiscordVoiceManager::SetInputMode(const FDiscordInputMode& NewInputMode, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds)
+{
+	DISCORD_SCOPE_CALL(VoiceManager_SetInputMode);
+
+	if (!DiscordSubsystem->IsActive())
+	{
+		Callback(discord::Result::InternalError);
+		return {};
+	}
+
+	// Applied to the cache before the callback fires, so that it reads the new input mode
+	TFunction<void(discord::Result)> ApplyInputMode = [this, NewInputMode, Callback = MoveTemp(Callback)](discord::Result Result)
+	{
+		if (Result == discord::Result::Ok)
+		{
+			if (InputMode != NewInputMode)
+			{
+				InputMode = NewInputMode;
+				OnInputModeChangedNative.Broadcast(InputMode);
+				OnInputModeChanged.Broadcast(InputMode);
+			}
+		}
+		else
+		{
+			LOG_DISCORD_ERROR(Result);
+		}
+
+		if (Callback) Callback(Result);
+	};
+
+	FDiscordOperationHandle Handle;
+	auto WrappedCallback = DiscordSubsystem->WrapCallback(MoveTemp(ApplyInputMode), TimeoutSeconds, Handle);
+	DiscordSubsystem->RunOnSdkThread([Manager = Internal_VoiceManager, NewInputMode = NewInputMode.ToDiscordType(), WrappedCallback = MoveTemp(WrappedCallback)]
+	{
+		Manager->SetInputMode(NewInputMode, WrappedCallback);
+	});
+
+	return Handle;
+}
+
+bool UDiscordVoiceManager::IsLocalMute(const int64 UserID) const
+{
+	return FindOrReadUser(UserID).bMute;
+}
+
+void UDiscordVoiceManager::SetLocalMute(const int64 UserID, const bool bMute)
+{
+	DISCORD_SCOPE_CALL(VoiceManager_SetLocalMute);
+
+	if (!DiscordSubsystem->IsActive()) return;
+
+	// Tracked from now on, so that changes made from Discord are caught too
+	FindOrReadUser(UserID);
+
+	discord::Result Result;
+	{
+		FDiscordSdkScopeLock SdkLock(DiscordSubsystem);
+		Result = Internal_VoiceManager->SetLocalMute(UserID, bMute);
+	}
+
+	if (Result != discord::Result::Ok)
+	{
+		LOG_DISCORD_ERROR(Result);
+		return;
+	}
+
+	FUserVoiceSettings& Settings = Users.FindChecked(UserID);
+	if (Settings.bMute == bMute) return;
+
+	Settings.bMute = bMute;
+	OnLocalMuteChangedNative.Broadcast(UserID, bMute);
+	OnLocalMuteChanged.Broadcast(UserID, bMute);
+}
+
+uint8 UDiscordVoiceManager::GetLocalVolume(const int64 UserID) const
+{
+	return FindOrReadUser(UserID).Volume;
+}
+
+void UDiscordVoiceManager::SetLocalVolume(const int64 UserID, const uint8 Volume)
+{
+	DISCORD_SCOPE_CALL(VoiceManager_SetLocalVolume);
+
+	if (!DiscordSubsystem->IsActive()) return;
+
+	FindOrReadUser(UserID);
+
+	const uint8 NewVolume = FMath::Min<uint8>(Volume, 200);
+	FUserVoiceSettings& Settings = Users.FindChecked(UserID);
+	if (Settings.Volume == NewVolume) return;
+
+	// Only the last volume set before the next write is sent
+	Settings.Volume = NewVolume;
+	PendingVolumes.Add(UserID, NewVolume);
+
+	OnLocalVolumeChangedNative.Broadcast(UserID, NewVolume);
+	OnLocalVolumeChanged.Broadcast(UserID, NewVolume);
+}
+
+void UDiscordVoiceManager::ForgetUser(const int64 UserID)
+{
+	// A volume that wasn't written yet still is, it just isn't tracked anymore
+	Users.Remove(UserID);
+}
@@ -0,0 +1,42 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordTypes.h"
+#include "DiscordAchievement.generated.h"
+
+
+USTRUCT(BlueprintType)
+struct FDiscordUserAchievement
+{
+	GENERATED_BODY()
+
+public:
+	FDiscordUserAchievement() = default;
+
+	explicit FDiscordUserAchievement(discord::UserAchievement const& UserAchievement);
+
+	/**
+	 * The user who made progress.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Achievement")
+	int64 UserID = 0;
+
+	/**
+	 * The achievement, as set up in the Discord Developer Portal.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Achievement")
+	int64 AchievementID = 0;
+
+	/**
+	 * How far the user is, from 0 to 100.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Achievement")
+	uint8 PercentComplete = 0;
+
+	/**
+	 * When the achievement was unlocked. Unset until it's complete.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Achievement")
+	FDateTime UnlockedAt;
+};
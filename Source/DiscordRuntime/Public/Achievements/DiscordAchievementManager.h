@@ -0,0 +1,169 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordOperation.h"
+#include "DiscordTypes.h"
+#include "DiscordAchievement.h"
+#include "UObject/Object.h"
+#include "DiscordAchievementManager.generated.h"
+
+enum class EDiscordOutputPins : uint8;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordUserAchievementUpdatedSignature, const FDiscordUserAchievement&, UserAchievement);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordUserAchievementUpdatedNative, const FDiscordUserAchievement& /* UserAchievement */);
+
+
+/**
+ * Counters for the progress reported through `SetAchievementProgress`.
+ */
+USTRUCT(BlueprintType)
+struct FDiscordAchievementWriteStats
+{
+	GENERATED_BODY()
+
+	/**
+	 * Progress reports requested.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Achievement")
+	int32 Reports = 0;
+
+	/**
+	 * Reports dropped because they wouldn't have raised the progress.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Achievement")
+	int32 Dropped = 0;
+
+	/**
+	 * Reports replaced by a higher one to the same achievement before they could be sent.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Achievement")
+	int32 Merged = 0;
+
+	/**
+	 * Progress updates actually sent to Discord.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Achievement")
+	int32 Updates = 0;
+};
+
+
+UCLASS(Within=DiscordSubsystem)
+class DISCORDRUNTIME_API UDiscordAchievementManager : public UObject
+{
+	friend class UDiscordSubsystem;
+	
+	GENERATED_BODY()
+
+private:
+	UDiscordAchievementManager();
+	void Initialize(discord::AchievementManager* AchievementManager);
+	virtual void BeginDestroy() override;
+
+	/** The progress reported for an achievement, and what's left to send. */
+	struct FAchievementProgress
+	{
+		/** The highest progress waiting to be sent, or 0 if none. */
+		uint8 PendingPercent = 0;
+
+		/** The highest progress sent, unless it failed. */
+		uint8 SentPercent = 0;
+
+		int32 NumPendingReports = 0;
+
+		TArray<TFunction<void(discord::Result)>> Callbacks;
+
+		double LastFlushTime = -UE_BIG_NUMBER;
+	};
+
+	/**
+	 * Returns the highest progress known for an achievement, whether fetched, sent or waiting to be sent.
+	 */
+	uint8 GetKnownProgress(const int64 AchievementID, const FAchievementProgress& Progress) const;
+
+	/**
+	 * Sends the pending progress of each achievement that waited long enough. Called every frame by the subsystem.
+	 */
+	void FlushPendingProgress(const double Now);
+
+	void SendProgress(const int64 AchievementID, FAchievementProgress& Progress, const double Now);
+
+	void OnProgressSent(const int64 AchievementID, const uint8 Percent, const discord::Result Result);
+
+private:
+	UPROPERTY()
+	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
+	
+	discord::AchievementManager* Internal_AchievementManager = nullptr;
+
+	int Internal_OnUserAchievementUpdateCallback;
+
+	// Only touched on the game thread
+	TMap<int64, FDiscordUserAchievement> UserAchievements;
+
+	TMap<int64, FAchievementProgress> Progresses;
+
+	int32 NumPendingAchievements = 0;
+
+	FDiscordAchievementWriteStats WriteStats;
+
+public:
+	/**
+	 * Fetches the current user's achievements, which can then be read with `GetUserAchievement`. Progress reports
+	 * that wouldn't raise a fetched achievement's progress are dropped, so it's worth fetching them early.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Achievement", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void FetchUserAchievements(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Fetches the current user's achievements, which can then be read with `GetUserAchievement`. Progress reports
+	 * that wouldn't raise a fetched achievement's progress are dropped, so it's worth fetching them early.
+	 */
+	FDiscordOperationHandle FetchUserAchievements(TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Finds one of the current user's achievements, once fetched. Returns whether it was found.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Achievement", meta=(ReturnDisplayName="Found"))
+	bool GetUserAchievement(const int64 AchievementID, FDiscordUserAchievement& UserAchievement) const;
+
+	/**
+	 * Returns the current user's achievements, once fetched.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Achievement")
+	TArray<FDiscordUserAchievement> GetUserAchievements() const;
+
+	/**
+	 * Reports the current user's progress on an achievement, from 0 to 100. Cheap enough to be called from gameplay
+	 * code every time progress is made: reports that don't raise the progress are dropped, and only the highest one is
+	 * sent, at most once per `AchievementWriteIntervalSeconds` (see settings) for each achievement.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Achievement")
+	void SetAchievementProgress(const int64 AchievementID, const uint8 PercentComplete);
+
+	/**
+	 * Reports the current user's progress on an achievement, from 0 to 100. Cheap enough to be called from gameplay
+	 * code every time progress is made: reports that don't raise the progress are dropped, and only the highest one is
+	 * sent, at most once per `AchievementWriteIntervalSeconds` (see settings) for each achievement. The callbacks of
+	 * dropped reports fire right away with `Ok`, and those of the reports merged into an update fire with its result.
+	 */
+	FDiscordOperationHandle SetAchievementProgress(const int64 AchievementID, const uint8 PercentComplete, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Returns how many progress reports were requested, dropped, merged and sent so far.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Achievement")
+	FDiscordAchievementWriteStats GetWriteStats() const { return WriteStats; }
+
+public:
+	/**
+	 * Fires when the current user's progress on an achievement changed.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Achievement")
+	FOnDiscordUserAchievementUpdatedSignature OnUserAchievementUpdated;
+
+	/**
+	 * Fires when the current user's progress on an achievement changed, before `OnUserAchievementUpdated`.
+	 */
+	FOnDiscordUserAchievementUpdatedNative OnUserAchievementUpdatedNative;
+};
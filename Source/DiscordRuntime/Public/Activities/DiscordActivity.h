@@ -3,6 +3,7 @@
 #pragma once
 
 #include "DiscordTypes.h"
+#include "DiscordUtf8String.h"
 #include "DiscordActivity.generated.h"
 
 
@@ -18,6 +19,30 @@ namespace EDiscordActivityJoinRequestReplyTypes
 }
 
 
+/**
+ * Fields of an FDiscordActivity, as encoded in a native `discord::Activity`.
+ */
+enum class EDiscordActivityFields : uint16
+{
+	None = 0,
+	Application = 1 << 0,
+	State = 1 << 1,
+	Details = 1 << 2,
+	Instance = 1 << 3,
+	Timestamps = 1 << 4,
+	LargeImageKey = 1 << 5,
+	LargeImageText = 1 << 6,
+	SmallImageKey = 1 << 7,
+	SmallImageText = 1 << 8,
+	PartyID = 1 << 9,
+	PartySize = 1 << 10,
+	SecretsMatch = 1 << 11,
+	SecretsJoin = 1 << 12,
+	All = (1 << 13) - 1
+};
+ENUM_CLASS_FLAGS(EDiscordActivityFields);
+
+
 USTRUCT(BlueprintType)
 struct FDiscordActivityTimestamps
 {
@@ -140,6 +165,73 @@ public:
 };
 
 
+/**
+ * UTF-8 copy of a native activity, for C++ code that only passes activities around. Copying it to and from the SDK
+ * is a `memcpy` per string, and the strings are only converted when read through a getter or turned into an
+ * FDiscordActivity.
+ */
+struct DISCORDRUNTIME_API FDiscordUtf8Activity
+{
+	FDiscordUtf8Activity() = default;
+
+	explicit FDiscordUtf8Activity(discord::Activity const& Activity);
+
+	discord::Activity ToDiscordType() const;
+
+	FString GetName() const { return Name.ToString(); }
+
+	FString GetState() const { return State.ToString(); }
+
+	FString GetDetails() const { return Details.ToString(); }
+
+	FString GetLargeImageKey() const { return LargeImageKey.ToString(); }
+
+	FString GetLargeImageText() const { return LargeImageText.ToString(); }
+
+	FString GetSmallImageKey() const { return SmallImageKey.ToString(); }
+
+	FString GetSmallImageText() const { return SmallImageText.ToString(); }
+
+	FString GetPartyID() const { return PartyID.ToString(); }
+
+	FString GetMatchSecret() const { return MatchSecret.ToString(); }
+
+	FString GetJoinSecret() const { return JoinSecret.ToString(); }
+
+	int64 ApplicationID = -1;
+
+	TDiscordUtf8String<128> Name;
+
+	TDiscordUtf8String<128> State;
+
+	TDiscordUtf8String<128> Details;
+
+	int64 StartTimestamp = 0;
+
+	int64 EndTimestamp = 0;
+
+	TDiscordUtf8String<128> LargeImageKey;
+
+	TDiscordUtf8String<128> LargeImageText;
+
+	TDiscordUtf8String<128> SmallImageKey;
+
+	TDiscordUtf8String<128> SmallImageText;
+
+	TDiscordUtf8String<128> PartyID;
+
+	int32 PartyCurrentSize = 0;
+
+	int32 PartyMaxSize = 0;
+
+	TDiscordUtf8String<128> MatchSecret;
+
+	TDiscordUtf8String<128> JoinSecret;
+
+	bool bInstance = false;
+};
+
+
 USTRUCT(BlueprintType)
 struct FDiscordActivity
 {
@@ -150,8 +242,26 @@ public:
 
 	explicit FDiscordActivity(discord::Activity const& Activity);
 
+	explicit FDiscordActivity(const FDiscordUtf8Activity& Activity);
+
 	discord::Activity ToDiscordType() const;
 
+	/**
+	 * Encodes only the given fields into an existing native activity, leaving the others untouched.
+	 */
+	void ToDiscordType(discord::Activity& Activity, const EDiscordActivityFields Fields) const;
+
+	/**
+	 * Returns the fields that differ from the other activity. Strings are compared as they are, without converting them.
+	 */
+	EDiscordActivityFields GetChangedFields(const FDiscordActivity& Other) const;
+
+	bool operator==(const FDiscordActivity& Other) const { return GetChangedFields(Other) == EDiscordActivityFields::None; }
+
+	bool operator!=(const FDiscordActivity& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FDiscordActivity& Activity);
+
 	/**
 	 * Your application ID. This is a read-only field.
 	 */
@@ -205,4 +315,13 @@ public:
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Discord|Activity")
 	bool bInstance = false;
-};
\ No newline at end of file
+};
+
+template <>
+struct TStructOpsTypeTraits<FDiscordActivity> : TStructOpsTypeTraitsBase2<FDiscordActivity>
+{
+	enum
+	{
+		WithIdenticalViaEquality = true,
+	};
+};
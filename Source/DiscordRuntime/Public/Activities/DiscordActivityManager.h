@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "DiscordOperation.h"
+#include "DiscordRateLimiter.h"
 #include "DiscordTypes.h"
 #include "DiscordActivity.h" 
 #include "UObject/Object.h"
@@ -9,10 +11,48 @@
 #include "DiscordActivityManager.generated.h"
 
 enum class EDiscordOutputPins : uint8;
+class FDiscordActivityBuilder;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordActivityJoinSignature, FString, Secret);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordActivityJoinRequestSignature, FDiscordUser, User);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDiscordActivityInviteSignature, FDiscordUser, User, FDiscordActivity, Activity);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordActivityJoinNative, const char* /* Secret */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordActivityJoinRequestNative, const FDiscordUtf8User& /* User */);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnDiscordActivityInviteNative, const FDiscordUtf8User& /* User */, const FDiscordUtf8Activity& /* Activity */);
+
+
+/**
+ * Counters for the activity updates that went through the rate limiter.
+ */
+USTRUCT(BlueprintType)
+struct FDiscordActivityUpdateStats
+{
+	GENERATED_BODY()
+
+	/**
+	 * Updates actually sent to Discord.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Activity")
+	int32 Sent = 0;
+
+	/**
+	 * Updates replaced by a newer one before they could be sent.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Activity")
+	int32 Coalesced = 0;
+
+	/**
+	 * Updates that had to wait for the rate limit.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Activity")
+	int32 Deferred = 0;
+
+	/**
+	 * Updates that were not sent because they matched the last sent activity.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Activity")
+	int32 Skipped = 0;
+};
 
 
 UCLASS(Within=DiscordSubsystem)
@@ -27,6 +67,22 @@ private:
 	void Initialize(discord::ActivityManager* ActivityManager);
 	virtual void BeginDestroy() override;
 
+	/**
+	 * Sends the pending activity update or clear if the rate limit allows it. Returns false if it still has to wait.
+	 */
+	bool FlushPendingActivity(const double Now);
+
+	/**
+	 * Drops a pending update or clear that was replaced by a request of the other kind. Its callbacks stay queued, so
+	 * they complete with the result of the request that replaced it.
+	 */
+	void SupersedePendingActivity();
+
+	/**
+	 * Forgets the last sent activity when Discord (re)connects, since a restarted client no longer shows it.
+	 */
+	void OnCurrentUserUpdated(const FDiscordUtf8User& User);
+
 private:
 	UPROPERTY()
 	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
@@ -37,6 +93,26 @@ private:
 	int Internal_OnJoinRequestCallback;
 	int Internal_OnInviteCallback;
 
+	FDiscordRateLimiter ActivityRateLimiter;
+
+	/** Only re-encodes the fields of the activity that changed since the last update. */
+	FDiscordActivityBuilder* ActivityBuilder = nullptr;
+
+	/** Latest activity waiting for the rate limit, along with the callbacks of every request it replaced. */
+	TOptional<FDiscordActivity> PendingActivity;
+
+	/** Whether a clear is waiting for the rate limit instead, in which case PendingActivity isn't set. */
+	bool bPendingClear = false;
+
+	TArray<TFunction<void(discord::Result)>> PendingActivityCallbacks;
+
+	/** Last activity sent to Discord, used to skip updates that would not change anything. */
+	TOptional<FDiscordActivity> LastSentActivity;
+
+	uint32 LastSentActivitySerial = 0;
+
+	FDiscordActivityUpdateStats ActivityUpdateStats;
+
 public:
 	/**
 	 * Returns whether the call was a success. Registers a command by which Discord can launch your game. This might be
@@ -54,15 +130,27 @@ public:
 	bool RegisterSteam(const int32 SteamAppID);
 
 	/**
-	 * Sets a user's presence in Discord to a new activity. This has a rate limit of 5 updates per 20 seconds.
+	 * Sets a user's presence in Discord to a new activity. This has a rate limit of 5 updates per 20 seconds, so
+	 * updates past it wait for the next allowed slot, and only the latest waiting one is sent. Updates that would not
+	 * change the last sent activity are skipped, and succeed right away.
 	 */
 	UFUNCTION(BlueprintCallable, Category="Discord|Activity", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
-	void UpdateActivity(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FDiscordActivity NewActivity, EDiscordOutputPins& OutputPins);
+	void UpdateActivity(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FDiscordActivity& NewActivity, EDiscordOutputPins& OutputPins);
 	
 	/**
-	 * Sets a user's presence in Discord to a new activity. This has a rate limit of 5 updates per 20 seconds.
+	 * Sets a user's presence in Discord to a new activity. This has a rate limit of 5 updates per 20 seconds, so
+	 * updates past it wait for the next allowed slot, and only the latest waiting one is sent. The callbacks of the
+	 * updates or clear it replaced fire with its result. Updates that would not change the last sent activity are
+	 * skipped, and their callback fires right away with `Ok`. The last sent activity is forgotten when a send fails and
+	 * when the current user updates, e.g. after Discord restarted.
 	 */
-	void UpdateActivity(const FDiscordActivity NewActivity, TFunction<void(discord::Result)> Callback);
+	FDiscordOperationHandle UpdateActivity(const FDiscordActivity& NewActivity, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Returns how many activity updates were sent, coalesced, deferred or skipped so far.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Activity")
+	FDiscordActivityUpdateStats GetActivityUpdateStats() const { return ActivityUpdateStats; }
 
 	/**
 	 * Clear's a user's presence in Discord to make it show nothing.
@@ -72,10 +160,11 @@ public:
 	void ClearActivity(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins);
 
 	/**
-	 * Clear's a user's presence in Discord to make it show nothing.
+	 * Clear's a user's presence in Discord to make it show nothing. Waits for the same rate limit as updates, and the
+	 * callbacks of an update it replaced fire with its result.
 	 * This probably won't work, see issue https://github.com/discord/discord-api-docs/issues/6612
 	 */
-	void ClearActivity(TFunction<void(discord::Result)> Callback);
+	FDiscordOperationHandle ClearActivity(TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
 
 	/**
 	 * Sends a reply to an Ask to Join request.
@@ -86,20 +175,20 @@ public:
 	/**
 	 * Sends a reply to an Ask to Join request.
 	 */
-	void SendRequestReply(const int64 UserID, const EDiscordActivityJoinRequestReplyTypes::Type Reply, TFunction<void(discord::Result)> Callback) const;
+	FDiscordOperationHandle SendRequestReply(const int64 UserID, const EDiscordActivityJoinRequestReplyTypes::Type Reply, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f) const;
 	
 	/**
 	 * Sends a game invite to a given user. If you do not have a valid activity with all the required fields,
 	 * this call will error. 
 	 */
 	UFUNCTION(BlueprintCallable, Category="Discord|Activity", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
-	void SendInvite(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 UserID, const FString Content, EDiscordOutputPins& OutputPins);
+	void SendInvite(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 UserID, const FString& Content, EDiscordOutputPins& OutputPins);
 
 	/**
 	 * Sends a game invite to a given user. If you do not have a valid activity with all the required fields,
 	 * this call will error.
 	 */
-	void SendInvite(const int64 UserID, const FString Content, TFunction<void(discord::Result)> Callback) const;
+	FDiscordOperationHandle SendInvite(const int64 UserID, const FString& Content, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f) const;
 
 	/**
 	 * Accepts a game invitation from a given User ID.
@@ -125,4 +214,21 @@ public:
 	 */
 	UPROPERTY(BlueprintAssignable, Category="Discord|User")
 	FOnDiscordActivityInviteSignature OnActivityInvite;
+
+	/**
+	 * Fires before `OnActivityJoin`, with the secret as a UTF-8 string that is only valid for the duration of the
+	 * broadcast.
+	 */
+	FOnDiscordActivityJoinNative OnActivityJoinNative;
+
+	/**
+	 * Fires before `OnActivityJoinRequest`, with the UTF-8 copy of the user. The FDiscordUser is only built when a
+	 * Blueprint delegate is bound.
+	 */
+	FOnDiscordActivityJoinRequestNative OnActivityJoinRequestNative;
+
+	/**
+	 * Fires before `OnActivityInvite`, with the UTF-8 copies of the user and activity.
+	 */
+	FOnDiscordActivityInviteNative OnActivityInviteNative;
 };
@@ -0,0 +1,66 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Identifies an in-flight SDK request. Handles are generation-counted: once the request completes, times out or is
+ * cancelled, its handle goes stale and any late use of it is ignored.
+ */
+struct FDiscordOperationHandle
+{
+	int32 Index = INDEX_NONE;
+
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FDiscordOperationHandle& Other) const { return Index == Other.Index && Generation == Other.Generation; }
+};
+
+
+/**
+ * A pending request, owned by the subsystem's operation table until it completes, times out or is cancelled.
+ * Operations are recycled through a game thread free list, so starting a request doesn't hit the heap for them.
+ */
+struct FDiscordPendingOperation
+{
+	/** Every operation fits in a pooled block, which all TDiscordPendingOperation do since they only hold a TFunction. */
+	static constexpr SIZE_T PooledSize = 8 * sizeof(void*);
+
+	DISCORDRUNTIME_API static void* operator new(size_t Size);
+	DISCORDRUNTIME_API static void operator delete(void* Operation);
+
+	virtual ~FDiscordPendingOperation() = default;
+
+	/**
+	 * Called when the request timed out before the SDK answered.
+	 */
+	virtual void TimeOut() = 0;
+};
+
+
+/**
+ * Pending request holding a native callback, which receives an `InternalError` result and default arguments when the
+ * request times out.
+ */
+template <typename ResultType, typename... ArgTypes>
+struct TDiscordPendingOperation final : FDiscordPendingOperation
+{
+	explicit TDiscordPendingOperation(TFunction<void(ResultType, ArgTypes...)>&& InCallback)
+		: Callback(MoveTemp(InCallback))
+	{
+		static_assert(sizeof(TDiscordPendingOperation) <= PooledSize, "Pending operations must fit in a pooled block");
+	}
+
+	virtual void TimeOut() override
+	{
+		// Owned here and passed as lvalues, so that callbacks taking their arguments by reference can be called too
+		TTuple<std::decay_t<ArgTypes>...> Defaults;
+		Defaults.ApplyAfter(Callback, ResultType::InternalError);
+	}
+
+	TFunction<void(ResultType, ArgTypes...)> Callback;
+};
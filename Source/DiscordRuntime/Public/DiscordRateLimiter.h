@@ -0,0 +1,37 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Sliding window limiter for the SDK's rate limits. Remembers when the last MaxCalls calls went out, and only lets a
+ * new one through once the oldest of them is at least WindowSeconds old, so that no window ever holds more than
+ * MaxCalls calls. Not thread-safe.
+ */
+class FDiscordRateLimiter final
+{
+public:
+	FDiscordRateLimiter(const int32 MaxCalls, const double InWindowSeconds);
+
+	/**
+	 * Records a call if the limit allows one right now. Returns whether it did.
+	 */
+	bool TryAcquire(const double Now);
+
+	/**
+	 * Returns how long until the limit allows a call, or zero if it already does.
+	 */
+	double GetTimeUntilAvailable(const double Now) const;
+
+private:
+	double WindowSeconds;
+
+	/** Ring of the times of the last calls, oldest at NextIndex once full. */
+	TArray<double, TInlineAllocator<16>> CallTimes;
+
+	int32 NextIndex = 0;
+
+	int32 NumCalls = 0;
+};
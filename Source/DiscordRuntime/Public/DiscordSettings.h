@@ -23,4 +23,103 @@ public:
 	/** The time to wait before assuming a callback failed. */
 	UPROPERTY(Category="Configuration", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Seconds"))
 	float TimeoutSeconds = 5.f;
+
+	/**
+	 * How many times per second the SDK callbacks are pumped while no request is outstanding. 0, the default, pumps every
+	 * frame. While a request is outstanding, callbacks are always pumped every frame. Throttling delays events, lobby
+	 * messages and the packets of the net driver by up to one interval.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Hertz", ClampMin="0"))
+	float MaxPumpRate = 0.f;
+
+	/**
+	 * How many times per second the SDK callbacks are pumped once the subsystem is idle. 0, the default, never backs off.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Hertz", ClampMin="0"))
+	float IdlePumpRate = 0.f;
+
+	/** How long the subsystem must go without dispatching any callback to be considered idle. */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Seconds", ClampMin="0"))
+	float IdleDelaySeconds = 5.f;
+
+	/**
+	 * Whether to pump the SDK callbacks on a dedicated worker thread instead of the game thread. Results and events
+	 * are handed back to the game thread, so delegates still fire there. Synchronous getters, e.g. FileExists, may
+	 * then block until the pump in progress on the worker is done.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly)
+	bool bRunCallbacksOnWorkerThread = false;
+
+	/** How long the worker thread waits between two pumps while a request is outstanding. */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(EditCondition="bRunCallbacksOnWorkerThread", Units="Milliseconds", ClampMin="1"))
+	float WorkerPumpIntervalMs = 16.f;
+
+	/** The maximum time spent each frame dispatching the results and events handed back by the worker thread. */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(EditCondition="bRunCallbacksOnWorkerThread", Units="Milliseconds", ClampMin="0.01"))
+	float GameThreadDispatchBudgetMs = 1.f;
+
+	/**
+	 * The shortest time between two metadata updates of the same lobby or lobby member. The writes made in between are
+	 * merged into a single update.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Seconds", ClampMin="0"))
+	float LobbyWriteIntervalSeconds = 0.5f;
+
+	/**
+	 * The shortest time between two progress updates of the same achievement. Only the highest progress reported in
+	 * between is sent.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Seconds", ClampMin="0"))
+	float AchievementWriteIntervalSeconds = 2.f;
+
+	/**
+	 * The shortest time between two writes of the local volumes set for other users. Only the last volume set for each
+	 * user in between is written, e.g. while a slider is dragged.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Seconds", ClampMin="0"))
+	float VoiceVolumeWriteIntervalSeconds = 0.1f;
+
+	/**
+	 * The size of the chunks files are read in from the user's storage. Larger chunks take fewer round trips to the SDK,
+	 * smaller ones hold less of the file in memory at once.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Bytes", ClampMin="4096"))
+	int32 StorageChunkSize = 256 * 1024;
+
+	/**
+	 * The size of the regions save files are split into. Only the regions that changed are written again, so smaller
+	 * regions write less at the cost of more files.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Bytes", ClampMin="4096"))
+	int32 SaveFileRegionSize = 64 * 1024;
+
+	/** How many users fetched through `GetUser` are kept. Once full, the least recently used ones are dropped. */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(ClampMin="1"))
+	int32 UserCacheSize = 512;
+
+	/**
+	 * How long a user fetched through `GetUser` is kept before being fetched again, in case it changed. Set to 0 to
+	 * only share the lookups of the same user that are on their way.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(Units="Seconds", ClampMin="0"))
+	float UserCacheLifetimeSeconds = 300.f;
+
+	/**
+	 * How many avatar textures are kept in memory. Once full, the least recently used ones are dropped, and left to the
+	 * garbage collector once nothing else references them.
+	 */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(ClampMin="1"))
+	int32 AvatarCacheSize = 256;
+
+	/** The maximum number of avatar textures uploaded each frame. The others wait for the next frames. */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(ClampMin="1"))
+	int32 MaxAvatarUploadsPerFrame = 8;
+
+	/** Whether avatars are also cached on disk, so they don't need to be fetched from Discord after a restart. */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly)
+	bool bCacheAvatarsOnDisk = true;
+
+	/** How long an avatar cached on disk is used before being fetched from Discord again, in case it changed. */
+	UPROPERTY(Category="Performance", Config, EditDefaultsOnly, BlueprintReadOnly, meta=(EditCondition="bCacheAvatarsOnDisk", Units="Hours", ClampMin="0"))
+	float AvatarDiskCacheLifetimeHours = 24.f;
 };
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "DiscordOperation.h"
 #include "DiscordTypes.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Tickable.h"
@@ -11,6 +12,17 @@
 class UDiscordActivityManager;
 class UDiscordUserManager;
 class UDiscordOverlayManager;
+class UDiscordRelationshipManager;
+class UDiscordLobbyManager;
+class UDiscordNetworkManager;
+class UDiscordStorageManager;
+class UDiscordImageManager;
+class UDiscordAchievementManager;
+class UDiscordStoreManager;
+class UDiscordVoiceManager;
+class FDiscordCallbackPump;
+class FDiscordPumpScheduler;
+class FDiscordOperationTable;
 
 #define DISCORD_UE_VERSION (ENGINE_MAJOR_VERSION * 100 + ENGINE_MINOR_VERSION)
 
@@ -34,7 +46,7 @@ public:
 #if DISCORD_UE_VERSION < 505
 	virtual bool IsAllowedToTick() const override;
 #endif
-	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(UDiscordSubsystem, STATGROUP_Tickables); }
+	virtual TStatId GetStatId() const override;
 	// End FTickableGameObject interface
 
 	/**
@@ -62,8 +74,192 @@ public:
 	UFUNCTION(BlueprintPure, Category="Discord")
 	UDiscordOverlayManager* GetOverlayManager() const { check(OverlayManager); return OverlayManager; }
 
+	/**
+	 * Returns the current instance of Discord Relationship Manager.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	UDiscordRelationshipManager* GetRelationshipManager() const { check(RelationshipManager); return RelationshipManager; }
+
+	/**
+	 * Returns the current instance of Discord Lobby Manager.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	UDiscordLobbyManager* GetLobbyManager() const { check(LobbyManager); return LobbyManager; }
+
+	/**
+	 * Returns the current instance of Discord Network Manager.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	UDiscordNetworkManager* GetNetworkManager() const { check(NetworkManager); return NetworkManager; }
+
+	/**
+	 * Returns the current instance of Discord Storage Manager.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	UDiscordStorageManager* GetStorageManager() const { check(StorageManager); return StorageManager; }
+
+	/**
+	 * Returns the current instance of Discord Image Manager.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	UDiscordImageManager* GetImageManager() const { check(ImageManager); return ImageManager; }
+
+	/**
+	 * Returns the current instance of Discord Achievement Manager.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	UDiscordAchievementManager* GetAchievementManager() const { check(AchievementManager); return AchievementManager; }
+
+	/**
+	 * Returns the current instance of Discord Store Manager.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	UDiscordStoreManager* GetStoreManager() const { check(StoreManager); return StoreManager; }
+
+	/**
+	 * Returns the current instance of Discord Voice Manager.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	UDiscordVoiceManager* GetVoiceManager() const { check(VoiceManager); return VoiceManager; }
+
+	/**
+	 * Returns how many results and events were dispatched by the last pump of the SDK callbacks. Useful to tune the
+	 * pump rates in settings.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	int32 GetLastPumpCallbackCount() const;
+
+	/**
+	 * Returns how many requests are still waiting on their callback.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord")
+	int32 GetPendingRequestCount() const;
+
+	/**
+	 * Runs a task on the game thread. When callbacks are pumped on a worker thread, the task is queued and runs during
+	 * the next tick, otherwise it runs immediately without being copied.
+	 */
+	template <typename TaskType>
+	void RunOnGameThread(TaskType&& Task) const
+	{
+		if (CallbackPump)
+		{
+			QueueGameThreadTask(TUniqueFunction<void()>(Forward<TaskType>(Task)));
+		}
+		else
+		{
+			DispatchGameThreadTask(Task);
+		}
+	}
+
+	/**
+	 * Runs a command that calls into the SDK. When callbacks are pumped on a worker thread, the command is queued and
+	 * runs on that thread before its next pump, otherwise it runs immediately without being copied.
+	 */
+	template <typename CommandType>
+	void RunOnSdkThread(CommandType&& Command) const
+	{
+		if (CallbackPump)
+		{
+			QueueSdkCommand(TUniqueFunction<void()>(Forward<CommandType>(Command)));
+		}
+		else
+		{
+			Command();
+		}
+	}
+
+	/**
+	 * Returns the lock that synchronous SDK calls must hold when callbacks are pumped on a worker thread, or nullptr
+	 * when they are pumped on the game thread. The worker holds it for one command or one pump at a time, which is
+	 * how long a synchronous getter may block.
+	 */
+	FCriticalSection* GetSdkLock() const;
+
+	/**
+	 * Returns whether callbacks are pumped on a worker thread, in which case event arguments that only live for the
+	 * duration of the SDK callback must be copied before they're handed to the game thread.
+	 */
+	bool IsPumpingOnWorkerThread() const { return CallbackPump != nullptr; }
+
+	/**
+	 * Cancels a pending request. Its callback will never fire, even if the SDK answers later. Returns false if the
+	 * request already completed, timed out or was cancelled.
+	 */
+	bool CancelOperation(const FDiscordOperationHandle Handle) const;
+
+	/**
+	 * Starts the timeout of a pending request over, e.g. each time a long request makes progress. A negative timeout
+	 * uses the one from settings, zero never times out. Returns false if the request already completed, timed out or
+	 * was cancelled.
+	 */
+	bool RestartOperationTimeout(const FDiscordOperationHandle Handle, const float TimeoutSeconds) const;
+
+	/**
+	 * Wraps a native callback so that it always fires on the game thread, no matter which thread pumps the SDK. The
+	 * callback is held by the operation table, and the SDK only gets the handle to it. If the request times out
+	 * first, the callback fires with an `InternalError` result and default arguments, and the late SDK answer is
+	 * dropped. If it is cancelled, the callback never fires.
+	 *
+	 * A negative timeout uses the one from settings, zero never times out.
+	 */
+	template <typename ResultType, typename... ArgTypes>
+	auto WrapCallback(TFunction<void(ResultType, ArgTypes...)> Callback, const float TimeoutSeconds, FDiscordOperationHandle& OutHandle) const
+	{
+		using FOperation = TDiscordPendingOperation<ResultType, ArgTypes...>;
+
+		const FDiscordOperationHandle Handle = BeginOperation(TimeoutSeconds, MakeUnique<FOperation>(MoveTemp(Callback)));
+		OutHandle = Handle;
+
+		return [this, Handle](ResultType Result, ArgTypes... Args)
+		{
+			if (CallbackPump)
+			{
+				// The arguments only live for the duration of the SDK callback, so they're copied for the game thread
+				QueueGameThreadTask([this, Handle, Payload = MakeTuple(Result, std::decay_t<ArgTypes>(Args)...)]() mutable
+				{
+					if (const TUniquePtr<FDiscordPendingOperation> Operation = EndOperation(Handle))
+					{
+						Payload.ApplyAfter(static_cast<FOperation*>(Operation.Get())->Callback);
+					}
+				});
+			}
+			else
+			{
+				DispatchGameThreadTask([&]
+				{
+					if (const TUniquePtr<FDiscordPendingOperation> Operation = EndOperation(Handle))
+					{
+						static_cast<FOperation*>(Operation.Get())->Callback(Result, Args...);
+					}
+				});
+			}
+		};
+	}
+
 private:
+	/**
+	 * Starts tracking a request in the operation table.
+	 */
+	FDiscordOperationHandle BeginOperation(const float TimeoutSeconds, TUniquePtr<FDiscordPendingOperation>&& Operation) const;
+
+	/**
+	 * Stops tracking a request and hands it back. Returns nullptr if it already timed out or was cancelled, in which
+	 * case the SDK answer must be dropped.
+	 */
+	TUniquePtr<FDiscordPendingOperation> EndOperation(const FDiscordOperationHandle Handle) const;
+
+	void QueueGameThreadTask(TUniqueFunction<void()>&& Task) const;
+	void DispatchGameThreadTask(TFunctionRef<void()> Task) const;
+	void QueueSdkCommand(TUniqueFunction<void()>&& Command) const;
+
 	discord::Core* Core = nullptr;
+
+	FDiscordPumpScheduler* PumpScheduler = nullptr;
+
+	FDiscordOperationTable* OperationTable = nullptr;
+
+	FDiscordCallbackPump* CallbackPump = nullptr;
 	
 	UPROPERTY()
 	TObjectPtr<UDiscordActivityManager> ActivityManager;
@@ -73,4 +269,28 @@ private:
 
 	UPROPERTY()
 	TObjectPtr<UDiscordOverlayManager> OverlayManager;
+
+	UPROPERTY()
+	TObjectPtr<UDiscordRelationshipManager> RelationshipManager;
+
+	UPROPERTY()
+	TObjectPtr<UDiscordLobbyManager> LobbyManager;
+
+	UPROPERTY()
+	TObjectPtr<UDiscordNetworkManager> NetworkManager;
+
+	UPROPERTY()
+	TObjectPtr<UDiscordStorageManager> StorageManager;
+
+	UPROPERTY()
+	TObjectPtr<UDiscordImageManager> ImageManager;
+
+	UPROPERTY()
+	TObjectPtr<UDiscordAchievementManager> AchievementManager;
+
+	UPROPERTY()
+	TObjectPtr<UDiscordStoreManager> StoreManager;
+
+	UPROPERTY()
+	TObjectPtr<UDiscordVoiceManager> VoiceManager;
 };
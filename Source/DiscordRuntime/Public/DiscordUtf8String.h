@@ -0,0 +1,52 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * UTF-8 string stored inline in a fixed buffer, sized like the matching buffer of the native SDK struct. Copying to
+ * and from the SDK is a plain `memcpy`, with no allocation or transcoding. Converting to an FString only happens when
+ * asked for.
+ */
+template <int32 Capacity>
+struct TDiscordUtf8String
+{
+	static_assert(Capacity > 0, "TDiscordUtf8String needs room for its terminator");
+
+	TDiscordUtf8String()
+	{
+		Data[0] = '\0';
+	}
+
+	/**
+	 * Copies a whole native SDK buffer, which must be exactly Capacity bytes long.
+	 */
+	void CopyFromBuffer(const char* Buffer)
+	{
+		FMemory::Memcpy(Data, Buffer, Capacity);
+		Data[Capacity - 1] = '\0';
+	}
+
+	/**
+	 * Copies a null-terminated UTF-8 string, truncating it if needed.
+	 */
+	void CopyFromString(const char* String)
+	{
+		FCStringAnsi::Strncpy(Data, String, Capacity);
+	}
+
+	const char* Get() const { return Data; }
+
+	bool IsEmpty() const { return Data[0] == '\0'; }
+
+	FString ToString() const { return FString(UTF8_TO_TCHAR(Data)); }
+
+	bool operator==(const TDiscordUtf8String& Other) const { return FCStringAnsi::Strcmp(Data, Other.Data) == 0; }
+
+	bool operator!=(const TDiscordUtf8String& Other) const { return !(*this == Other); }
+
+private:
+	char Data[Capacity];
+};
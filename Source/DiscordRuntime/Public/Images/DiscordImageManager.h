@@ -0,0 +1,132 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordOperation.h"
+#include "DiscordTypes.h"
+#include "Containers/LruCache.h"
+#include "UObject/Object.h"
+#include "DiscordImageManager.generated.h"
+
+class UTexture2D;
+enum class EDiscordOutputPins : uint8;
+
+
+/**
+ * Identifies an avatar by its user and size.
+ */
+struct FDiscordAvatarKey
+{
+	int64 UserID;
+	uint32 Size;
+
+	bool operator==(const FDiscordAvatarKey& Other) const { return UserID == Other.UserID && Size == Other.Size; }
+
+	friend uint32 GetTypeHash(const FDiscordAvatarKey& Key) { return HashCombine(GetTypeHash(Key.UserID), GetTypeHash(Key.Size)); }
+};
+
+
+/**
+ * Fetches avatars into textures, and keeps the most recently used ones in memory and, optionally, on disk.
+ */
+UCLASS(Within=DiscordSubsystem)
+class DISCORDRUNTIME_API UDiscordImageManager : public UObject
+{
+	friend class UDiscordSubsystem;
+	
+	GENERATED_BODY()
+
+private:
+	UDiscordImageManager();
+	void Initialize(discord::ImageManager* ImageManager);
+	virtual void BeginDestroy() override;
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+	/** A fetched avatar waiting for its texture. Pixels is empty if it's read straight from the SDK. */
+	struct FPendingUpload
+	{
+		FDiscordAvatarKey Key;
+		FIntPoint Dimensions = FIntPoint::ZeroValue;
+		TArray<uint8> Pixels;
+	};
+
+	/**
+	 * Fetches an avatar from Discord, and queues its upload once the SDK has it.
+	 */
+	void FetchFromSdk(const FDiscordAvatarKey& Key);
+
+	/**
+	 * Loads an avatar from the disk cache on a worker thread, and queues its upload. Fetches it from Discord instead if
+	 * it isn't on disk, or if it's too old.
+	 */
+	void LoadFromDisk(const FDiscordAvatarKey& Key);
+
+	void SaveToDisk(const FDiscordAvatarKey& Key, const FIntPoint Dimensions, TArray<uint8>&& Pixels) const;
+
+	FString GetDiskCachePath(const FDiscordAvatarKey& Key) const;
+
+	/**
+	 * Uploads some of the fetched avatars to their textures, up to `MaxAvatarUploadsPerFrame`. Called once per frame by
+	 * the subsystem.
+	 */
+	void FlushPendingUploads();
+
+	void Upload(FPendingUpload& PendingUpload);
+
+	/**
+	 * Fires the callbacks of everyone waiting on an avatar. Also called when the fetch timed out, after which the next
+	 * request for the avatar fetches it again.
+	 */
+	void FinishFetch(const FDiscordAvatarKey& Key, const discord::Result Result, UTexture2D* Texture);
+
+private:
+	UPROPERTY()
+	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
+	
+	discord::ImageManager* Internal_ImageManager = nullptr;
+
+	FString DiskCacheDirectory;
+
+	// Everything below is only touched on the game thread. Textures that fall out of the cache aren't reused, since
+	// whoever fetched them may still be showing them
+	TLruCache<FDiscordAvatarKey, UTexture2D*> Avatars;
+
+	/** Everyone waiting on an avatar, and the operation that times the fetch out if it never completes. */
+	struct FPendingFetch
+	{
+		TArray<TFunction<void(discord::Result, UTexture2D*)>> Callbacks;
+
+		FDiscordOperationHandle Handle;
+	};
+
+	// So that an avatar is only fetched once no matter how many ask for it
+	TMap<FDiscordAvatarKey, FPendingFetch> PendingFetches;
+
+	TArray<FPendingUpload> PendingUploads;
+
+public:
+	/**
+	 * Fetches the avatar of a user into a texture. Size is rounded up to a power of two, from 16 to 256 pixels.
+	 *
+	 * A texture always shows the same avatar, so it can be held on to, e.g. by a widget brush, even after it fell out
+	 * of the cache.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Image", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void FetchAvatar(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 UserID, const int32 Size, UTexture2D*& Avatar, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Fetches the avatar of a user into a texture. Size is rounded up to a power of two, from 16 to 256 pixels. If the
+	 * avatar is cached, the callback fires right away.
+	 *
+	 * A texture always shows the same avatar, so it can be held on to, e.g. by a widget brush, even after it fell out
+	 * of the cache.
+	 */
+	FDiscordOperationHandle FetchAvatar(const int64 UserID, const int32 Size, TFunction<void(discord::Result, UTexture2D*)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Returns the avatar of a user if it's cached in memory, or nullptr.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Image")
+	UTexture2D* FindAvatar(const int64 UserID, const int32 Size);
+};
@@ -0,0 +1,65 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordTypes.h"
+#include "DiscordLobby.generated.h"
+
+
+UENUM(BlueprintType)
+namespace EDiscordLobbyTypes
+{
+	enum Type
+	{
+		Private = 1,
+		Public,
+	};
+}
+
+
+USTRUCT(BlueprintType)
+struct FDiscordLobby
+{
+	GENERATED_BODY()
+
+public:
+	FDiscordLobby() = default;
+
+	explicit FDiscordLobby(discord::Lobby const& Lobby);
+
+	/**
+	 * The lobby's ID.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Lobby")
+	int64 ID = 0;
+
+	/**
+	 * Whether the lobby can be found by searching, or only joined with its secret.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Lobby")
+	TEnumAsByte<EDiscordLobbyTypes::Type> Type = EDiscordLobbyTypes::Private;
+
+	/**
+	 * The user ID of the lobby owner.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Lobby")
+	int64 OwnerID = 0;
+
+	/**
+	 * The password to the lobby.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Lobby")
+	FString Secret;
+
+	/**
+	 * The max capacity of the lobby.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Lobby")
+	int32 Capacity = 0;
+
+	/**
+	 * Whether the lobby can be joined.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Lobby")
+	bool bLocked = false;
+};
@@ -0,0 +1,519 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordOperation.h"
+#include "DiscordRateLimiter.h"
+#include "DiscordTypes.h"
+#include "DiscordLobby.h"
+#include "Users/DiscordUser.h"
+#include "UObject/Object.h"
+#include "DiscordLobbyManager.generated.h"
+
+class FDiscordLobbyNetwork;
+enum class EDiscordOutputPins : uint8;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordLobbyUpdatedSignature, int64, LobbyID);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDiscordLobbyDeletedSignature, int64, LobbyID, int32, Reason);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDiscordLobbyMemberSignature, int64, LobbyID, int64, UserID);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnDiscordLobbyMetadataFlushedSignature, int64, LobbyID, int64, UserID, int32, NumWrites, int32, NumMerged);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnDiscordLobbyNetworkMessageSignature, int64, LobbyID, int64, UserID, uint8, ChannelID, const TArray<uint8>&, Data);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordLobbyUpdatedNative, int64 /* LobbyID */);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnDiscordLobbyDeletedNative, int64 /* LobbyID */, int32 /* Reason */);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnDiscordLobbyMemberNative, int64 /* LobbyID */, int64 /* UserID */);
+DECLARE_MULTICAST_DELEGATE_FourParams(FOnDiscordLobbyMetadataFlushedNative, int64 /* LobbyID */, int64 /* UserID */, int32 /* NumWrites */, int32 /* NumMerged */);
+DECLARE_MULTICAST_DELEGATE_FourParams(FOnDiscordLobbyNetworkMessageNative, int64 /* LobbyID */, int64 /* UserID */, uint8 /* ChannelID */, TArrayView<const uint8> /* Data */);
+
+
+/**
+ * Counters for the metadata writes that went through the write-combining queue.
+ */
+USTRUCT(BlueprintType)
+struct FDiscordLobbyWriteStats
+{
+	GENERATED_BODY()
+
+	/**
+	 * Metadata writes and deletes requested.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int32 Writes = 0;
+
+	/**
+	 * Writes replaced by a later one to the same key before they could be sent.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int32 Merged = 0;
+
+	/**
+	 * Lobby and member updates actually sent to Discord.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int32 Transactions = 0;
+};
+
+
+/**
+ * Counters for the messages that went through the lobby networking.
+ */
+USTRUCT(BlueprintType)
+struct FDiscordLobbyNetworkStats
+{
+	GENERATED_BODY()
+
+	/**
+	 * Messages handed to Discord.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int32 MessagesSent = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int64 BytesSent = 0;
+
+	/**
+	 * Messages dropped before they could be sent, either because an unreliable channel had too many queued or because
+	 * the network of their lobby was disconnected.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int32 MessagesDropped = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int32 MessagesReceived = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int64 BytesReceived = 0;
+
+	/**
+	 * Calls to `FlushNetwork`, at most one per frame.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Lobby")
+	int32 Flushes = 0;
+};
+
+
+UCLASS(Within=DiscordSubsystem)
+class DISCORDRUNTIME_API UDiscordLobbyManager : public UObject
+{
+	friend class UDiscordSubsystem;
+	
+	GENERATED_BODY()
+
+private:
+	UDiscordLobbyManager();
+	void Initialize(discord::LobbyManager* LobbyManager);
+	virtual void BeginDestroy() override;
+
+	/** A member of a connected lobby, as last read from the SDK. */
+	struct FMemberMirror
+	{
+		FDiscordUtf8User User;
+		TMap<FString, FString> Metadata;
+	};
+
+	/** A connected lobby, as last read from the SDK. */
+	struct FLobbyMirror
+	{
+		FDiscordLobby Lobby;
+		TMap<FString, FString> Metadata;
+		TMap<int64, FMemberMirror> Members;
+	};
+
+	/**
+	 * Reads a lobby and its metadata, and all its members if asked to. Must be called on the thread that pumps the
+	 * callbacks.
+	 */
+	static bool ReadLobby(discord::LobbyManager* LobbyManager, const int64 LobbyID, const bool bWithMembers, FLobbyMirror& OutLobby);
+
+	/**
+	 * Reads a member of a lobby and their metadata. Must be called on the thread that pumps the callbacks.
+	 */
+	static bool ReadMember(discord::LobbyManager* LobbyManager, const int64 LobbyID, const int64 UserID, FMemberMirror& OutMember);
+
+	/**
+	 * Reads a lobby that was just connected to, and hands it over to the game thread to start mirroring it. Must be
+	 * called on the thread that pumps the callbacks.
+	 */
+	void MirrorLobby(const int64 LobbyID);
+
+	/**
+	 * Stops mirroring a lobby once the game thread gets to it. Can be called from any thread.
+	 */
+	void ForgetLobby(const int64 LobbyID);
+
+	/**
+	 * Stops mirroring a lobby, and fails the metadata writes still waiting for it.
+	 */
+	void RemoveLobby(const int64 LobbyID);
+
+	/** Metadata entries to set, or to delete when unset. */
+	using FMetadataChanges = TMap<FString, TOptional<FString>>;
+
+	/** The metadata writes waiting to be sent for a lobby or a lobby member. */
+	struct FPendingWrites
+	{
+		FPendingWrites();
+
+		FDiscordRateLimiter RateLimiter;
+
+		FMetadataChanges Changes;
+
+		TArray<TFunction<void(discord::Result)>> Callbacks;
+
+		int32 NumWrites = 0;
+
+		double LastFlushTime = -UE_BIG_NUMBER;
+	};
+
+	/**
+	 * Queues a metadata write for a lobby, or a lobby member if UserID isn't 0.
+	 */
+	FDiscordOperationHandle QueueMetadataWrite(const int64 LobbyID, const int64 UserID, const FString& Key, TOptional<FString>&& Value, TFunction<void(discord::Result)>&& Callback, const float TimeoutSeconds);
+
+	/**
+	 * Sends one transaction for each lobby and member whose writes waited long enough, if the rate limit allows it.
+	 * Called every frame by the subsystem.
+	 */
+	void FlushPendingWrites(const double Now);
+
+	struct FFlushReport
+	{
+		int64 LobbyID;
+		int64 UserID;
+		int32 NumWrites;
+		int32 NumMerged;
+	};
+
+	void SendLobbyWrites(const int64 LobbyID, FPendingWrites& Writes, const double Now, TArray<FFlushReport>& OutReports);
+
+	void SendMemberWrites(const int64 LobbyID, const int64 UserID, FPendingWrites& Writes, const double Now, TArray<FFlushReport>& OutReports);
+
+	/**
+	 * Hands a received message to the handlers. Must be called on the game thread.
+	 */
+	void DispatchNetworkMessage(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const TArrayView<const uint8> Data);
+
+	/**
+	 * Sends all the queued messages, followed by a single `FlushNetwork`. Called every frame by the subsystem.
+	 */
+	void FlushNetworkMessages();
+
+private:
+	UPROPERTY()
+	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
+	
+	discord::LobbyManager* Internal_LobbyManager = nullptr;
+
+	int Internal_OnLobbyUpdateCallback;
+	int Internal_OnLobbyDeleteCallback;
+	int Internal_OnMemberConnectCallback;
+	int Internal_OnMemberUpdateCallback;
+	int Internal_OnMemberDisconnectCallback;
+	int Internal_OnNetworkMessageCallback;
+
+	// Only touched on the game thread
+	TMap<int64, FLobbyMirror> Lobbies;
+
+	TMap<int64, FPendingWrites> PendingLobbyWrites;
+
+	TMap<TPair<int64, int64>, FPendingWrites> PendingMemberWrites;
+
+	FDiscordLobbyWriteStats WriteStats;
+
+	FDiscordLobbyNetwork* Network = nullptr;
+
+public:
+	/**
+	 * Creates a lobby owned by the current user, and connects to it.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins", AutoCreateRefTerm="Metadata"))
+	void CreateLobby(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const EDiscordLobbyTypes::Type Type, const int32 Capacity, const bool bLocked, const TMap<FString, FString>& Metadata, FDiscordLobby& Lobby, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Creates a lobby owned by the current user, and connects to it.
+	 */
+	FDiscordOperationHandle CreateLobby(const EDiscordLobbyTypes::Type Type, const int32 Capacity, const bool bLocked, const TMap<FString, FString>& Metadata, TFunction<void(discord::Result, discord::Lobby const&)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Deletes a lobby owned by the current user. Everyone in it gets disconnected.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void DeleteLobby(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 LobbyID, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Deletes a lobby owned by the current user. Everyone in it gets disconnected.
+	 */
+	FDiscordOperationHandle DeleteLobby(const int64 LobbyID, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Connects to a lobby, given its ID and secret.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void ConnectLobby(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 LobbyID, const FString& Secret, FDiscordLobby& Lobby, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Connects to a lobby, given its ID and secret.
+	 */
+	FDiscordOperationHandle ConnectLobby(const int64 LobbyID, const FString& Secret, TFunction<void(discord::Result, discord::Lobby const&)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Connects to a lobby, given the secret received from an activity join or invite.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void ConnectLobbyWithActivitySecret(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& ActivitySecret, FDiscordLobby& Lobby, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Connects to a lobby, given the secret received from an activity join or invite.
+	 */
+	FDiscordOperationHandle ConnectLobbyWithActivitySecret(const FString& ActivitySecret, TFunction<void(discord::Result, discord::Lobby const&)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Disconnects the current user from a lobby.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void DisconnectLobby(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 LobbyID, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Disconnects the current user from a lobby.
+	 */
+	FDiscordOperationHandle DisconnectLobby(const int64 LobbyID, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Returns the secret to put in an activity, so that others can join the lobby through it. Returns whether the
+	 * call was a success.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby", meta=(ReturnDisplayName="Success"))
+	bool GetLobbyActivitySecret(const int64 LobbyID, FString& ActivitySecret) const;
+
+	/**
+	 * Sets a metadata value of a lobby owned by the current user. Writes are merged per lobby and sent as a single
+	 * update at most once per `LobbyWriteIntervalSeconds` (see settings), within Discord's rate limit.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby")
+	void SetLobbyMetadata(const int64 LobbyID, const FString& Key, const FString& Value);
+
+	/**
+	 * Sets a metadata value of a lobby owned by the current user. Writes are merged per lobby and sent as a single
+	 * update at most once per `LobbyWriteIntervalSeconds` (see settings), within Discord's rate limit. The callbacks of
+	 * all the writes merged into an update fire with its result.
+	 */
+	FDiscordOperationHandle SetLobbyMetadata(const int64 LobbyID, const FString& Key, const FString& Value, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Deletes a metadata value of a lobby owned by the current user. Merged with the other writes like `SetLobbyMetadata`.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby")
+	void DeleteLobbyMetadata(const int64 LobbyID, const FString& Key);
+
+	/**
+	 * Deletes a metadata value of a lobby owned by the current user. Merged with the other writes like `SetLobbyMetadata`.
+	 */
+	FDiscordOperationHandle DeleteLobbyMetadata(const int64 LobbyID, const FString& Key, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Sets a metadata value of a lobby member. Writes are merged per member like `SetLobbyMetadata`.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby")
+	void SetMemberMetadata(const int64 LobbyID, const int64 UserID, const FString& Key, const FString& Value);
+
+	/**
+	 * Sets a metadata value of a lobby member. Writes are merged per member like `SetLobbyMetadata`.
+	 */
+	FDiscordOperationHandle SetMemberMetadata(const int64 LobbyID, const int64 UserID, const FString& Key, const FString& Value, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Deletes a metadata value of a lobby member. Writes are merged per member like `SetLobbyMetadata`.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby")
+	void DeleteMemberMetadata(const int64 LobbyID, const int64 UserID, const FString& Key);
+
+	/**
+	 * Deletes a metadata value of a lobby member. Writes are merged per member like `SetLobbyMetadata`.
+	 */
+	FDiscordOperationHandle DeleteMemberMetadata(const int64 LobbyID, const int64 UserID, const FString& Key, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Returns how many metadata writes were requested, merged and sent so far.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby")
+	FDiscordLobbyWriteStats GetWriteStats() const { return WriteStats; }
+
+	/**
+	 * Connects the current user to the networking of a lobby, so that they can send and receive messages with its
+	 * other members. Returns whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(ReturnDisplayName="Success"))
+	bool ConnectNetwork(const int64 LobbyID);
+
+	/**
+	 * Disconnects the current user from the networking of a lobby. Messages still queued for it are dropped. Returns
+	 * whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(ReturnDisplayName="Success"))
+	bool DisconnectNetwork(const int64 LobbyID);
+
+	/**
+	 * Opens a channel to send messages on. Messages on a reliable channel arrive in order and are resent until they do,
+	 * those on an unreliable one may be lost. Returns whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(ReturnDisplayName="Success"))
+	bool OpenNetworkChannel(const int64 LobbyID, const uint8 ChannelID, const bool bReliable);
+
+	/**
+	 * Queues a message to a lobby member. Queued messages are sent together at the end of the frame. Returns false if
+	 * the channel isn't open.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Lobby", meta=(ReturnDisplayName="Success"))
+	bool SendNetworkMessage(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const TArray<uint8>& Data);
+
+	/**
+	 * Queues a message to a lobby member, copying it into a pooled buffer. Queued messages are sent together at the end
+	 * of the frame. Returns false if the channel isn't open.
+	 */
+	bool SendNetworkMessage(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const TArrayView<const uint8> Data);
+
+	/**
+	 * Queues a message to a lobby member, and returns a pooled buffer to write it into, or nullptr if the channel isn't
+	 * open. The message is sent with whatever the buffer holds at the end of the frame, so it can be serialized in place
+	 * without any copy. The pointer is only valid until then.
+	 */
+	TArray<uint8>* AllocNetworkMessage(const int64 LobbyID, const int64 UserID, const uint8 ChannelID, const int32 SizeHint = 0);
+
+	/**
+	 * Returns how many messages were sent, dropped and received so far.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby")
+	FDiscordLobbyNetworkStats GetNetworkStats() const;
+
+	// Everything below reads from a copy of the connected lobbies, refreshed when Discord reports a change, so it's
+	// cheap enough to poll every frame
+
+	/**
+	 * Returns the IDs of the lobbies the current user is connected to.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby")
+	TArray<int64> GetLobbyIDs() const;
+
+	/**
+	 * Finds a lobby the current user is connected to. Returns whether it was found.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby", meta=(ReturnDisplayName="Found"))
+	bool GetLobby(const int64 LobbyID, FDiscordLobby& Lobby) const;
+
+	/**
+	 * Finds a metadata value of a lobby. Returns whether it was found.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby", meta=(ReturnDisplayName="Found"))
+	bool GetLobbyMetadataValue(const int64 LobbyID, const FString& Key, FString& Value) const;
+
+	/**
+	 * Returns all the metadata of a lobby.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby")
+	TMap<FString, FString> GetLobbyMetadata(const int64 LobbyID) const;
+
+	/**
+	 * Returns the metadata of a lobby without copying it, or nullptr if the lobby isn't connected. The pointer is only
+	 * valid until the next tick.
+	 */
+	const TMap<FString, FString>* FindLobbyMetadata(const int64 LobbyID) const;
+
+	/**
+	 * Returns the user IDs of the members of a lobby.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby")
+	TArray<int64> GetMemberIDs(const int64 LobbyID) const;
+
+	/**
+	 * Returns how many members a lobby has.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby")
+	int32 GetMemberCount(const int64 LobbyID) const;
+
+	/**
+	 * Finds a member of a lobby. Returns whether they were found.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby", meta=(ReturnDisplayName="Found"))
+	bool GetMemberUser(const int64 LobbyID, const int64 UserID, FDiscordUser& User) const;
+
+	/**
+	 * Finds a metadata value of a lobby member. Returns whether it was found.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby", meta=(ReturnDisplayName="Found"))
+	bool GetMemberMetadataValue(const int64 LobbyID, const int64 UserID, const FString& Key, FString& Value) const;
+
+	/**
+	 * Returns all the metadata of a lobby member.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Lobby")
+	TMap<FString, FString> GetMemberMetadata(const int64 LobbyID, const int64 UserID) const;
+
+	/**
+	 * Returns the metadata of a lobby member without copying it, or nullptr if they aren't in a connected lobby. The
+	 * pointer is only valid until the next tick.
+	 */
+	const TMap<FString, FString>* FindMemberMetadata(const int64 LobbyID, const int64 UserID) const;
+
+public:
+	/**
+	 * Fires when a lobby changed, after its copy was refreshed. The lobby may have changed owner, capacity, metadata,
+	 * or something else.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Lobby")
+	FOnDiscordLobbyUpdatedSignature OnLobbyUpdated;
+
+	/**
+	 * Fires when a lobby the current user was connected to was deleted.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Lobby")
+	FOnDiscordLobbyDeletedSignature OnLobbyDeleted;
+
+	/**
+	 * Fires when a user connected to a lobby.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Lobby")
+	FOnDiscordLobbyMemberSignature OnMemberConnected;
+
+	/**
+	 * Fires when a lobby member changed, after their copy was refreshed. They may have changed their metadata, or
+	 * their user may have changed.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Lobby")
+	FOnDiscordLobbyMemberSignature OnMemberUpdated;
+
+	/**
+	 * Fires when a user disconnected from a lobby.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Lobby")
+	FOnDiscordLobbyMemberSignature OnMemberDisconnected;
+
+	/**
+	 * Fires each time queued metadata writes are sent as one update, with how many writes it holds and how many of
+	 * them were replaced by a later write to the same key. UserID is 0 for the lobby's own metadata.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Lobby")
+	FOnDiscordLobbyMetadataFlushedSignature OnMetadataFlushed;
+
+	/**
+	 * Fires when a message was received from a lobby member. The data is copied into an array for each broadcast, so
+	 * native code should rather bind to `OnNetworkMessageNative`.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Lobby")
+	FOnDiscordLobbyNetworkMessageSignature OnNetworkMessage;
+
+	/**
+	 * Fires when a message was received from a lobby member, before `OnNetworkMessage`. The data is a view over the
+	 * buffer it was received in, and is only valid for the duration of the broadcast.
+	 */
+	FOnDiscordLobbyNetworkMessageNative OnNetworkMessageNative;
+
+	/**
+	 * Native versions of the lobby and member events above. Each one fires right before its Blueprint counterpart, after
+	 * the copies of the lobby and its members were updated.
+	 */
+	FOnDiscordLobbyUpdatedNative OnLobbyUpdatedNative;
+	FOnDiscordLobbyDeletedNative OnLobbyDeletedNative;
+	FOnDiscordLobbyMemberNative OnMemberConnectedNative;
+	FOnDiscordLobbyMemberNative OnMemberUpdatedNative;
+	FOnDiscordLobbyMemberNative OnMemberDisconnectedNative;
+	FOnDiscordLobbyMetadataFlushedNative OnMetadataFlushedNative;
+};
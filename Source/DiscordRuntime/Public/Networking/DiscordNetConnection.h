@@ -0,0 +1,31 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/NetConnection.h"
+#include "DiscordNetConnection.generated.h"
+
+
+/**
+ * Connection to a Discord peer, for `UDiscordNetDriver`.
+ */
+UCLASS(Transient, Config=Engine)
+class DISCORDRUNTIME_API UDiscordNetConnection : public UNetConnection
+{
+	GENERATED_BODY()
+
+public:
+	// Begin UNetConnection interface
+	virtual void InitBase(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, EConnectionState InState, int32 InMaxPacket = 0, int32 InPacketOverhead = 0) override;
+	virtual void InitRemoteConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, const FInternetAddr& InRemoteAddr, EConnectionState InState, int32 InMaxPacket = 0, int32 InPacketOverhead = 0) override;
+	virtual void InitLocalConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, EConnectionState InState, int32 InMaxPacket = 0, int32 InPacketOverhead = 0) override;
+	virtual void LowLevelSend(void* Data, int32 CountBits, FOutPacketTraits& Traits) override;
+	virtual FString LowLevelGetRemoteAddress(bool bAppendPort = false) override;
+	virtual FString LowLevelDescribe() override;
+	// End UNetConnection interface
+
+	uint64 GetPeerID() const { return PeerID; }
+
+private:
+	uint64 PeerID = 0;
+};
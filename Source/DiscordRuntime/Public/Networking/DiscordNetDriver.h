@@ -0,0 +1,135 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/NetDriver.h"
+#include "DiscordNetworkManager.h"
+#include "DiscordNetDriver.generated.h"
+
+class FDiscordBufferPool;
+class FDiscordInternetAddr;
+class FDiscordNetReceiveBuffer;
+class UDiscordSubsystem;
+
+
+/**
+ * Net driver that sends replication through Discord's relays, on top of the Network Manager. Connect to a server by
+ * travelling to its peer ID, once both ends opened each other as peers with their routes (see
+ * `UDiscordNetworkManager::OpenPeer`).
+ *
+ * Packets are batched per peer into messages up to `MaxMessageSize`, and everything is sent with a single `Flush` per
+ * net tick. The engine already takes care of reliability, so all the traffic goes through one unreliable channel.
+ * Received messages are handed over from the pumping thread through a ring buffer, drained every net tick.
+ */
+UCLASS(Transient, Config=Engine)
+class DISCORDRUNTIME_API UDiscordNetDriver : public UNetDriver
+{
+	GENERATED_BODY()
+
+public:
+	/** Each packet in a message is prefixed with its size. */
+	static constexpr int32 PacketHeaderSize = sizeof(uint16);
+
+	UDiscordNetDriver(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	/**
+	 * Largest message sent to Discord. Packets are batched into messages up to this size, so it also bounds the size of
+	 * a packet.
+	 */
+	UPROPERTY(Config)
+	int32 MaxMessageSize = 1200;
+
+	/**
+	 * Size in bytes of the buffer received messages wait in until the next net tick. Messages that don't fit are
+	 * dropped, and resent by the engine if they held anything reliable.
+	 */
+	UPROPERTY(Config)
+	int32 ReceiveBufferSize = 256 * 1024;
+
+	/**
+	 * Channel of the Network Manager the driver sends and receives on.
+	 */
+	UPROPERTY(Config)
+	uint8 DiscordChannelID = 0;
+
+	// Begin UNetDriver interface
+	virtual bool IsAvailable() const override;
+	virtual bool InitBase(bool bInitAsClient, FNetworkNotify* InNotify, const FURL& URL, bool bReuseAddressAndPort, FString& Error) override;
+	virtual bool InitConnect(FNetworkNotify* InNotify, const FURL& ConnectURL, FString& Error) override;
+	virtual bool InitListen(FNetworkNotify* InNotify, FURL& ListenURL, bool bReuseAddressAndPort, FString& Error) override;
+	virtual void TickDispatch(float DeltaTime) override;
+	virtual void TickFlush(float DeltaSeconds) override;
+	virtual void LowLevelSend(TSharedPtr<const FInternetAddr> Address, void* Data, int32 CountBits, FOutPacketTraits& Traits) override;
+	virtual FString LowLevelGetNetworkNumber() override;
+	virtual void LowLevelDestroy() override;
+	virtual ISocketSubsystem* GetSocketSubsystem() override { return nullptr; }
+	virtual bool IsNetResourceValid() override;
+	// End UNetDriver interface
+
+	/**
+	 * Queues a packet for a peer. It goes out in a batch with the others at the end of the net tick.
+	 */
+	void QueuePacket(const uint64 PeerID, const uint8* Data, const int32 Count);
+
+	/**
+	 * Returns the largest packet that fits in a message.
+	 */
+	int32 GetMaxPacketSize() const;
+
+private:
+	/**
+	 * Finds the subsystem of the game instance this driver belongs to, even before it has a world.
+	 */
+	UDiscordSubsystem* FindDiscordSubsystem() const;
+
+	/**
+	 * Opens the channel to a peer if it isn't yet. Returns whether it is open.
+	 */
+	bool OpenChannelTo(const uint64 PeerID);
+
+	/**
+	 * Splits a received message back into packets, and hands them to their connection.
+	 */
+	void ReceiveMessage(const uint64 PeerID, TArray<uint8>& Message);
+
+	void ReceivePacket(const uint64 PeerID, uint8* Data, const int32 Count);
+
+	/**
+	 * Runs the stateless handshake for a packet from a peer that has no connection yet, and accepts the connection
+	 * once it's done.
+	 */
+	UNetConnection* ProcessConnectionlessPacket(const uint64 PeerID, uint8*& Data, int32& Count);
+
+	/**
+	 * Sends the queued messages, followed by a single `Flush`.
+	 */
+	void SendQueuedMessages();
+
+	TWeakObjectPtr<UDiscordNetworkManager> NetworkManager;
+
+	FDelegateHandle MessageHandle;
+
+	uint64 LocalPeerID = 0;
+
+	uint64 ServerPeerID = 0;
+
+	TSet<uint64> OpenChannels;
+
+	// Shared with the pumping thread, which fills it
+	TSharedPtr<FDiscordNetReceiveBuffer, ESPMode::ThreadSafe> ReceiveBuffer;
+
+	// Shared with the SDK thread, which gives the buffers back once sent
+	TSharedPtr<FDiscordBufferPool, ESPMode::ThreadSafe> BufferPool;
+
+	// The message being filled for each peer
+	TMap<uint64, TArray<uint8>> OpenMessages;
+
+	// Full messages waiting for the end of the net tick
+	TArray<FDiscordNetworkMessage> QueuedMessages;
+
+	TArray<uint8> ReceivedMessage;
+
+	TSharedPtr<FDiscordInternetAddr> LookupAddress;
+
+	int32 LastNumDropped = 0;
+};
@@ -0,0 +1,134 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordTypes.h"
+#include "UObject/Object.h"
+#include "DiscordNetworkManager.generated.h"
+
+class FDiscordBufferPool;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordRouteUpdatedSignature, const FString&, Route);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordRouteUpdatedNative, const FString& /* Route */);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnDiscordNetworkMessageNative, uint64 /* PeerID */, uint8 /* ChannelID */, TArrayView<const uint8> /* Data */);
+
+
+/**
+ * A message to send to a peer.
+ */
+struct FDiscordNetworkMessage
+{
+	uint64 PeerID;
+	uint8 ChannelID;
+	TArray<uint8> Data;
+};
+
+
+UCLASS(Within=DiscordSubsystem)
+class DISCORDRUNTIME_API UDiscordNetworkManager : public UObject
+{
+	friend class UDiscordSubsystem;
+	
+	GENERATED_BODY()
+
+private:
+	UDiscordNetworkManager();
+	void Initialize(discord::NetworkManager* NetworkManager);
+	virtual void BeginDestroy() override;
+
+private:
+	UPROPERTY()
+	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
+	
+	discord::NetworkManager* Internal_NetworkManager = nullptr;
+
+	int Internal_OnMessageCallback;
+	int Internal_OnRouteUpdateCallback;
+
+	// Read once, it doesn't change for the lifetime of the process
+	uint64 LocalPeerID = 0;
+
+	// Only touched on the game thread
+	FString CurrentRoute;
+
+	// Broadcast on the thread that pumps the callbacks, and only changed with the SDK locked
+	FOnDiscordNetworkMessageNative MessageHandlers;
+
+public:
+	/**
+	 * Returns the peer ID of the current process, which others need to open a connection to it. Peer IDs are unsigned
+	 * 64-bit integers, so they may come out negative in Blueprints.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Network")
+	int64 GetPeerID() const { return static_cast<int64>(LocalPeerID); }
+
+	/**
+	 * Returns the route to the current process, which others need along with its peer ID to open a connection to it.
+	 * Empty until Discord found one. It can change over time, see `OnRouteUpdated`.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Network")
+	FString GetRoute() const { return CurrentRoute; }
+
+	/**
+	 * Opens a connection to a remote peer, given its peer ID and route. Returns whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Network", meta=(ReturnDisplayName="Success"))
+	bool OpenPeer(const int64 PeerID, const FString& Route);
+
+	/**
+	 * Updates the route of a connected peer, after it changed on their end. Returns whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Network", meta=(ReturnDisplayName="Success"))
+	bool UpdatePeer(const int64 PeerID, const FString& Route);
+
+	/**
+	 * Closes the connection to a remote peer, along with its channels. Returns whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Network", meta=(ReturnDisplayName="Success"))
+	bool ClosePeer(const int64 PeerID);
+
+	/**
+	 * Opens a channel to a connected peer. Messages on a reliable channel arrive in order and are resent until they do,
+	 * those on an unreliable one may be lost. Returns whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Network", meta=(ReturnDisplayName="Success"))
+	bool OpenChannel(const int64 PeerID, const uint8 ChannelID, const bool bReliable);
+
+	/**
+	 * Closes a channel to a connected peer. Returns whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Network", meta=(ReturnDisplayName="Success"))
+	bool CloseChannel(const int64 PeerID, const uint8 ChannelID);
+
+	/**
+	 * Sends messages to connected peers, followed by a single `Flush`. Their buffers are given back to the pool once
+	 * the SDK is done with them.
+	 */
+	void SendMessages(TArray<FDiscordNetworkMessage>&& Messages, const TSharedPtr<FDiscordBufferPool, ESPMode::ThreadSafe>& BufferPool = nullptr);
+
+	/**
+	 * Closes a channel once the messages already passed to `SendMessages` are sent.
+	 */
+	void CloseChannelAfterSends(const uint64 PeerID, const uint8 ChannelID);
+
+	/**
+	 * Adds a handler for the received messages. Handlers are called on the thread that pumps the callbacks, with a view
+	 * over the buffer the message was received in, which is only valid during the call.
+	 */
+	FDelegateHandle AddMessageHandler(FOnDiscordNetworkMessageNative::FDelegate&& Handler);
+
+	void RemoveMessageHandler(const FDelegateHandle Handle);
+
+public:
+	/**
+	 * Fires when the route to the current process changed. It must be handed to the connected peers again, for them to
+	 * call `UpdatePeer` with it.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Network")
+	FOnDiscordRouteUpdatedSignature OnRouteUpdated;
+
+	/**
+	 * Fires when the route to the current process changed, before `OnRouteUpdated`.
+	 */
+	FOnDiscordRouteUpdatedNative OnRouteUpdatedNative;
+};
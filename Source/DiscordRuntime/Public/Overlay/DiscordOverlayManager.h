@@ -2,14 +2,17 @@
 
 #pragma once
 
+#include "DiscordOperation.h"
 #include "DiscordTypes.h"
 #include "UObject/Object.h"
 #include "DiscordOverlayManager.generated.h"
 
 enum class EDiscordOutputPins : uint8;
+struct FDiscordUtf8User;
 
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordOverlayToggledSignature, bool, bLocked);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordOverlayToggledNative, bool /* bLocked */);
 
 UCLASS(Within=DiscordSubsystem)
 class DISCORDRUNTIME_API UDiscordOverlayManager : public UObject
@@ -23,6 +26,11 @@ private:
 	void Initialize(discord::OverlayManager* OverlayManager);
 	virtual void BeginDestroy() override;
 
+	/**
+	 * Reads the overlay state again once Discord is connected, since before that the SDK only reports its defaults.
+	 */
+	void OnCurrentUserUpdated(const FDiscordUtf8User& User);
+
 private:
 	UPROPERTY()
 	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
@@ -31,19 +39,25 @@ private:
 
 	int Internal_OnToggleCallback;
 
+	// Only touched on the game thread
+	bool bOverlayEnabled = false;
+	bool bOverlayLocked = true;
+
 public:
 	/**
 	 * Return whether the user has the overlay enabled or disabled. If the overlay is disabled, all the functionality in
 	 * this manager will still work. The calls will instead focus the Discord client and show the modal there instead.
+	 * Answered from memory, read again every time the overlay is toggled or the current user updates.
 	 */
 	UFUNCTION(BlueprintPure, Category="Discord|Overlay")
-	bool IsEnabled() const;
+	bool IsEnabled() const { return bOverlayEnabled; }
 
 	/**
-	 * Return whether the overlay is currently locked or unlocked
+	 * Return whether the overlay is currently locked or unlocked. Answered from memory, kept up to date by `OnToggled`,
+	 * so it's cheap enough to be checked every frame.
 	 */
 	UFUNCTION(BlueprintPure, Category="Discord|Overlay")
-	bool IsLocked() const;
+	bool IsLocked() const { return bOverlayLocked; }
 
 	/**
 	 * Locks or unlocks input in the overlay. Calling `SetLocked(true)` will also close any modals in the overlay.
@@ -54,7 +68,7 @@ public:
 	/**
 	 * Locks or unlocks input in the overlay. Calling `SetLocked(true)` will also close any modals in the overlay.
 	 */
-	void SetLocked(const bool bLocked, TFunction<void(discord::Result)> Callback);
+	FDiscordOperationHandle SetLocked(const bool bLocked, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
 	
 	/**
 	 * Opens the overlay modal for sending game invitations to users, channels, and servers. If you do not have a valid
@@ -82,4 +96,10 @@ public:
 	 */
 	UPROPERTY(BlueprintAssignable, Category="Discord|Overlay")
 	FOnDiscordOverlayToggledSignature OnToggled;
+
+	/**
+	 * Fires when the overlay is locked or unlocked, before `OnToggled`. For C++ code, e.g. input routing, that doesn't
+	 * need to go through Blueprint.
+	 */
+	FOnDiscordOverlayToggledNative OnToggledNative;
 };
@@ -0,0 +1,71 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordTypes.h"
+#include "Activities/DiscordActivity.h"
+#include "Users/DiscordUser.h"
+#include "DiscordRelationship.generated.h"
+
+
+UENUM(BlueprintType)
+namespace EDiscordRelationshipTypes
+{
+	enum Type
+	{
+		None,
+		Friend,
+		Blocked,
+		PendingIncoming,
+		PendingOutgoing,
+		Implicit,
+	};
+}
+
+UENUM(BlueprintType)
+namespace EDiscordStatusTypes
+{
+	enum Type
+	{
+		Offline,
+		Online,
+		Idle,
+		DoNotDisturb    UMETA(DisplayName="Do Not Disturb"),
+	};
+}
+
+
+USTRUCT(BlueprintType)
+struct FDiscordRelationship
+{
+	GENERATED_BODY()
+
+public:
+	FDiscordRelationship() = default;
+
+	explicit FDiscordRelationship(discord::Relationship const& Relationship);
+
+	/**
+	 * What the current user is to this user.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Relationship")
+	TEnumAsByte<EDiscordRelationshipTypes::Type> Type = EDiscordRelationshipTypes::None;
+
+	/**
+	 * The user the relationship is with.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Relationship")
+	FDiscordUser User;
+
+	/**
+	 * The user's online status.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Relationship")
+	TEnumAsByte<EDiscordStatusTypes::Type> Status = EDiscordStatusTypes::Offline;
+
+	/**
+	 * What the user is currently doing.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Relationship")
+	FDiscordActivity Activity;
+};
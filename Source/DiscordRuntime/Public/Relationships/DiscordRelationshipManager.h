@@ -0,0 +1,152 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordTypes.h"
+#include "DiscordRelationship.h"
+#include "UObject/Object.h"
+#include "DiscordRelationshipManager.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDiscordRelationshipsRefreshedSignature);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordRelationshipsUpdatedSignature, const TArray<int64>&, UserIDs);
+DECLARE_MULTICAST_DELEGATE(FOnDiscordRelationshipsRefreshedNative);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordRelationshipsUpdatedNative, const TSet<int64>& /* UserIDs */);
+
+
+UENUM(BlueprintType)
+namespace EDiscordFriendFilters
+{
+	enum Type
+	{
+		All,
+		Online,
+		InGame              UMETA(DisplayName="In Game"),
+		SameApplication     UMETA(DisplayName="Playing This Game"),
+	};
+}
+
+
+UCLASS(Within=DiscordSubsystem)
+class DISCORDRUNTIME_API UDiscordRelationshipManager : public UObject
+{
+	friend class UDiscordSubsystem;
+	
+	GENERATED_BODY()
+
+private:
+	UDiscordRelationshipManager();
+	void Initialize(discord::RelationshipManager* RelationshipManager);
+	virtual void BeginDestroy() override;
+
+	/**
+	 * Broadcasts the changes gathered since the last call, at most once per event. Called every frame by the subsystem.
+	 */
+	void FlushNotifications();
+
+	/** A relationship as read on the pumping thread, handed over to the game thread as is. */
+	struct FRow
+	{
+		int64 UserID = 0;
+		EDiscordRelationshipTypes::Type Type = EDiscordRelationshipTypes::None;
+		EDiscordStatusTypes::Type Status = EDiscordStatusTypes::Offline;
+		FDiscordUtf8User User;
+		FDiscordUtf8Activity Activity;
+	};
+
+	static FRow MakeRow(discord::Relationship const& Relationship);
+
+	void ApplyRefresh(TArray<FRow>&& Rows);
+
+	void ApplyUpdate(FRow&& Row);
+
+	void SetRow(const int32 Index, FRow&& Row);
+
+	void RemoveRow(const int32 Index);
+
+	const TBitArray<>& GetFriendIndex(const EDiscordFriendFilters::Type Filter) const;
+
+private:
+	UPROPERTY()
+	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
+	
+	discord::RelationshipManager* Internal_RelationshipManager = nullptr;
+
+	int Internal_OnRefreshCallback;
+	int Internal_OnRelationshipUpdateCallback;
+
+	// Relationships are stored as a structure of arrays, one row per user, so that the indices can be walked quickly
+	TArray<int64> UserIDs;
+	TArray<EDiscordRelationshipTypes::Type> Types;
+	TArray<EDiscordStatusTypes::Type> Statuses;
+	TArray<FDiscordUtf8User> Users;
+	TArray<FDiscordUtf8Activity> Activities;
+
+	TMap<int64, int32> RowByUserID;
+
+	// One bit per row
+	TBitArray<> Friends;
+	TBitArray<> OnlineFriends;
+	TBitArray<> InGameFriends;
+	TBitArray<> SameApplicationFriends;
+
+	TSet<int64> ChangedUserIDs;
+
+	bool bRefreshed = false;
+
+public:
+	/**
+	 * Finds the relationship with a given user. Returns whether there is one.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Relationship", meta=(ReturnDisplayName="Found"))
+	bool GetRelationship(const int64 UserID, FDiscordRelationship& Relationship) const;
+
+	/**
+	 * Returns how many relationships the current user has, of any type.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Relationship")
+	int32 GetRelationshipCount() const { return UserIDs.Num(); }
+
+	/**
+	 * Returns the IDs of the friends matching the filter. The lists are kept up to date as relationships change, so
+	 * this doesn't walk every relationship.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Relationship")
+	TArray<int64> GetFriendIDs(const EDiscordFriendFilters::Type Filter) const;
+
+	/**
+	 * Returns how many friends match the filter.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Relationship")
+	int32 GetFriendCount(const EDiscordFriendFilters::Type Filter) const;
+
+	/**
+	 * Calls the function with the ID of each friend matching the filter, without copying anything.
+	 */
+	void ForEachFriend(const EDiscordFriendFilters::Type Filter, TFunctionRef<void(int64 UserID)> Function) const;
+
+public:
+	/**
+	 * Fires when Discord sent the whole list of relationships again, replacing the cached one. Fires at most once per
+	 * frame, and replaces OnRelationshipsUpdated on that frame.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Relationship")
+	FOnDiscordRelationshipsRefreshedSignature OnRefreshed;
+
+	/**
+	 * Fires with the IDs of the users whose relationship changed since the last frame. Fires at most once per frame,
+	 * no matter how many relationships changed.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Relationship")
+	FOnDiscordRelationshipsUpdatedSignature OnRelationshipsUpdated;
+
+	/**
+	 * Fires before `OnRefreshed`.
+	 */
+	FOnDiscordRelationshipsRefreshedNative OnRefreshedNative;
+
+	/**
+	 * Fires before `OnRelationshipsUpdated`, with the set the changes were gathered in. The IDs are only copied into
+	 * an array when a Blueprint delegate is bound.
+	 */
+	FOnDiscordRelationshipsUpdatedNative OnRelationshipsUpdatedNative;
+};
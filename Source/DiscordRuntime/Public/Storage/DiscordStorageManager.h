@@ -0,0 +1,215 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordOperation.h"
+#include "DiscordTypes.h"
+#include "UObject/Object.h"
+#include "DiscordStorageManager.generated.h"
+
+class FDiscordBufferPool;
+enum class EDiscordOutputPins : uint8;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnDiscordStorageReadProgressSignature, const FString&, Name, int64, BytesRead, int64, TotalBytes);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnDiscordStorageReadProgressNative, const FString& /* Name */, int64 /* BytesRead */, int64 /* TotalBytes */);
+
+
+/**
+ * A file in the user's storage.
+ */
+USTRUCT(BlueprintType)
+struct FDiscordFileStat
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Storage")
+	FString Filename;
+
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Storage")
+	int64 Size = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Discord|Storage")
+	FDateTime LastModified;
+};
+
+
+UCLASS(Within=DiscordSubsystem)
+class DISCORDRUNTIME_API UDiscordStorageManager : public UObject
+{
+	friend class UDiscordSubsystem;
+	
+	GENERATED_BODY()
+
+private:
+	UDiscordStorageManager();
+	void Initialize(discord::StorageManager* StorageManager);
+	virtual void BeginDestroy() override;
+
+	struct FRead;
+	struct FSaveFileWrite;
+
+	/** The regions of a save file, and what they held when last read or written. */
+	struct FSaveFileManifest
+	{
+		uint32 RegionSize = 0;
+		uint64 Size = 0;
+		TArray<uint64> RegionHashes;
+	};
+
+	/**
+	 * Reads the manifest of a save file. Must be called with the SDK locked.
+	 */
+	discord::Result ReadManifest(const FString& Name, FSaveFileManifest& OutManifest) const;
+
+	/**
+	 * Starts reading the parts of a file once they're known. Must be called on the thread that pumps the callbacks.
+	 */
+	void BeginRead(const TSharedRef<FRead, ESPMode::ThreadSafe>& Read);
+
+	/**
+	 * Requests the next chunk of a read. Must be called on the thread that pumps the callbacks.
+	 */
+	void ReadNextChunk(const TSharedRef<FRead, ESPMode::ThreadSafe>& Read);
+
+	/**
+	 * Checks a chunk the SDK read, and hands it to the game thread. Must be called on the thread that pumps the
+	 * callbacks.
+	 */
+	void OnChunkRead(const TSharedRef<FRead, ESPMode::ThreadSafe>& Read, discord::Result Result, const int32 PartIndex, const uint64 Offset, const uint64 Length, const TArrayView<const uint8> Chunk);
+
+	/**
+	 * Copies a chunk into the result of its read, or hands it to the read's chunk handler. Must be called on the game
+	 * thread.
+	 */
+	void ConsumeChunk(FRead& Read, const uint64 Offset, const TArrayView<const uint8> Chunk);
+
+	/**
+	 * Writes the regions of a save file that changed since it was last read or written, then its manifest. Must be
+	 * called on the thread that pumps the callbacks.
+	 */
+	void WriteSaveFileRegions(const FString& Name, TArray<uint8>&& Data, const uint32 RegionSize, TFunction<void(discord::Result)>&& Callback);
+
+	void WriteManifest(const TSharedRef<FSaveFileWrite, ESPMode::ThreadSafe>& Write);
+
+private:
+	UPROPERTY()
+	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
+	
+	discord::StorageManager* Internal_StorageManager = nullptr;
+
+	// Only touched with the SDK locked
+	TMap<FString, FSaveFileManifest> SaveFileManifests;
+
+	// Holds the chunks on their way from the pumping thread to the game thread
+	FDiscordBufferPool* ChunkPool = nullptr;
+
+public:
+	/**
+	 * Reads a file from the user's storage.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Storage", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void ReadFile(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& Name, TArray<uint8>& Data, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Reads a file from the user's storage. It is read in chunks of `StorageChunkSize` bytes (see settings), so that
+	 * the SDK never holds more than a couple of them at a time, and `OnReadProgress` fires for each. The data can be
+	 * moved out of the callback. The timeout applies to each chunk rather than the whole file, since the time the file
+	 * takes grows with its size, and it never times out unless asked to. Cancelling it stops the read at the next chunk.
+	 */
+	FDiscordOperationHandle ReadFile(const FString& Name, TFunction<void(discord::Result, TArray<uint8>&)> Callback, const float TimeoutSeconds = 0.f);
+
+	/**
+	 * Reads a file from the user's storage like `ReadFile`, but hands each chunk to a handler on the game thread
+	 * instead of putting the file together. Chunks arrive in order, and are only valid during the call. Timeouts and
+	 * cancelling work like in `ReadFile`.
+	 */
+	FDiscordOperationHandle StreamFile(const FString& Name, TFunction<void(TArrayView<const uint8>, uint64)> ChunkHandler, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = 0.f);
+
+	/**
+	 * Writes a file to the user's storage, replacing it if it exists.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Storage", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void WriteFile(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& Name, const TArray<uint8>& Data, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Writes a file to the user's storage, replacing it if it exists. The data is moved along until the SDK is done
+	 * with it, so it's never copied when passed with `MoveTemp`.
+	 */
+	FDiscordOperationHandle WriteFile(const FString& Name, TArray<uint8> Data, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = 0.f);
+
+	/**
+	 * Reads a save file written by `WriteSaveFile`.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Storage", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void ReadSaveFile(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& Name, TArray<uint8>& Data, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Reads a save file written by `WriteSaveFile`, one region at a time like `ReadFile`. Each region is checked
+	 * against its hash in the manifest, so a save file left half written fails to read instead of coming back mixed.
+	 * Timeouts and cancelling work like in `ReadFile`.
+	 */
+	FDiscordOperationHandle ReadSaveFile(const FString& Name, TFunction<void(discord::Result, TArray<uint8>&)> Callback, const float TimeoutSeconds = 0.f);
+
+	/**
+	 * Writes a save file, split into regions of `SaveFileRegionSize` bytes (see settings) stored as separate files next
+	 * to a small manifest.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Storage", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void WriteSaveFile(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FString& Name, const TArray<uint8>& Data, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Writes a save file, split into regions of `SaveFileRegionSize` bytes (see settings) stored as separate files next
+	 * to a small manifest. Only the regions that changed since the save file was last read or written are written
+	 * again, and nothing at all if none did. The data is hashed off the game thread.
+	 */
+	FDiscordOperationHandle WriteSaveFile(const FString& Name, TArray<uint8> Data, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = 0.f);
+
+	/**
+	 * Deletes a file from the user's storage. Returns whether the call was a success. Not named `DeleteFile`, which
+	 * Windows.h defines as a macro.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Storage", meta=(ReturnDisplayName="Success"))
+	bool RemoveFile(const FString& Name);
+
+	/**
+	 * Deletes a save file written by `WriteSaveFile`, along with its regions. Returns whether the call was a success.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Storage", meta=(ReturnDisplayName="Success"))
+	bool RemoveSaveFile(const FString& Name);
+
+	/**
+	 * Returns whether a file exists in the user's storage.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Storage")
+	bool FileExists(const FString& Name) const;
+
+	/**
+	 * Finds a file in the user's storage. Returns whether it was found.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Storage", meta=(ReturnDisplayName="Found"))
+	bool GetFileStat(const FString& Name, FDiscordFileStat& Stat) const;
+
+	/**
+	 * Returns all the files in the user's storage.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Storage")
+	TArray<FDiscordFileStat> GetFileStats() const;
+
+	/**
+	 * Returns the path to the user's storage on disk.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Storage")
+	FString GetPath() const;
+
+public:
+	/**
+	 * Fires on the game thread each time a chunk of a file being read arrived.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Storage")
+	FOnDiscordStorageReadProgressSignature OnReadProgress;
+
+	/**
+	 * Fires before `OnReadProgress`. Progress UI written in C++ should bind here, since this fires for every chunk.
+	 */
+	FOnDiscordStorageReadProgressNative OnReadProgressNative;
+};
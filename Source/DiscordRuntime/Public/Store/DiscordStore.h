@@ -0,0 +1,108 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordTypes.h"
+#include "DiscordStore.generated.h"
+
+
+UENUM(BlueprintType)
+namespace EDiscordSkuTypes
+{
+	enum Type
+	{
+		None,
+		Application,
+		DLC,
+		Consumable,
+		Bundle,
+	};
+}
+
+UENUM(BlueprintType)
+namespace EDiscordEntitlementTypes
+{
+	enum Type
+	{
+		None,
+		Purchase,
+		PremiumSubscription     UMETA(DisplayName="Premium Subscription"),
+		DeveloperGift           UMETA(DisplayName="Developer Gift"),
+		TestModePurchase        UMETA(DisplayName="Test Mode Purchase"),
+		FreePurchase            UMETA(DisplayName="Free Purchase"),
+		UserGift                UMETA(DisplayName="User Gift"),
+		PremiumPurchase         UMETA(DisplayName="Premium Purchase"),
+	};
+}
+
+
+USTRUCT(BlueprintType)
+struct FDiscordSku
+{
+	GENERATED_BODY()
+
+public:
+	FDiscordSku() = default;
+
+	explicit FDiscordSku(discord::Sku const& Sku);
+
+	/**
+	 * The unique ID of the SKU.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Store")
+	int64 ID = 0;
+
+	/**
+	 * What sort of SKU it is.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Store")
+	TEnumAsByte<EDiscordSkuTypes::Type> Type = EDiscordSkuTypes::None;
+
+	/**
+	 * The name of the SKU.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Store")
+	FString Name;
+
+	/**
+	 * The price of the SKU, in the smallest unit of its currency, e.g. cents.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Store")
+	int64 PriceAmount = 0;
+
+	/**
+	 * The currency of the price, e.g. "usd".
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Store")
+	FString PriceCurrency;
+};
+
+
+USTRUCT(BlueprintType)
+struct FDiscordEntitlement
+{
+	GENERATED_BODY()
+
+public:
+	FDiscordEntitlement() = default;
+
+	explicit FDiscordEntitlement(discord::Entitlement const& Entitlement);
+
+	/**
+	 * The unique ID of the entitlement.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Store")
+	int64 ID = 0;
+
+	/**
+	 * How the user got it.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Store")
+	TEnumAsByte<EDiscordEntitlementTypes::Type> Type = EDiscordEntitlementTypes::None;
+
+	/**
+	 * The SKU it grants.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Discord|Store")
+	int64 SkuID = 0;
+};
@@ -0,0 +1,150 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordOperation.h"
+#include "DiscordTypes.h"
+#include "DiscordStore.h"
+#include "UObject/Object.h"
+#include "DiscordStoreManager.generated.h"
+
+enum class EDiscordOutputPins : uint8;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordEntitlementCreatedSignature, const FDiscordEntitlement&, Entitlement);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordEntitlementDeletedSignature, const FDiscordEntitlement&, Entitlement);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordEntitlementNative, const FDiscordEntitlement& /* Entitlement */);
+
+
+UCLASS(Within=DiscordSubsystem)
+class DISCORDRUNTIME_API UDiscordStoreManager : public UObject
+{
+	friend class UDiscordSubsystem;
+	
+	GENERATED_BODY()
+
+private:
+	UDiscordStoreManager();
+	void Initialize(discord::StoreManager* StoreManager);
+	virtual void BeginDestroy() override;
+
+	void AddEntitlement(const FDiscordEntitlement& Entitlement);
+	bool RemoveEntitlement(const int64 EntitlementID);
+
+private:
+	UPROPERTY()
+	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
+	
+	discord::StoreManager* Internal_StoreManager = nullptr;
+
+	int Internal_OnEntitlementCreateCallback;
+	int Internal_OnEntitlementDeleteCallback;
+
+	// Only touched on the game thread
+	TMap<int64, FDiscordEntitlement> Entitlements;
+
+	/** How many of the current user's entitlements grant each SKU, so that deleting one keeps the others. */
+	TMap<int64, int32> OwnedSkus;
+
+	TMap<int64, FDiscordSku> Skus;
+
+	bool bEntitlementsFetched = false;
+
+public:
+	/**
+	 * Fetches the current user's entitlements, which are then kept up to date as they're created and deleted. Only
+	 * needs to be called once, after which `HasSkuEntitlement` answers without going through Discord.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Store", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void FetchEntitlements(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Fetches the current user's entitlements, which are then kept up to date as they're created and deleted. Only
+	 * needs to be called once, after which `HasSkuEntitlement` answers without going through Discord.
+	 */
+	FDiscordOperationHandle FetchEntitlements(TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Fetches the SKUs of the application, which can then be read with `GetSku`.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Store", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void FetchSkus(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Fetches the SKUs of the application, which can then be read with `GetSku`.
+	 */
+	FDiscordOperationHandle FetchSkus(TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Returns whether the entitlements were fetched, and `HasSkuEntitlement` can be trusted.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Store")
+	bool AreEntitlementsFetched() const { return bEntitlementsFetched; }
+
+	/**
+	 * Returns whether the current user owns a SKU. Answered from the fetched entitlements, so it's cheap enough to be
+	 * called every time a menu is built. Always false until the entitlements are fetched.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Store")
+	bool HasSkuEntitlement(const int64 SkuID) const { return OwnedSkus.Contains(SkuID); }
+
+	/**
+	 * Finds one of the current user's entitlements, once fetched. Returns whether it was found.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Store", meta=(ReturnDisplayName="Found"))
+	bool GetEntitlement(const int64 EntitlementID, FDiscordEntitlement& Entitlement) const;
+
+	/**
+	 * Returns the current user's entitlements, once fetched.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Store")
+	TArray<FDiscordEntitlement> GetEntitlements() const;
+
+	/**
+	 * Finds one of the application's SKUs, once fetched. Returns whether it was found.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Store", meta=(ReturnDisplayName="Found"))
+	bool GetSku(const int64 SkuID, FDiscordSku& Sku) const;
+
+	/**
+	 * Returns the application's SKUs, once fetched.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Store")
+	TArray<FDiscordSku> GetSkus() const;
+
+	/**
+	 * Opens the overlay to buy a SKU. Completes once the user either bought it or closed the overlay, and the new
+	 * entitlement is announced through `OnEntitlementCreated`.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Store", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void StartPurchase(const UObject* WorldContext, const FLatentActionInfo LatentInfo, EDiscordOutputPins& OutputPins, const int64 SkuID);
+
+	/**
+	 * Opens the overlay to buy a SKU. Completes once the user either bought it or closed the overlay, and the new
+	 * entitlement is announced through `OnEntitlementCreated`. Purchases wait on the user, so they never time out by
+	 * default.
+	 */
+	FDiscordOperationHandle StartPurchase(const int64 SkuID, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = 0.f);
+
+public:
+	/**
+	 * Fires when the current user got a new entitlement, e.g. after buying a SKU.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Store")
+	FOnDiscordEntitlementCreatedSignature OnEntitlementCreated;
+
+	/**
+	 * Fires when the current user lost an entitlement, e.g. after a refund.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Store")
+	FOnDiscordEntitlementDeletedSignature OnEntitlementDeleted;
+
+	/**
+	 * Fires before `OnEntitlementCreated`, once the entitlement counts towards `HasSkuEntitlement`.
+	 */
+	FOnDiscordEntitlementNative OnEntitlementCreatedNative;
+
+	/**
+	 * Fires before `OnEntitlementDeleted`, once the entitlement no longer counts towards `HasSkuEntitlement`.
+	 */
+	FOnDiscordEntitlementNative OnEntitlementDeletedNative;
+};
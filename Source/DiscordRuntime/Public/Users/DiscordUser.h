@@ -3,6 +3,7 @@
 #pragma once
 
 #include "DiscordTypes.h"
+#include "DiscordUtf8String.h"
 #include "DiscordUser.generated.h"
 
 
@@ -34,6 +35,35 @@ namespace EDiscordPremiumTypes
 }
 
 
+/**
+ * UTF-8 copy of a native user, for C++ code that only passes users around. Copying it to and from the SDK is a
+ * `memcpy` per string, and the strings are only converted when read through the accessors or when turned into an
+ * FDiscordUser.
+ */
+struct DISCORDRUNTIME_API FDiscordUtf8User
+{
+	FDiscordUtf8User() = default;
+
+	explicit FDiscordUtf8User(discord::User const& User);
+
+	discord::User ToDiscordType() const;
+
+	FString GetUsername() const { return Username.ToString(); }
+
+	FString GetAvatar() const { return Avatar.ToString(); }
+
+	int64 ID = -1;
+
+	TDiscordUtf8String<256> Username;
+
+	TDiscordUtf8String<8> Discriminator;
+
+	TDiscordUtf8String<128> Avatar;
+
+	bool bIsBot = false;
+};
+
+
 USTRUCT(BlueprintType)
 struct FDiscordUser
 {
@@ -44,6 +74,8 @@ public:
 	
 	explicit FDiscordUser(discord::User const& User);
 
+	explicit FDiscordUser(const FDiscordUtf8User& User);
+
 	discord::User ToDiscordType() const;
 
 	/**
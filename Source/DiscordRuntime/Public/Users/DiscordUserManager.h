@@ -2,14 +2,17 @@
 
 #pragma once
 
+#include "DiscordOperation.h"
 #include "DiscordTypes.h"
 #include "DiscordUser.h"
+#include "Containers/LruCache.h"
 #include "UObject/Object.h"
 #include "DiscordUserManager.generated.h"
 
 enum class EDiscordOutputPins : uint8;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordCurrentUserUpdatedSignature, FDiscordUser, User);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordCurrentUserUpdatedNative, const FDiscordUtf8User& /* User */);
 
 
 UCLASS(Within=DiscordSubsystem)
@@ -24,6 +27,51 @@ private:
 	void Initialize(discord::UserManager* UserManager);
 	virtual void BeginDestroy() override;
 
+	/** Everything known about the current user, read at once. */
+	struct FCurrentUserSnapshot
+	{
+		FDiscordUser User;
+
+		TEnumAsByte<EDiscordPremiumTypes::Type> PremiumType = EDiscordPremiumTypes::None;
+
+		/** A mask of `EDiscordUserFlags`. */
+		int32 Flags = 0;
+	};
+
+	/**
+	 * Reads the current user, their premium type and all their flags from the SDK. The caller must be allowed to call
+	 * into the SDK. Returns false if the current user isn't known yet.
+	 */
+	bool ReadCurrentUser(FDiscordUtf8User& OutUser, EDiscordPremiumTypes::Type& OutPremiumType, int32& OutFlags) const;
+
+	/**
+	 * Returns the snapshot of the current user, reading it if `OnCurrentUserUpdate` didn't fire yet. Returns nullptr if
+	 * the current user isn't known yet.
+	 */
+	const FCurrentUserSnapshot* GetCurrentUserSnapshot() const;
+
+	/** A user fetched through `GetUser`, and when. */
+	struct FCachedUser
+	{
+		FDiscordUtf8User User;
+
+		double FetchTime = 0.0;
+	};
+
+	/**
+	 * Returns a cached user, or nullptr if it isn't cached or is too old.
+	 */
+	const FDiscordUtf8User* FindCachedUser(const int64 UserID) const;
+
+	/**
+	 * Finds a user, from the cache if it's fresh enough, or else from the SDK, joining the lookup of the same user
+	 * already on its way if any. The callback fires on the game thread, right away on a cache hit. A lookup times out
+	 * after `TimeoutSeconds` (see settings), failing everyone waiting on it.
+	 */
+	void LookupUser(const int64 UserID, TFunction<void(discord::Result, const FDiscordUtf8User&)>&& Callback) const;
+
+	void FinishLookup(const int64 UserID, const discord::Result Result, const FDiscordUtf8User& User) const;
+
 private:
 	UPROPERTY()
 	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
@@ -32,36 +80,88 @@ private:
 
 	int Internal_OnCurrentUserUpdateCallback;
 
+	/** Replaced every time `OnCurrentUserUpdate` fires, so that reads don't go through the SDK. */
+	mutable TOptional<FCurrentUserSnapshot> CurrentUser;
+
+	// Only touched on the game thread
+	mutable TLruCache<int64, FCachedUser> CachedUsers;
+
+	// Everyone waiting on a user, so that it's only fetched once no matter how many ask for it
+	mutable TMap<int64, TArray<TFunction<void(discord::Result, const FDiscordUtf8User&)>>> PendingLookups;
+
 public:
 	/**
-	 * Fetch information about the currently connected user account. Returns whether the called was a success.
+	 * Fetch information about the currently connected user account. Returns whether the called was a success. Answered
+	 * from a copy kept up to date by `OnCurrentUserUpdated`, but still copies its strings each time it's evaluated, so
+	 * prefer `GetCurrentUserID` and the other getters below where they're enough.
 	 */
 	UFUNCTION(BlueprintPure, Category="Discord|User", meta=(ReturnDisplayName="Success"))
 	bool GetCurrentUser(FDiscordUser& User) const;
 
 	/**
-	 * Get user information for a given User ID.
+	 * Returns the currently connected user account without copying it, or nullptr if it isn't known yet. The pointer
+	 * is only valid until the next `OnCurrentUserUpdated`.
+	 */
+	const FDiscordUser* FindCurrentUser() const;
+
+	/**
+	 * Get user information for a given User ID. Users are cached for `UserCacheLifetimeSeconds` (see settings), and
+	 * asking for a user that is already being fetched waits for the same request.
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure=false, Category="Discord|User", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
 	void GetUser(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const int64 UserID, FDiscordUser& User, EDiscordOutputPins& OutputPins) const;
 
 	/**
-	 * Get user information for a given User ID.
+	 * Get user information for a given User ID. Users are cached for `UserCacheLifetimeSeconds` (see settings), and
+	 * asking for a user that is already being fetched waits for the same request. On a cache hit, the callback fires
+	 * right away.
+	 */
+	FDiscordOperationHandle GetUser(const int64 UserID, TFunction<void(discord::Result, discord::User const&)> Callback, const float TimeoutSeconds = -1.f) const;
+
+	/**
+	 * Get user information for several User IDs at once, through the same cache as `GetUser`. Fails if any of them
+	 * couldn't be found, in which case Users only holds those that were.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure=false, Category="Discord|User", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void GetUsers(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const TArray<int64>& UserIDs, TArray<FDiscordUser>& Users, EDiscordOutputPins& OutputPins) const;
+
+	/**
+	 * Get user information for several User IDs at once, through the same cache as `GetUser`. The callback fires once
+	 * all of them are known, with the users in the same order as their IDs. If any of them couldn't be found, it fires
+	 * with the first error, and the users only hold those that were.
+	 */
+	FDiscordOperationHandle GetUsers(const TArray<int64>& UserIDs, TFunction<void(discord::Result, const TArray<FDiscordUser>&)> Callback, const float TimeoutSeconds = -1.f) const;
+
+	/**
+	 * Returns the current user's ID, from the same copy as `GetCurrentUser`, or -1 if it isn't known yet.
 	 */
-	void GetUser(const int64 UserID, TFunction<void(discord::Result, discord::User const&)> Callback) const;
+	UFUNCTION(BlueprintPure, Category="Discord|User")
+	int64 GetCurrentUserID() const;
+
+	/**
+	 * Returns whether the current user is a bot, from the same copy as `GetCurrentUser`.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|User")
+	bool IsCurrentUserBot() const;
 
 	/**
-	 * Fetch information about the currently connected user account. Returns whether the called was a success.
+	 * Returns the current user's Nitro subscription, from the same copy as `GetCurrentUser`.
 	 */
 	UFUNCTION(BlueprintPure, Category="Discord|User")
 	TEnumAsByte<EDiscordPremiumTypes::Type> GetCurrentUserPremiumType() const;
 
 	/**
-	 * Returns whether the current user has the flag.
+	 * Returns whether the current user has the flag, from the same copy as `GetCurrentUser`.
 	 */
 	UFUNCTION(BlueprintPure, Category="Discord|User")
 	bool CurrentUserHasFlag(const EDiscordUserFlags::Type Flag) const;
 
+	/**
+	 * Returns all the flags of the current user as a mask, from the same copy as `GetCurrentUser`.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|User", meta=(Bitmask, BitmaskEnum="/Script/DiscordRuntime.EDiscordUserFlags"))
+	int32 GetCurrentUserFlags() const;
+
 public:
 	/**
 	 * Fires when the `User` struct of the currently connected user changes. They may have changed their avatar,
@@ -69,4 +169,10 @@ public:
 	 */
 	UPROPERTY(BlueprintAssignable, Category="Discord|User")
 	FOnDiscordCurrentUserUpdatedSignature OnCurrentUserUpdated;
+
+	/**
+	 * Fires before `OnCurrentUserUpdated`, with the UTF-8 copy the update was read into. `FindCurrentUser` already
+	 * returns the new user from here.
+	 */
+	FOnDiscordCurrentUserUpdatedNative OnCurrentUserUpdatedNative;
 };
@@ -0,0 +1,46 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordTypes.h"
+#include "DiscordInputMode.generated.h"
+
+
+UENUM(BlueprintType)
+namespace EDiscordInputModeTypes
+{
+	enum Type
+	{
+		VoiceActivity           UMETA(DisplayName="Voice Activity"),
+		PushToTalk              UMETA(DisplayName="Push To Talk"),
+	};
+}
+
+
+USTRUCT(BlueprintType)
+struct FDiscordInputMode
+{
+	GENERATED_BODY()
+
+public:
+	FDiscordInputMode() = default;
+
+	explicit FDiscordInputMode(discord::InputMode const& InputMode);
+
+	discord::InputMode ToDiscordType() const;
+
+	bool operator==(const FDiscordInputMode& Other) const { return Type == Other.Type && Shortcut == Other.Shortcut; }
+	bool operator!=(const FDiscordInputMode& Other) const { return !(*this == Other); }
+
+	/**
+	 * Whether the user's voice is sent when they speak, or while they hold the shortcut.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Discord|Voice")
+	TEnumAsByte<EDiscordInputModeTypes::Type> Type = EDiscordInputModeTypes::VoiceActivity;
+
+	/**
+	 * The push to talk shortcut, e.g. "caps lock". Ignored with voice activity.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Discord|Voice")
+	FString Shortcut;
+};
@@ -0,0 +1,202 @@
+﻿// Copyright Juniper Bouchard. All Rights Reserved.
+
+#pragma once
+
+#include "DiscordOperation.h"
+#include "DiscordTypes.h"
+#include "DiscordInputMode.h"
+#include "UObject/Object.h"
+#include "DiscordVoiceManager.generated.h"
+
+enum class EDiscordOutputPins : uint8;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordSelfMuteChangedSignature, bool, bMute);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordSelfDeafChangedSignature, bool, bDeaf);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDiscordInputModeChangedSignature, const FDiscordInputMode&, InputMode);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDiscordLocalMuteChangedSignature, int64, UserID, bool, bMute);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDiscordLocalVolumeChangedSignature, int64, UserID, uint8, Volume);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordSelfMuteChangedNative, bool /* bMute */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordSelfDeafChangedNative, bool /* bDeaf */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDiscordInputModeChangedNative, const FDiscordInputMode& /* InputMode */);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnDiscordLocalMuteChangedNative, int64 /* UserID */, bool /* bMute */);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnDiscordLocalVolumeChangedNative, int64 /* UserID */, uint8 /* Volume */);
+
+
+UCLASS(Within=DiscordSubsystem)
+class DISCORDRUNTIME_API UDiscordVoiceManager : public UObject
+{
+	friend class UDiscordSubsystem;
+	
+	GENERATED_BODY()
+
+private:
+	UDiscordVoiceManager();
+	void Initialize(discord::VoiceManager* VoiceManager);
+	virtual void BeginDestroy() override;
+
+	/** The voice settings the current user picked for another user. */
+	struct FUserVoiceSettings
+	{
+		bool bMute = false;
+		uint8 Volume = 100;
+	};
+
+	/**
+	 * Returns the settings of a user, reading them from the SDK the first time the user is asked about.
+	 */
+	const FUserVoiceSettings& FindOrReadUser(const int64 UserID) const;
+
+	/**
+	 * Reads every cached setting from the SDK again, and broadcasts those that changed.
+	 */
+	void RefreshSettings(const bool bBroadcast);
+
+	/**
+	 * Refreshes the settings if Discord said they changed, and writes the pending volumes if they waited long enough.
+	 * Called every frame by the subsystem.
+	 */
+	void FlushPendingChanges(const double Now);
+
+	void WritePendingVolumes(const double Now);
+
+private:
+	UPROPERTY()
+	TObjectPtr<UDiscordSubsystem> DiscordSubsystem = nullptr;
+	
+	discord::VoiceManager* Internal_VoiceManager = nullptr;
+
+	int Internal_OnSettingsUpdateCallback;
+
+	// Only touched on the game thread
+	bool bSelfMute = false;
+	bool bSelfDeaf = false;
+	FDiscordInputMode InputMode;
+
+	/** Filled as users are asked about, so that only they are read again when the settings change. */
+	mutable TMap<int64, FUserVoiceSettings> Users;
+
+	/** The last volume set for each user, not written yet. */
+	TMap<int64, uint8> PendingVolumes;
+
+	double LastVolumeWriteTime = -UE_BIG_NUMBER;
+
+	bool bSettingsDirty = false;
+
+public:
+	/**
+	 * Returns whether the current user muted themselves.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Voice")
+	bool IsSelfMute() const { return bSelfMute; }
+
+	/**
+	 * Mutes or unmutes the current user.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Voice")
+	void SetSelfMute(const bool bMute);
+
+	/**
+	 * Returns whether the current user deafened themselves.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Voice")
+	bool IsSelfDeaf() const { return bSelfDeaf; }
+
+	/**
+	 * Deafens or undeafens the current user.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Voice")
+	void SetSelfDeaf(const bool bDeaf);
+
+	/**
+	 * Returns how the current user's voice is picked up.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Voice")
+	FDiscordInputMode GetInputMode() const { return InputMode; }
+
+	/**
+	 * Sets how the current user's voice is picked up.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Voice", meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="OutputPins"))
+	void SetInputMode(const UObject* WorldContext, const FLatentActionInfo LatentInfo, const FDiscordInputMode& NewInputMode, EDiscordOutputPins& OutputPins);
+
+	/**
+	 * Sets how the current user's voice is picked up.
+	 */
+	FDiscordOperationHandle SetInputMode(const FDiscordInputMode& NewInputMode, TFunction<void(discord::Result)> Callback, const float TimeoutSeconds = -1.f);
+
+	/**
+	 * Returns whether the current user muted another user for themselves. Only the first call for a user goes through
+	 * Discord, so it's cheap enough to be called for every member of a party every frame.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Voice")
+	bool IsLocalMute(const int64 UserID) const;
+
+	/**
+	 * Mutes or unmutes another user for the current user only.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Voice")
+	void SetLocalMute(const int64 UserID, const bool bMute);
+
+	/**
+	 * Returns the volume the current user hears another user at, from 0 to 200, 100 being the default. Only the first
+	 * call for a user goes through Discord, so it's cheap enough to be called for every member of a party every frame.
+	 */
+	UFUNCTION(BlueprintPure, Category="Discord|Voice")
+	uint8 GetLocalVolume(const int64 UserID) const;
+
+	/**
+	 * Sets the volume the current user hears another user at, from 0 to 200. Cheap enough to be called every frame while
+	 * a slider is dragged: the new volume is read back right away, but it's only written at most once per
+	 * `VoiceVolumeWriteIntervalSeconds` (see settings), with the last volume set for each user.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Voice")
+	void SetLocalVolume(const int64 UserID, const uint8 Volume);
+
+	/**
+	 * Stops keeping the settings of a user up to date, e.g. once they left the party. Asking about them again reads
+	 * them from Discord.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Discord|Voice")
+	void ForgetUser(const int64 UserID);
+
+public:
+	/**
+	 * Fires when the current user muted or unmuted themselves, from the game or from Discord.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Voice")
+	FOnDiscordSelfMuteChangedSignature OnSelfMuteChanged;
+
+	/**
+	 * Fires when the current user deafened or undeafened themselves, from the game or from Discord.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Voice")
+	FOnDiscordSelfDeafChangedSignature OnSelfDeafChanged;
+
+	/**
+	 * Fires when the current user's input mode changed, from the game or from Discord.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Voice")
+	FOnDiscordInputModeChangedSignature OnInputModeChanged;
+
+	/**
+	 * Fires when the current user muted or unmuted a user that was asked about, from the game or from Discord.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Voice")
+	FOnDiscordLocalMuteChangedSignature OnLocalMuteChanged;
+
+	/**
+	 * Fires when the current user changed the volume of a user that was asked about, from the game or from Discord.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Discord|Voice")
+	FOnDiscordLocalVolumeChangedSignature OnLocalVolumeChanged;
+
+	/**
+	 * Native versions of the events above, for C++ code that doesn't need to go through Blueprint. Each one fires right
+	 * before its Blueprint counterpart.
+	 */
+	FOnDiscordSelfMuteChangedNative OnSelfMuteChangedNative;
+	FOnDiscordSelfDeafChangedNative OnSelfDeafChangedNative;
+	FOnDiscordInputModeChangedNative OnInputModeChangedNative;
+	FOnDiscordLocalMuteChangedNative OnLocalMuteChangedNative;
+	FOnDiscordLocalVolumeChangedNative OnLocalVolumeChangedNative;
+};
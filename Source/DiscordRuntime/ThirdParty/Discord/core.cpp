@@ -11,7 +11,15 @@ namespace discord {
 
 Result Core::Create(ClientId clientId, std::uint64_t flags, Core** instance)
 {
-    if (!instance) {
+    return Create(clientId, flags, instance, &DiscordCreate);
+}
+
+Result Core::Create(ClientId clientId,
+                    std::uint64_t flags,
+                    Core** instance,
+                    CreateFunction create)
+{
+    if (!instance || !create) {
         return Result::InternalError;
     }
 
@@ -31,7 +39,7 @@ Result Core::Create(ClientId clientId, std::uint64_t flags, Core** instance)
     params.store_events = &StoreManager::events_;
     params.voice_events = &VoiceManager::events_;
     params.achievement_events = &AchievementManager::events_;
-    auto result = DiscordCreate(DISCORD_VERSION, &params, &((*instance)->internal_));
+    auto result = create(DISCORD_VERSION, &params, &((*instance)->internal_));
     if (result != DiscordResult_Ok || !(*instance)->internal_) {
         delete (*instance);
         (*instance) = nullptr;
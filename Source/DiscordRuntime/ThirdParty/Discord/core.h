@@ -18,7 +18,15 @@ namespace discord {
 
 class Core final {
 public:
+    using CreateFunction = EDiscordResult(DISCORD_API*)(DiscordVersion version,
+                                                       DiscordCreateParams* params,
+                                                       IDiscordCore** result);
+
     static Result Create(ClientId clientId, std::uint64_t flags, Core** instance);
+    static Result Create(ClientId clientId,
+                         std::uint64_t flags,
+                         Core** instance,
+                         CreateFunction create);
 
     ~Core();
 
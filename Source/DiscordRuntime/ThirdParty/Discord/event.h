@@ -1,10 +1,132 @@
 #pragma once
 
-#include <functional>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace discord {
 
+namespace detail {
+
+// Handlers up to this size, e.g. a lambda capturing `this` and a few more words, are stored without allocating.
+constexpr std::size_t EventInlineSize = 4 * sizeof(void*);
+
+template <typename Fn>
+struct EventStoresInline
+  : std::integral_constant<bool,
+                           sizeof(Fn) <= EventInlineSize &&
+                             alignof(Fn) <= alignof(std::max_align_t) &&
+                             std::is_nothrow_move_constructible<Fn>::value> {};
+
+template <typename... Args>
+struct EventHandlerOps {
+    void (*invoke)(void* storage, Args... args);
+    void (*relocate)(void* from, void* to);
+    void (*destroy)(void* storage);
+};
+
+template <typename Fn, bool Inline, typename... Args>
+struct EventHandlerStorage;
+
+template <typename Fn, typename... Args>
+struct EventHandlerStorage<Fn, true, Args...> {
+    static void Create(void* storage, Fn&& fn) { ::new (storage) Fn(std::move(fn)); }
+
+    static void Invoke(void* storage, Args... args)
+    {
+        (*static_cast<Fn*>(storage))(std::forward<Args>(args)...);
+    }
+
+    static void Relocate(void* from, void* to)
+    {
+        auto fn = static_cast<Fn*>(from);
+        ::new (to) Fn(std::move(*fn));
+        fn->~Fn();
+    }
+
+    static void Destroy(void* storage) { static_cast<Fn*>(storage)->~Fn(); }
+};
+
+template <typename Fn, typename... Args>
+struct EventHandlerStorage<Fn, false, Args...> {
+    static void Create(void* storage, Fn&& fn) { ::new (storage) Fn*(new Fn(std::move(fn))); }
+
+    static void Invoke(void* storage, Args... args)
+    {
+        (**static_cast<Fn**>(storage))(std::forward<Args>(args)...);
+    }
+
+    static void Relocate(void* from, void* to) { ::new (to) Fn*(*static_cast<Fn**>(from)); }
+
+    static void Destroy(void* storage) { delete *static_cast<Fn**>(storage); }
+};
+
+// Move-only type-erased handler, stored inline when small enough.
+template <typename... Args>
+class EventHandler final {
+public:
+    EventHandler() = default;
+
+    template <typename Fn>
+    explicit EventHandler(Fn fn)
+    {
+        using Storage = EventHandlerStorage<Fn, EventStoresInline<Fn>::value, Args...>;
+        static constexpr EventHandlerOps<Args...> ops{&Storage::Invoke, &Storage::Relocate, &Storage::Destroy};
+
+        Storage::Create(storage_, std::move(fn));
+        ops_ = &ops;
+    }
+
+    EventHandler(EventHandler const&) = delete;
+    EventHandler& operator=(EventHandler const&) = delete;
+
+    EventHandler(EventHandler&& rhs) noexcept { MoveFrom(rhs); }
+
+    EventHandler& operator=(EventHandler&& rhs) noexcept
+    {
+        if (this != &rhs) {
+            Reset();
+            MoveFrom(rhs);
+        }
+        return *this;
+    }
+
+    ~EventHandler() { Reset(); }
+
+    void operator()(Args... args) { ops_->invoke(storage_, std::forward<Args>(args)...); }
+
+private:
+    void MoveFrom(EventHandler& rhs)
+    {
+        if (rhs.ops_) {
+            rhs.ops_->relocate(rhs.storage_, storage_);
+            ops_ = rhs.ops_;
+            rhs.ops_ = nullptr;
+        }
+    }
+
+    void Reset()
+    {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[EventInlineSize];
+    EventHandlerOps<Args...> const* ops_{};
+};
+
+} // namespace detail
+
+// Handlers are kept in a dense array, so dispatch is a linear walk, and each token maps straight to its handler, so
+// disconnecting is O(1). Handlers may connect or disconnect handlers, including themselves, while the event is
+// dispatched: new handlers only run from the next dispatch on, and disconnected ones don't run again, but are only
+// destroyed once the outermost dispatch returns.
 template <typename... Args>
 class Event final {
 public:
@@ -12,48 +134,187 @@ public:
 
     Event() { slots_.reserve(4); }
 
-    Event(Event const&) = default;
+    Event(Event const&) = delete;
     Event(Event&&) = default;
     ~Event() = default;
 
-    Event& operator=(Event const&) = default;
+    Event& operator=(Event const&) = delete;
     Event& operator=(Event&&) = default;
 
     template <typename EventHandler>
     Token Connect(EventHandler slot)
     {
-        slots_.emplace_back(Slot{nextToken_, std::move(slot)});
-        return nextToken_++;
+        // Tokens are ints, so the entries can't grow past what their index bits address. Running out means handlers
+        // are leaking, since no manager connects more than a handful.
+        if (freeEntries_.empty() && entries_.size() > IndexMask) {
+            assert(false && "discord::Event can't hold more than 65536 handlers");
+            return InvalidToken;
+        }
+
+        std::uint32_t index;
+        if (freeEntries_.empty()) {
+            index = static_cast<std::uint32_t>(entries_.size());
+            entries_.push_back(Entry{});
+        }
+        else {
+            index = freeEntries_.back();
+            freeEntries_.pop_back();
+        }
+
+        auto& entry = entries_[index];
+        entry.connected = true;
+
+        // Adding to the slots while they're walked could move the handler that is running
+        entry.pending = dispatching_ > 0;
+        auto& slots = entry.pending ? pending_ : slots_;
+        entry.position = static_cast<std::uint32_t>(slots.size());
+        slots.push_back(Slot{index, Handler(std::move(slot))});
+
+        return static_cast<Token>((entry.generation << IndexBits) | index);
     }
 
     void Disconnect(Token token)
     {
-        for (auto& slot : slots_) {
-            if (slot.token == token) {
-                slot = slots_.back();
-                slots_.pop_back();
-                break;
-            }
+        if (token <= 0) {
+            return;
+        }
+
+        auto const index = static_cast<std::uint32_t>(token) & IndexMask;
+        if (index >= entries_.size()) {
+            return;
+        }
+
+        auto& entry = entries_[index];
+        if (!entry.connected || entry.generation != (static_cast<std::uint32_t>(token) >> IndexBits)) {
+            return;
         }
+
+        if (entry.pending) {
+            RemoveAt(pending_, entry.position);
+        }
+        else if (dispatching_ > 0) {
+            // The handler may be the one running, so it's only destroyed once the dispatch is over
+            slots_[entry.position].entry = NoEntry;
+            hasDisconnectedSlots_ = true;
+        }
+        else {
+            RemoveAt(slots_, entry.position);
+        }
+
+        Release(index);
     }
 
-    void DisconnectAll() { slots_ = {}; }
+    void DisconnectAll()
+    {
+        if (dispatching_ > 0) {
+            for (auto& slot : slots_) {
+                slot.entry = NoEntry;
+            }
+            hasDisconnectedSlots_ = !slots_.empty();
+        }
+        else {
+            slots_.clear();
+        }
+        pending_.clear();
+
+        for (std::uint32_t index = 0; index < entries_.size(); ++index) {
+            if (entries_[index].connected) {
+                Release(index);
+            }
+        }
+    }
 
     void operator()(Args... args)
     {
-        for (auto const& slot : slots_) {
-            slot.fn(std::forward<Args>(args)...);
+        ++dispatching_;
+
+        // Handlers connected from here on are pending, so the slots stay where they are until the end
+        auto const count = slots_.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            auto& slot = slots_[i];
+            if (slot.entry != NoEntry) {
+                slot.fn(args...);
+            }
+        }
+
+        if (--dispatching_ == 0) {
+            ApplyDeferredChanges();
         }
     }
 
 private:
+    using Handler = detail::EventHandler<Args...>;
+
+    // A token holds the index of its entry and the generation of that entry, which is bumped each time the entry is
+    // released, so that a stale token can't disconnect the handler that reused it. Generations start at 1, so that a
+    // zero-initialized token is never valid.
+    static constexpr Token InvalidToken = -1;
+    static constexpr std::uint32_t IndexBits = 16;
+    static constexpr std::uint32_t IndexMask = (1u << IndexBits) - 1;
+    static constexpr std::uint32_t MaxGeneration = (1u << (31 - IndexBits)) - 1;
+    static constexpr std::uint32_t NoEntry = ~0u;
+
+    struct Entry {
+        std::uint32_t generation{1};
+        std::uint32_t position{};
+        bool connected{};
+        bool pending{};
+    };
+
     struct Slot {
-        Token token;
-        std::function<void(Args...)> fn;
+        std::uint32_t entry;
+        Handler fn;
     };
 
-    Token nextToken_{};
+    void Release(std::uint32_t index)
+    {
+        auto& entry = entries_[index];
+        entry.generation = entry.generation == MaxGeneration ? 1 : entry.generation + 1;
+        entry.connected = false;
+        entry.pending = false;
+        freeEntries_.push_back(index);
+    }
+
+    void RemoveAt(std::vector<Slot>& slots, std::uint32_t position)
+    {
+        if (position + 1 != slots.size()) {
+            slots[position] = std::move(slots.back());
+            if (slots[position].entry != NoEntry) {
+                entries_[slots[position].entry].position = position;
+            }
+        }
+        slots.pop_back();
+    }
+
+    void ApplyDeferredChanges()
+    {
+        if (hasDisconnectedSlots_) {
+            hasDisconnectedSlots_ = false;
+            for (std::uint32_t i = 0; i < slots_.size();) {
+                if (slots_[i].entry == NoEntry) {
+                    RemoveAt(slots_, i);
+                }
+                else {
+                    ++i;
+                }
+            }
+        }
+
+        for (auto& slot : pending_) {
+            auto& entry = entries_[slot.entry];
+            entry.pending = false;
+            entry.position = static_cast<std::uint32_t>(slots_.size());
+            slots_.push_back(std::move(slot));
+        }
+        pending_.clear();
+    }
+
     std::vector<Slot> slots_{};
+    std::vector<Slot> pending_{};
+    std::vector<Entry> entries_{};
+    std::vector<std::uint32_t> freeEntries_{};
+    std::uint32_t dispatching_{};
+    bool hasDisconnectedSlots_{};
 };
 
 } // namespace discord